@@ -2,8 +2,10 @@
 
 #include <spdlog/spdlog.h>
 #include <algorithm>
+#include <cstdint>
 #include <numeric>
 #include <fstream>
+#include <limits>
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
 
@@ -37,8 +39,48 @@ bool AbsEngine::loadClassNames(const std::string& path)
 
 void AbsEngine::resizeAndNormalize(const cv::Mat& frame)
 {
-  cv::resize(frame, m_resizedFrame, cv::Size(m_width, m_height));
-  m_resizedFrame.convertTo(m_normalizedFrame, CV_32FC3, 1.0f / 255.0f);
+  preprocess(frame, inputView(0), m_resizedFrame, m_inputPlane);
+}
+
+void AbsEngine::preprocess(const cv::Mat& frame, const InputView& view, cv::Mat& resized,
+                           cv::Mat& plane)
+{
+  cv::resize(frame, resized, cv::Size(view.m_width, view.m_height));
+  const double scale {view.m_depth == CV_8U ? 1.0 : 1.0 / 255.0};
+
+  // headers over the view have the size and type of the conversion, convertTo writes into
+  // them instead of reallocating
+  if (view.m_planeStep == 0)
+  {
+    cv::Mat input(view.m_height, view.m_width, CV_MAKETYPE(view.m_depth, view.m_channels),
+                  view.m_data, view.m_rowStep);
+    resized.convertTo(input, input.type(), scale);
+    return;
+  }
+
+  std::uint8_t* planes {static_cast<std::uint8_t*>(view.m_data)};
+  for (int c {0}; c < view.m_channels; ++c)
+  {
+    cv::extractChannel(resized, plane, c);
+    cv::Mat input(view.m_height, view.m_width, CV_MAKETYPE(view.m_depth, 1),
+                  planes + c * view.m_planeStep, view.m_rowStep);
+    plane.convertTo(input, input.type(), scale);
+  }
+}
+
+InputView AbsEngine::inputView(std::size_t slot)
+{
+  m_normalizedFrame.create(m_height, m_width, CV_32FC3);
+  return {m_normalizedFrame.data, m_width, m_height, 3, CV_32F,
+          static_cast<std::size_t>(m_normalizedFrame.step), 0};
+}
+
+bool AbsEngine::bindInputBuffer(void* data, std::size_t bytes)
+{
+  if (data == nullptr)
+    return true;
+  spdlog::error("AbsEngine::bindInputBuffer: the engine does not read external input buffers");
+  return false;
 }
 
 /* ------------------------------- Post Processing ------------------------------------ */
@@ -46,79 +88,92 @@ void AbsEngine::resizeAndNormalize(const cv::Mat& frame)
   yolo v5 output shape: [1, num_boxes, 5 + num_classes]
   box-format: [x_center, y_center, width, height, objectness, class_probs...]
 */
- bool AbsEngine::yoloFivePostProc(void* data, int frameWidth, int frameHeight)
+template <TensorDtype Dtype>
+bool AbsEngine::yoloFivePostProc(std::span<const TensorView> outputs, int frameWidth,
+                                 int frameHeight, DetectionCandidates& candidates,
+                                 DetectedObjects& output) const
 {
-  const float* outputTensorData {static_cast<const float*>(data)};
-  const int num_classes {static_cast<int>(m_classNames.size())};
+  const TensorView& view {outputs.front()};
+  const TensorReader<Dtype> outputTensorData {view};
+  const std::int64_t rowStride {view.stride(-2)};
+  const std::int64_t colStride {view.stride(-1)};
+  const int num_classes {m_numClasses};
 
-  std::vector<cv::Rect> boxes;
-  std::vector<float> scores;
-  std::vector<int> class_ids;
+  const float threshold {candidateThreshold()};
+  candidates.clear();
+  candidates.m_nmsFree = false;
 
   for (int i {0}; i < m_numBoxes; ++i)
   {
-    const float objectness_score {outputTensorData[i * (num_classes + 5) + 4]};
-    if (objectness_score > m_config->m_confidenceThreshold)
+    const std::int64_t row {i * rowStride};
+    const float objectness_score {outputTensorData[row + 4 * colStride]};
+    if (objectness_score > threshold)
     {
-      const float* class_probabilities {&outputTensorData[i * (num_classes + 5) + 5]};
       int best_class_id {-1};
       float best_class_score {0.0f};
       for (int j {0}; j < num_classes; ++j)
       {
-        if (class_probabilities[j] > best_class_score)
+        const float score {outputTensorData[row + (5 + j) * colStride]};
+        if (score > best_class_score)
         {
-          best_class_score = class_probabilities[j];
+          best_class_score = score;
           best_class_id = j;
         }
       }
 
       const float combined_score {objectness_score * best_class_score};
-      if (combined_score > m_config->m_confidenceThreshold)
+      if (combined_score > threshold)
       {
-        const float x_center {outputTensorData[i * (num_classes + 5) + 0]};
-        const float y_center {outputTensorData[i * (num_classes + 5) + 1]};
-        const float width {outputTensorData[i * (num_classes + 5) + 2]};
-        const float height {outputTensorData[i * (num_classes + 5) + 3]};
+        const float x_center {outputTensorData[row + 0 * colStride]};
+        const float y_center {outputTensorData[row + 1 * colStride]};
+        const float width {outputTensorData[row + 2 * colStride]};
+        const float height {outputTensorData[row + 3 * colStride]};
 
         const int x1 {static_cast<int>((x_center - width / 2.0f) * frameWidth)};
         const int y1 {static_cast<int>((y_center - height / 2.0f) * frameHeight)};
         const int w {static_cast<int>(width * frameWidth)};
         const int h {static_cast<int>(height * frameHeight)};
 
-        boxes.emplace_back(x1, y1, w, h);
-        scores.push_back(combined_score);
-        class_ids.push_back(best_class_id);
+        candidates.m_boxes.emplace_back(x1, y1, w, h);
+        candidates.m_scores.push_back(combined_score);
+        candidates.m_classIds.push_back(best_class_id);
       }
     }
   }
 
-  applyNms(boxes, scores, class_ids);
+  applyNms(candidates, m_config->m_confidenceThreshold, m_config->m_iouThreshold, output);
   return true;
 }
 
 /*
-  yolo v8 output shape: [1, 4 + num_classes, num_boxes] (transposed)
+  yolo v8 output shape: [1, 4 + num_classes, num_boxes] (transposed), bound as
+  [1, num_boxes, 4 + num_classes] with the strides of the transposed tensor
   box-format: [x_center, y_center, width, height, class_probs...]
 */
-bool AbsEngine::yoloEightPostProc(void* data, int frameWidth, int frameHeight)
+template <TensorDtype Dtype>
+bool AbsEngine::yoloEightPostProc(std::span<const TensorView> outputs, int frameWidth,
+                                  int frameHeight, DetectionCandidates& candidates,
+                                  DetectedObjects& output) const
 {
-  const float* outputTensorData {static_cast<const float*>(data)};
-  const int num_classes {static_cast<int>(m_classNames.size())};
+  const TensorView& view {outputs.front()};
+  const TensorReader<Dtype> outputTensorData {view};
+  const std::int64_t rowStride {view.stride(-2)};
+  const std::int64_t colStride {view.stride(-1)};
+  const int num_classes {m_numClasses};
 
-  std::vector<cv::Rect> boxes;
-  std::vector<float> scores;
-  std::vector<int> class_ids;
+  const float threshold {candidateThreshold()};
+  candidates.clear();
+  candidates.m_nmsFree = false;
 
-  // yolov8 output is transposed: [1, 4 + num_classes, num_boxes]
   for (int i {0}; i < m_numBoxes; ++i)
   {
+    const std::int64_t row {i * rowStride};
     int best_class_id {-1};
     float best_class_score {0.0f};
 
     for (int j {0}; j < num_classes; ++j)
     {
-      // access transposed class probabilities
-      const float score {outputTensorData[(4 + j) * m_numBoxes + i]};
+      const float score {outputTensorData[row + (4 + j) * colStride]};
       if (score > best_class_score)
       {
         best_class_score = score;
@@ -126,25 +181,25 @@ bool AbsEngine::yoloEightPostProc(void* data, int frameWidth, int frameHeight)
       }
     }
 
-    if (best_class_score > m_config->m_confidenceThreshold)
+    if (best_class_score > threshold)
     {
-      const float x_center {outputTensorData[0 * m_numBoxes + i]};
-      const float y_center {outputTensorData[1 * m_numBoxes + i]};
-      const float width {outputTensorData[2 * m_numBoxes + i]};
-      const float height {outputTensorData[3 * m_numBoxes + i]};
+      const float x_center {outputTensorData[row + 0 * colStride]};
+      const float y_center {outputTensorData[row + 1 * colStride]};
+      const float width {outputTensorData[row + 2 * colStride]};
+      const float height {outputTensorData[row + 3 * colStride]};
 
       const int x1 {static_cast<int>((x_center - width / 2.0f) * frameWidth)};
       const int y1 {static_cast<int>((y_center - height / 2.0f) * frameHeight)};
       const int w {static_cast<int>(width * frameWidth)};
       const int h {static_cast<int>(height * frameHeight)};
 
-      boxes.emplace_back(x1, y1, w, h);
-      scores.push_back(best_class_score);
-      class_ids.push_back(best_class_id);
+      candidates.m_boxes.emplace_back(x1, y1, w, h);
+      candidates.m_scores.push_back(best_class_score);
+      candidates.m_classIds.push_back(best_class_id);
     }
   }
 
-  applyNms(boxes, scores, class_ids);
+  applyNms(candidates, m_config->m_confidenceThreshold, m_config->m_iouThreshold, output);
   return true;
 }
 
@@ -152,37 +207,40 @@ bool AbsEngine::yoloEightPostProc(void* data, int frameWidth, int frameHeight)
   yolo v10 is nms-free, output shape: [1, num_boxes, 6] 
   box-format: [xmin, ymin, xmax, ymax, score, class_id]
 */
-bool AbsEngine::yoloTenPostProc(void* data, int frameWidth, int frameHeight)
+template <TensorDtype Dtype>
+bool AbsEngine::yoloTenPostProc(std::span<const TensorView> outputs, int frameWidth,
+                                int frameHeight, DetectionCandidates& candidates,
+                                DetectedObjects& output) const
 {
-  const float* outputTensorData {static_cast<const float*>(data)};
-  // yolov10 is nms-free, typically outputs [1, 300, 6] 
-  // format: [xmin, ymin, xmax, ymax, score, class_id]
+  const TensorView& view {outputs.front()};
+  const TensorReader<Dtype> outputTensorData {view};
+  const std::int64_t rowStride {view.stride(-2)};
+  const std::int64_t colStride {view.stride(-1)};
 
-  m_odOutput.m_classProbabilities.clear();
-  m_odOutput.m_firstPoints.clear();
-  m_odOutput.m_secondPoints.clear();
-  m_odOutput.m_classNameIdxs.clear();
+  const float threshold {candidateThreshold()};
+  candidates.clear();
+  candidates.m_nmsFree = true;
 
   for (int i {0}; i < m_numBoxes; ++i)
   {
-    const float score {outputTensorData[i * 6 + 4]};
-    if (score > m_config->m_confidenceThreshold)
+    const std::int64_t row {i * rowStride};
+    const float score {outputTensorData[row + 4 * colStride]};
+    if (score > threshold)
     {
-      const float x1 {outputTensorData[i * 6 + 0]};
-      const float y1 {outputTensorData[i * 6 + 1]};
-      const float x2 {outputTensorData[i * 6 + 2]};
-      const float y2 {outputTensorData[i * 6 + 3]};
-      const int class_id {static_cast<int>(outputTensorData[i * 6 + 5])};
-
-      m_odOutput.m_classProbabilities.push_back(score);
-      m_odOutput.m_firstPoints.emplace_back(static_cast<int>(x1 * frameWidth), 
-                                            static_cast<int>(y1 * frameHeight));
-      m_odOutput.m_secondPoints.emplace_back(static_cast<int>(x2 * frameWidth), 
-                                             static_cast<int>(y2 * frameHeight));
-      m_odOutput.m_classNameIdxs.push_back(static_cast<std::size_t>(class_id));
+      const int x1 {static_cast<int>(outputTensorData[row + 0 * colStride] * frameWidth)};
+      const int y1 {static_cast<int>(outputTensorData[row + 1 * colStride] * frameHeight)};
+      const int x2 {static_cast<int>(outputTensorData[row + 2 * colStride] * frameWidth)};
+      const int y2 {static_cast<int>(outputTensorData[row + 3 * colStride] * frameHeight)};
+      const int class_id {static_cast<int>(outputTensorData[row + 5 * colStride])};
+
+      candidates.m_boxes.emplace_back(x1, y1, x2 - x1, y2 - y1);
+      candidates.m_scores.push_back(score);
+      candidates.m_classIds.push_back(class_id);
     }
   }
 
+  // nms-free head, the filter only drops boxes below the configured confidence
+  applyNms(candidates, m_config->m_confidenceThreshold, m_config->m_iouThreshold, output);
   return true;
 }
 
@@ -203,85 +261,348 @@ float AbsEngine::calculateIoU(const cv::Rect& box1, const cv::Rect& box2)
   return (union_area == 0) ? 0.0f : static_cast<float>(intersection_area) / union_area;
 }
 
-void AbsEngine::applyNms(const std::vector<cv::Rect>& boxes, 
-                        const std::vector<float>& scores,
-                        const std::vector<int>& classIds)
+float AbsEngine::candidateThreshold() const
+{
+  const ThresholdSweepConfig& sweep {m_config->m_thresholdSweep};
+  if (!sweep.m_enabled || sweep.m_confidences.empty())
+    return m_config->m_confidenceThreshold;
+  return std::min(m_config->m_confidenceThreshold, sweep.m_confidences.front());
+}
+
+void AbsEngine::applyNms(const DetectionCandidates& candidates, float confidence, float iou,
+                         DetectedObjects& output)
 {
-  std::vector<int> nms_indices;
-  if (!scores.empty())
+  output.m_classProbabilities.clear();
+  output.m_firstPoints.clear();
+  output.m_secondPoints.clear();
+  output.m_classNameIdxs.clear();
+
+  const std::vector<cv::Rect>& boxes {candidates.m_boxes};
+  const std::vector<float>& scores {candidates.m_scores};
+  std::vector<int> indices;
+  indices.reserve(scores.size());
+  for (int i {0}; i < static_cast<int>(scores.size()); ++i)
+    if (scores[i] > confidence)
+      indices.push_back(i);
+
+  std::sort(indices.begin(), indices.end(),
+            [&](int a, int b) { return scores[a] > scores[b]; });
+
+  // greedy suppression, a kept box removes every lower scored box overlapping it
+  std::vector<bool> suppressed(indices.size(), false);
+  for (std::size_t i {0}; i < indices.size(); ++i)
   {
-    std::vector<int> indices(scores.size());
-    std::iota(indices.begin(), indices.end(), 0);
+    if (suppressed[i])
+      continue;
 
-    std::sort(indices.begin(), indices.end(),
-              [&](int a, int b) { return scores[a] > scores[b]; });
+    const int idx {indices[i]};
+    const cv::Rect& box {boxes[idx]};
+    output.m_classProbabilities.push_back(scores[idx]);
+    output.m_firstPoints.emplace_back(box.x, box.y);
+    output.m_secondPoints.emplace_back(box.x + box.width, box.y + box.height);
+    output.m_classNameIdxs.push_back(static_cast<std::size_t>(candidates.m_classIds[idx]));
+
+    if (candidates.m_nmsFree)
+      continue;
+    for (std::size_t j {i + 1}; j < indices.size(); ++j)
+      if (!suppressed[j] && calculateIoU(box, boxes[indices[j]]) >= iou)
+        suppressed[j] = true;
+  }
+}
 
-    while (!indices.empty())
-    {
-      int current_idx {indices[0]};
-      nms_indices.push_back(current_idx);
+/*
+  ssd output shape: [1, num_boxes, 7]
+  box-format: [image_id, class_id, score, xmin, ymin, xmax, ymax]
+*/
+template <TensorDtype Dtype>
+bool AbsEngine::ssdPostProc(std::span<const TensorView> outputs, int frameWidth,
+                            int frameHeight, DetectionCandidates& candidates,
+                            DetectedObjects& output) const
+{
+  const TensorView& view {outputs.front()};
+  const TensorReader<Dtype> outputTensorData {view};
+  const std::int64_t rowStride {view.stride(-2)};
+  const std::int64_t colStride {view.stride(-1)};
 
-      std::vector<int> remaining_indices;
-      for (size_t i {1}; i < indices.size(); ++i)
-      {
-        int other_idx {indices[i]};
+  const float threshold {candidateThreshold()};
+  candidates.clear();
+  candidates.m_nmsFree = false;
 
-        const cv::Rect& box1 {boxes[current_idx]};
-        const cv::Rect& box2 {boxes[other_idx]};
+  for (int i {0}; i < m_numBoxes; ++i)
+  {
+    const std::int64_t row {i * rowStride};
+    const float score {outputTensorData[row + 2 * colStride]};
+    if (score > threshold)
+    {
+      const int class_id {static_cast<int>(outputTensorData[row + 1 * colStride])};
+      const float xmin {outputTensorData[row + 3 * colStride] * frameWidth};
+      const float ymin {outputTensorData[row + 4 * colStride] * frameHeight};
+      const float xmax {outputTensorData[row + 5 * colStride] * frameWidth};
+      const float ymax {outputTensorData[row + 6 * colStride] * frameHeight};
+
+      candidates.m_boxes.emplace_back(static_cast<int>(xmin), static_cast<int>(ymin), 
+                                        static_cast<int>(xmax - xmin), 
+                                        static_cast<int>(ymax - ymin));
+      candidates.m_scores.push_back(score);
+      candidates.m_classIds.push_back(class_id);
+    }
+  }
 
-        if (calculateIoU(box1, box2) < m_config->m_iouThreshold)
-          remaining_indices.push_back(other_idx);
-      }
-      indices = std::move(remaining_indices);
+  applyNms(candidates, m_config->m_confidenceThreshold, m_config->m_iouThreshold, output);
+  return true;
+}
+
+/*
+  TFLite_Detection_PostProcess outputs, nms already applied:
+  boxes [1, N, 4] as normalized [ymin, xmin, ymax, xmax], classes [1, N], scores [1, N], 
+  count [1] number of valid rows
+*/
+template <TensorDtype Dtype>
+bool AbsEngine::ssdFusedPostProc(std::span<const TensorView> outputs, int frameWidth,
+                                 int frameHeight, DetectionCandidates& candidates,
+                                 DetectedObjects& output) const
+{
+  const TensorReader<Dtype> boxes {outputs[0]};
+  const TensorReader<Dtype> classes {outputs[1]};
+  const TensorReader<Dtype> scores {outputs[2]};
+  const std::int64_t boxStride {outputs[0].stride(-2)};
+  const std::int64_t coordStride {outputs[0].stride(-1)};
+  const std::int64_t classStride {outputs[1].stride(-1)};
+  const std::int64_t scoreStride {outputs[2].stride(-1)};
+  const int count {std::clamp(static_cast<int>(TensorReader<Dtype>{outputs[3]}[0]), 0,
+                              m_numBoxes)};
+
+  const float threshold {candidateThreshold()};
+  candidates.clear();
+  candidates.m_nmsFree = true;
+
+  for (int i {0}; i < count; ++i)
+  {
+    const float score {scores[i * scoreStride]};
+    if (score > threshold)
+    {
+      const std::int64_t box {i * boxStride};
+      const int y1 {static_cast<int>(boxes[box + 0 * coordStride] * frameHeight)};
+      const int x1 {static_cast<int>(boxes[box + 1 * coordStride] * frameWidth)};
+      const int y2 {static_cast<int>(boxes[box + 2 * coordStride] * frameHeight)};
+      const int x2 {static_cast<int>(boxes[box + 3 * coordStride] * frameWidth)};
+
+      candidates.m_boxes.emplace_back(x1, y1, x2 - x1, y2 - y1);
+      candidates.m_scores.push_back(score);
+      candidates.m_classIds.push_back(static_cast<int>(classes[i * classStride]));
     }
   }
 
-  m_odOutput.m_classProbabilities.clear();
-  m_odOutput.m_firstPoints.clear();
-  m_odOutput.m_secondPoints.clear();
-  m_odOutput.m_classNameIdxs.clear();
+  applyNms(candidates, m_config->m_confidenceThreshold, m_config->m_iouThreshold, output);
+  return true;
+}
 
-  for (int idx : nms_indices)
+bool AbsEngine::setBatchSize(std::size_t batchSize)
+{
+  if (batchSize == 0)
   {
-    const cv::Rect& box {boxes[idx]};
-    m_odOutput.m_classProbabilities.push_back(scores[idx]);
-    m_odOutput.m_firstPoints.emplace_back(box.x, box.y);
-    m_odOutput.m_secondPoints.emplace_back(box.x + box.width, box.y + box.height);
-    m_odOutput.m_classNameIdxs.push_back(static_cast<std::size_t>(classIds[idx]));
+    spdlog::error("AbsEngine::setBatchSize: the batch size has to be positive");
+    return false;
   }
+  m_batchSize = batchSize;
+  m_batchOutput.resize(batchSize);
+  m_batchCandidates.resize(batchSize);
+  return true;
 }
 
-/*
-  ssd output shape: [1, num_boxes, 7]
-  box-format: [image_id, class_id, score, xmin, ymin, xmax, ymax]
-*/
-bool AbsEngine::ssdPostProc(void* data, int frameWidth, int frameHeight)
+bool AbsEngine::runObjectDetectionBatch(std::span<const cv::Mat> frames)
+{
+  if (frames.size() > m_batchSize)
+  {
+    spdlog::error("AbsEngine::runObjectDetectionBatch: {} frames exceed the batch size {}",
+                  frames.size(), m_batchSize);
+    return false;
+  }
+  for (std::size_t i {0}; i < frames.size(); ++i)
+  {
+    if (!runObjectDetection(frames[i]))
+      return false;
+    m_batchOutput[i] = m_odOutput;
+    m_batchCandidates[i] = m_candidates;
+  }
+  return true;
+}
+
+ModelArch AbsEngine::detectArch(const std::vector<std::vector<int>>& outputShapes)
 {
-  const float* outputTensorData {static_cast<const float*>(data)};
+  // TFLite_Detection_PostProcess: boxes, classes, scores and count
+  if (outputShapes.size() == 4)
+    return ModelArch::SSD;
+  if (outputShapes.size() != 1 || outputShapes.front().size() < 3)
+    return ModelArch::UNKNOWN;
+
+  // nms-free heads keep a few hundred boxes, dense heads thousands
+  constexpr int kMaxFinalBoxes {1000};
+  const std::vector<int>& shape {outputShapes.front()};
+  const int rows {shape[shape.size() - 2]};
+  const int cols {shape[shape.size() - 1]};
+  if (shape.size() == 3 && rows < cols)
+    return ModelArch::YOLOV8;
+  if (cols == 6 && rows <= kMaxFinalBoxes)
+    return ModelArch::YOLO10;
+  if (cols == 7 && rows <= kMaxFinalBoxes)
+    return ModelArch::SSD;
+  if (shape.size() == 3 && cols > 5)
+    return ModelArch::YOLO5;
+  return ModelArch::UNKNOWN;
+}
 
-  std::vector<cv::Rect> boxes;
-  std::vector<float> scores;
-  std::vector<int> class_ids;
+template <TensorDtype Dtype>
+AbsEngine::PostProcessor AbsEngine::decoderOf(bool fused) const
+{
+  if (fused)
+    return &AbsEngine::ssdFusedPostProc<Dtype>;
+  switch (m_config->m_arch)
+  {
+    case ModelArch::YOLO5: return &AbsEngine::yoloFivePostProc<Dtype>;
+    case ModelArch::YOLOV8: return &AbsEngine::yoloEightPostProc<Dtype>;
+    case ModelArch::YOLO10: return &AbsEngine::yoloTenPostProc<Dtype>;
+    case ModelArch::SSD: return &AbsEngine::ssdPostProc<Dtype>;
+    default: return nullptr;
+  }
+}
 
-  for (int i {0}; i < m_numBoxes; ++i)
+bool AbsEngine::bindArch(std::vector<TensorView>& outputs)
+{
+  if (m_config->m_arch == ModelArch::UNKNOWN)
+  {
+    std::vector<std::vector<int>> outputShapes;
+    for (const TensorView& output : outputs)
+      outputShapes.push_back(output.shape());
+    m_config->m_arch = detectArch(outputShapes);
+    if (m_config->m_arch == ModelArch::UNKNOWN)
+    {
+      spdlog::error("AbsEngine::bindArch: could not detect the model architecture from "
+                    "its outputs, set <arch> in the <engine> node");
+      return false;
+    }
+    spdlog::info("AbsEngine::bindArch: detected {} outputs", 
+                 modelArchToString(m_config->m_arch));
+  }
+
+  // the fused postprocess op already ran nms, its decoder reads all four outputs
+  const bool fused {m_config->m_arch == ModelArch::SSD && outputs.size() == 4};
+  if (fused)
   {
-    const float score {outputTensorData[i * 7 + 2]};
-    if (score > m_config->m_confidenceThreshold)
+    const TensorView& boxes {outputs[0]};
+    if (boxes.m_rank != 3 || boxes.dim(-1) != 4)
     {
-      const int class_id {static_cast<int>(outputTensorData[i * 7 + 1])};
-      const float xmin {outputTensorData[i * 7 + 3] * frameWidth};
-      const float ymin {outputTensorData[i * 7 + 4] * frameHeight};
-      const float xmax {outputTensorData[i * 7 + 5] * frameWidth};
-      const float ymax {outputTensorData[i * 7 + 6] * frameHeight};
-
-      boxes.emplace_back(static_cast<int>(xmin), static_cast<int>(ymin), 
-                         static_cast<int>(xmax - xmin), static_cast<int>(ymax - ymin));
-      scores.push_back(score);
-      class_ids.push_back(class_id);
+      spdlog::error("AbsEngine::bindArch: the first SSD postprocess output is not [1, N, 4] "
+                    "boxes");
+      return false;
+    }
+    for (std::size_t i {1}; i < outputs.size(); ++i)
+    {
+      if (outputs[i].m_dtype != boxes.m_dtype || outputs[i].m_rank < 1 ||
+          (i < 3 && outputs[i].dim(-1) < boxes.dim(1)))
+      {
+        spdlog::error("AbsEngine::bindArch: SSD postprocess output {} does not match the "
+                      "boxes, [1, N] of the same element type", i);
+        return false;
+      }
     }
+    m_numBoxes = boxes.dim(1);
+    m_numClasses = 0;
   }
+  else
+  {
+    if (outputs.size() != 1 || outputs.front().m_rank < 3)
+    {
+      spdlog::error("AbsEngine::bindArch: {} needs a single [1, N, M] output, the model has {}",
+                    modelArchToString(m_config->m_arch), outputs.size());
+      return false;
+    }
 
-  applyNms(boxes, scores, class_ids);
+    // rows of box values, the boxes are the larger dim of dense heads and the one next to
+    // the fixed value count of the others, a transposed tensor is reordered, not copied
+    TensorView& output {outputs.front()};
+    int values {0};
+    switch (m_config->m_arch)
+    {
+      case ModelArch::YOLO10: values = 6; break;
+      case ModelArch::SSD: values = 7; break;
+      default: break;
+    }
+    const bool transposed {values > 0 ? output.dim(-1) != values && output.dim(-2) == values :
+                                        output.dim(-2) < output.dim(-1)};
+    if (transposed)
+    {
+      std::vector<int> order(output.m_rank);
+      std::iota(order.begin(), order.end(), 0);
+      std::swap(order[output.m_rank - 2], order[output.m_rank - 1]);
+      output = output.permuted(order);
+    }
+
+    int leading {1};
+    for (int d {0}; d < output.m_rank - 2; ++d)
+      leading *= output.m_dims[d];
+    const int rowValues {output.dim(-1)};
+    const int minValues {m_config->m_arch == ModelArch::YOLO5 ? 6 : 5};
+    if (leading != 1 || (values > 0 && rowValues != values) || (values == 0 && 
+        rowValues < minValues))
+    {
+      spdlog::error("AbsEngine::bindArch: the output is not a {} layout, {} x {} rows of {} "
+                    "values", modelArchToString(m_config->m_arch), leading, output.dim(-2),
+                    rowValues);
+      return false;
+    }
+    m_numBoxes = output.dim(-2);
+    switch (m_config->m_arch)
+    {
+      case ModelArch::YOLO5: m_numClasses = rowValues - 5; break;
+      case ModelArch::YOLOV8: m_numClasses = rowValues - 4; break;
+      default: m_numClasses = 0; break;
+    }
+  }
+
+  switch (outputs.front().m_dtype)
+  {
+    case TensorDtype::FLOAT32: m_postProcess = decoderOf<TensorDtype::FLOAT32>(fused); break;
+    case TensorDtype::UINT8: m_postProcess = decoderOf<TensorDtype::UINT8>(fused); break;
+    case TensorDtype::INT8: m_postProcess = decoderOf<TensorDtype::INT8>(fused); break;
+    case TensorDtype::INT32: m_postProcess = decoderOf<TensorDtype::INT32>(fused); break;
+    default: m_postProcess = nullptr; break;
+  }
+  if (m_postProcess == nullptr)
+  {
+    spdlog::error("AbsEngine::bindArch: unsupported architecture or output element type");
+    return false;
+  }
+  return true;
+}
+
+bool AbsEngine::bindSemantic(const TensorView& output)
+{
+  if (output.m_rank != 4 || output.dim(0) != 1)
+  {
+    spdlog::error("AbsEngine::bindSemantic: expected a [1, H, W, C] output, got {}D",
+                  output.m_rank);
+    return false;
+  }
+
+  switch (output.m_dtype)
+  {
+    case TensorDtype::FLOAT32:
+      m_semanticPostProcess = &AbsEngine::semanticPostProc<TensorDtype::FLOAT32>;
+      break;
+    case TensorDtype::UINT8:
+      m_semanticPostProcess = &AbsEngine::semanticPostProc<TensorDtype::UINT8>;
+      break;
+    case TensorDtype::INT8:
+      m_semanticPostProcess = &AbsEngine::semanticPostProc<TensorDtype::INT8>;
+      break;
+    case TensorDtype::INT32:
+      m_semanticPostProcess = &AbsEngine::semanticPostProc<TensorDtype::INT32>;
+      break;
+    default:
+      spdlog::error("AbsEngine::bindSemantic: unsupported output element type");
+      return false;
+  }
   return true;
 }
 
@@ -302,29 +623,49 @@ bool AbsEngine::init(TestBenchConfig* config)
     return false;
   }
 
+  // the decoders read the class scores the output has, only the named ones are reported
+  const int numNames {static_cast<int>(m_classNames.size())};
+  if (m_numClasses > 0 && m_numClasses != numNames)
+  {
+    spdlog::warn("AbsEngine::init: the model scores {} classes, {} are named", m_numClasses,
+                 numNames);
+    m_numClasses = std::min(m_numClasses, numNames);
+  }
+
   return true;
 }
 
-void AbsEngine::semanticPostProc(void* data, int outW, int outH, int numClasses,
-                                  int frameWidth, int frameHeight)
+template <TensorDtype Dtype>
+void AbsEngine::semanticPostProc(const TensorView& output, int frameWidth, int frameHeight)
 {
-  const float* outputData {static_cast<const float*>(data)};
+  const TensorReader<Dtype> outputData {output};
+  const int outH {output.dim(1)};
+  const int outW {output.dim(2)};
+  const int numClasses {output.dim(3)};
+  const std::int64_t rowStride {output.stride(1)};
+  const std::int64_t colStride {output.stride(2)};
+  const std::int64_t classStride {output.stride(3)};
   
   // reserve memory for performance
+  m_semantics.m_pixels.clear();
+  m_semantics.m_classNameIdxs.clear();
   m_semantics.m_pixels.reserve(outH * outW);
   m_semantics.m_classNameIdxs.reserve(outH * outW);
+  m_semantics.m_labelMask.create(outH, outW, CV_8UC1);  // no-op after the first frame
 
   for (int y {0}; y < outH; ++y)
   {
+    std::uint8_t* labelRow {m_semantics.m_labelMask.ptr<std::uint8_t>(y)};
     for (int x {0}; x < outW; ++x)
     {
       // iterate thorugh all classes to find the max probability
-      float maxProb {-1.0f};
+      const std::int64_t pixel {y * rowStride + x * colStride};
+      float maxProb {std::numeric_limits<float>::lowest()};
       int maxIdx {-1};
 
       for (int c {0}; c < numClasses; ++c)
       {
-        float prob {outputData[(y * outW + x) * numClasses + c]};
+        const float prob {outputData[pixel + c * classStride]};
         if (prob > maxProb)
         {
           maxProb = prob;
@@ -338,6 +679,7 @@ void AbsEngine::semanticPostProc(void* data, int outW, int outH, int numClasses,
 
       m_semantics.m_pixels.emplace_back(origX, origY);
       m_semantics.m_classNameIdxs.push_back(static_cast<std::size_t>(maxIdx));
+      labelRow[x] = static_cast<std::uint8_t>(std::min(maxIdx, 254));
     }
   }
-}
\ No newline at end of file
+}
@@ -1,9 +1,13 @@
 #pragma once
 
 #include "../utils/config/config.h"
+#include "../utils/memory/memory.h"
+#include "../utils/recorder/recorder.h"
+#include "tensorView.h"
 
 #include <opencv2/core/mat.hpp>
 #include <vector>
+#include <span>
 #include <string>
 #include <memory>
 
@@ -18,6 +22,24 @@ struct DetectedObjects
   std::vector<std::size_t> m_classNameIdxs;        /// \var class name indexes
 };
 
+/**
+ * @brief Decoded boxes before non-maximum suppression
+ */
+struct DetectionCandidates
+{
+  std::vector<cv::Rect> m_boxes;                   /// \var bboxes in frame coordinates
+  std::vector<float> m_scores;                     /// \var confidence scores
+  std::vector<int> m_classIds;                     /// \var class indexes
+  bool m_nmsFree {false};                          /// \var final boxes, only filter by score
+
+  void clear()
+  {
+    m_boxes.clear();
+    m_scores.clear();
+    m_classIds.clear();
+  }
+};
+
 /**
  * @brief Data structure for semantic segmentation ouput
  */
@@ -25,6 +47,22 @@ struct DetectedSemantics
 {
   std::vector<cv::Point> m_pixels;                /// \var segmented pixel
   std::vector<std::size_t> m_classNameIdxs;       /// \var class name indicies
+  cv::Mat m_labelMask;                            /// \var CV_8UC1 class index per output pixel
+};
+
+/**
+ * @brief Typed, strided view of the buffer an engine reads its input from, the preprocessing
+ * writes into it directly
+ */
+struct InputView
+{
+  void* m_data {nullptr};                         /// \var first element of the buffer
+  int m_width {0};                                /// \var columns
+  int m_height {0};                               /// \var rows
+  int m_channels {0};                             /// \var channels
+  int m_depth {CV_32F};                           /// \var CV_32F scaled to [0, 1] or CV_8U pixels
+  std::size_t m_rowStep {0};                      /// \var bytes between two rows
+  std::size_t m_planeStep {0};                    /// \var bytes between planes, 0 if interleaved
 };
 
 /**
@@ -33,11 +71,17 @@ struct DetectedSemantics
 class AbsEngine
 {
 protected:
-  cv::Mat m_resizedFrame;                         /// \var resized input frame        
-  cv::Mat m_normalizedFrame;                      /// \var normalized input frame
+  cv::Mat m_resizedFrame;                         /// \var resized input frame
+  cv::Mat m_normalizedFrame;                      /// \var input of engines without own buffer
+  cv::Mat m_inputPlane;                           /// \var scratch: one channel of a planar input
 
   TestBenchConfig* m_config;                      /// \var ptr to test bench configuration
   DetectedObjects m_odOutput;                     /// \var object detection output
+  DetectionCandidates m_candidates;               /// \var decoded boxes before nms
+  TensorRecorder* m_recorder {nullptr};           /// \var records raw outputs if set
+  std::size_t m_batchSize {1};                    /// \var frames per batched call
+  std::vector<DetectedObjects> m_batchOutput;     /// \var detections per batch slot
+  std::vector<DetectionCandidates> m_batchCandidates; /// \var candidates per batch slot
   DetectedSemantics m_semantics;                  /// \var semantic segmentation output
   
   std::vector<std::string> m_classNames;          /// \var class names
@@ -45,6 +89,17 @@ protected:
   int m_height {0};                               /// \var model's input height
   int m_inputChannels {0};                        /// \var model's input channels
   int m_numBoxes {0};                             /// \var number of candidate boxes
+  int m_numClasses {0};                           /// \var class scores per box, 0 if ids
+
+  /// \brief decoder of one object detection output layout and element type
+  using PostProcessor = bool (AbsEngine::*)(std::span<const TensorView> outputs, int frameWidth,
+                                            int frameHeight, DetectionCandidates& candidates,
+                                            DetectedObjects& output) const;
+  /// \brief decoder of a segmentation output element type
+  using SemanticPostProcessor = void (AbsEngine::*)(const TensorView& output, int frameWidth,
+                                                    int frameHeight);
+  PostProcessor m_postProcess {nullptr};          /// \var decoder of the model arch, bound at load
+  SemanticPostProcessor m_semanticPostProcess {nullptr}; /// \var segmentation decoder
 
   /**
    * @brief loads the model from the given binary path
@@ -53,6 +108,25 @@ protected:
    */
   virtual bool loadModel(const std::string& path) = 0;
   
+  /**
+   * @brief resolves the model architecture once at load, the configured one or the one
+   * detected from the output shapes, checks the output layout against it and binds the
+   * decoder of the architecture and element type, so the per-frame path neither dispatches
+   * nor converts. Box outputs are reordered in place to rows of box values, [1, N, M].
+   * @param outputs view of every model output, SSD postprocess outputs in op order (boxes,
+   * classes, scores, count)
+   * @return true if successful, false otherwise
+   */
+  bool bindArch(std::vector<TensorView>& outputs);
+
+  /**
+   * @brief checks the segmentation output layout once at load and binds the decoder of its
+   * element type
+   * @param output view of the output as [1, H, W, C], channels first outputs permuted to it
+   * @return true if successful, false otherwise
+   */
+  bool bindSemantic(const TensorView& output);
+
   /**
    * @brief loads class names from the given file path
    * @param path path to the class names file
@@ -61,77 +135,159 @@ protected:
   bool loadClassNames(const std::string& path);
 
   /**
-   * @brief resizes and normalizes the input frame
+   * @brief resizes and normalizes the input frame straight into inputView(0)
    * @param frame input frame
    */
   void resizeAndNormalize(const cv::Mat& frame);
 
   /**
    * @brief run post proccessing algorithm on the output tensor of a YOLOv5 model
-   * @param data pointer to the output tensor data
+   * @param outputs output views, [1, N, 5 + C]
    * @param frameWidth original frame width
    * @param frameHeight original frame height
+   * @param candidates output decoded boxes before nms
+   * @param output output detections
    * @return true if successful, false otherwise
    */
-  bool yoloFivePostProc(void* data, int frameWidth, int frameHeight);
+  template <TensorDtype Dtype>
+  bool yoloFivePostProc(std::span<const TensorView> outputs, int frameWidth, int frameHeight,
+                        DetectionCandidates& candidates, DetectedObjects& output) const;
 
   /**
    * @brief run post proccessing algorithm on the output tensor of a YOLOv8 model
-   * @param data pointer to the output tensor data
+   * @param outputs output views, [1, N, 4 + C], transposed exports are read in place
    * @param frameWidth original frame width
    * @param frameHeight original frame height
+   * @param candidates output decoded boxes before nms
+   * @param output output detections
    * @return true if successful, false otherwise
    */
-  bool yoloEightPostProc(void* data, int frameWidth, int frameHeight);
+  template <TensorDtype Dtype>
+  bool yoloEightPostProc(std::span<const TensorView> outputs, int frameWidth, int frameHeight,
+                         DetectionCandidates& candidates, DetectedObjects& output) const;
 
   /**
    * @brief run post proccessing algorithm on the output tensor of a YOLOv10 model
-   * @param data pointer to the output tensor data
+   * @param outputs output views, [1, N, 6]
    * @param frameWidth original frame width
    * @param frameHeight original frame height
+   * @param candidates output decoded boxes before nms
+   * @param output output detections
    * @return true if successful, false otherwise
    */
-  bool yoloTenPostProc(void* data, int frameWidth, int frameHeight);
+  template <TensorDtype Dtype>
+  bool yoloTenPostProc(std::span<const TensorView> outputs, int frameWidth, int frameHeight,
+                       DetectionCandidates& candidates, DetectedObjects& output) const;
 
   /**
    * @brief run post proccessing algorithm on the output tensor of an SSD model
-   * @param data pointer to the output tensor data
+   * @param outputs output views, [1, N, 7]
    * @param frameWidth original frame width
    * @param frameHeight original frame height
+   * @param candidates output decoded boxes before nms
+   * @param output output detections
    * @return true if successful, false otherwise
    */
-  bool ssdPostProc(void* data, int frameWidth, int frameHeight);
+  template <TensorDtype Dtype>
+  bool ssdPostProc(std::span<const TensorView> outputs, int frameWidth, int frameHeight,
+                   DetectionCandidates& candidates, DetectedObjects& output) const;
+
+  /**
+   * @brief decodes the outputs of the fused TFLite_Detection_PostProcess op of an SSD model,
+   * the boxes are already suppressed so only the confidence filter is applied
+   * @param outputs the four outputs: boxes [1, N, 4] (normalized ymin, xmin, ymax, xmax),
+   * classes [1, N], scores [1, N] and count [1]
+   * @param frameWidth original frame width
+   * @param frameHeight original frame height
+   * @param candidates output decoded boxes before nms
+   * @param output output detections
+   * @return true if successful, false otherwise
+   */
+  template <TensorDtype Dtype>
+  bool ssdFusedPostProc(std::span<const TensorView> outputs, int frameWidth, int frameHeight,
+                        DetectionCandidates& candidates, DetectedObjects& output) const;
 
   /**
    * @brief run post proccessing algorithm for semantic segmentation model
-   * @param data pointer to the output tensor data
-   * @param outW output tensor width
-   * @param outH output tensor height
-   * @param numClasses number of classes
+   * @param output output view, [1, H, W, C]
    * @param frameWidth original frame width
    * @param frameHeight original frame height
    */
-  void semanticPostProc(void* data, int outW, int outH, int numClasses,
-                        int frameWidth, int frameHeight);
+  template <TensorDtype Dtype>
+  void semanticPostProc(const TensorView& output, int frameWidth, int frameHeight);
 
   /**
-   * @brief applies non-maximum suppression to filter overlapping boxes
-   * @param boxes vector of bounding boxes
-   * @param scores vector of confidence scores
-   * @param classIds vector of class indices
+   * @brief returns the decoder of the configured architecture for an element type
+   * @param fused SSD outputs of the fused postprocess op
+   * @return decoder, nullptr if the architecture has none
    */
-  void applyNms(const std::vector<cv::Rect>& boxes, const std::vector<float>& scores,
-                const std::vector<int>& classIds);
-  
+  template <TensorDtype Dtype>
+  PostProcessor decoderOf(bool fused) const;
+
+  /**
+   * @brief lowest confidence a decoder has to keep, below the configured threshold when a
+   * threshold sweep needs the candidates of lower settings
+   * @return candidate confidence threshold
+   */
+  float candidateThreshold() const;
+
   /**
    * @brief calculates Intersection over Union (IoU) between two boxes
    * @param box1 first bounding box
    * @param box2 second bounding box
    * @return IoU value
    */
-  float calculateIoU(const cv::Rect& box1, const cv::Rect& box2);
+  static float calculateIoU(const cv::Rect& box1, const cv::Rect& box2);
 
 public:
+  /**
+   * @brief filters the candidates by confidence and applies non-maximum suppression to 
+   * overlapping boxes, nms-free candidates are only filtered
+   * @param candidates decoded boxes
+   * @param confidence confidence threshold
+   * @param iou IoU threshold of the suppression
+   * @param output output detections
+   */
+  static void applyNms(const DetectionCandidates& candidates, float confidence, float iou,
+                       DetectedObjects& output);
+
+  /**
+   * @brief detects the object detection architecture from the model outputs:
+   * [1, 4 + C, N] YOLOv8, [1, N, 6] with few boxes YOLOv10, [1, N, 7] SSD detection output,
+   * four outputs SSD postprocess op, otherwise [1, N, 5 + C] YOLOv5
+   * @param outputShapes shape of every model output
+   * @return detected architecture, UNKNOWN if no layout matches
+   */
+  static ModelArch detectArch(const std::vector<std::vector<int>>& outputShapes);
+
+  /**
+   * @brief resizes the frame to the view and converts it to the view's element type, both
+   * without an intermediate copy of the converted frame
+   * @param frame input frame, BGR
+   * @param view destination buffer
+   * @param resized scratch: resized frame
+   * @param plane scratch: one channel of the resized frame, used by planar views
+   */
+  static void preprocess(const cv::Mat& frame, const InputView& view, cv::Mat& resized,
+                         cv::Mat& plane);
+
+  /**
+   * @brief returns a view of the buffer the engine reads the input of a batch slot from. The
+   * default is an engine owned interleaved float buffer for slot 0.
+   * @param slot batch slot
+   * @return input view, valid until the next load, batch resize or input binding
+   */
+  virtual InputView inputView(std::size_t slot);
+
+  /**
+   * @brief makes the engine read its input from a caller owned buffer, which has to outlive
+   * the binding. Engines without external input support fail.
+   * @param data buffer, nullptr to return to the engine owned buffer
+   * @param bytes size of the buffer, at least the input size of the current batch
+   * @return true if successful, false otherwise
+   */
+  virtual bool bindInputBuffer(void* data, std::size_t bytes);
+
   /**
    * @brief initializes the engine with the given configuration file
    * @param configPath path to the configuration file
@@ -146,6 +302,22 @@ public:
    */
   virtual bool runObjectDetection(const cv::Mat& frame) = 0;
 
+  /**
+   * @brief sets the number of frames of runObjectDetectionBatch, engines that batch natively
+   * resize their input here, once, instead of on the first batch
+   * @param batchSize frames per batch
+   * @return true if successful, false otherwise
+   */
+  virtual bool setBatchSize(std::size_t batchSize);
+
+  /**
+   * @brief runs object detection on up to the batch size frames, the results of frame i are
+   * in getBatchDetections()[i]. The default runs the frames one by one.
+   * @param frames input frames
+   * @return true if successful, false otherwise
+   */
+  virtual bool runObjectDetectionBatch(std::span<const cv::Mat> frames);
+
   /**
    * @brief runs semantic segmentation on the input frame
    * @param frame input frame
@@ -153,6 +325,57 @@ public:
    */
   virtual bool runSemanticDetection(const cv::Mat& frame) = 0;
 
+  /**
+   * @brief fills the engine specific part of the memory statistics (arena, model mapping)
+   * @param stats memory statistics
+   */
+  virtual void collectMemoryStats(MemoryStats& stats) const {}
+
+  /**
+   * @brief returns the detections of the last runObjectDetection call
+   * @return object detection output
+   */
+  const DetectedObjects& getDetections() const { return m_odOutput; }
+
+  /**
+   * @brief returns the decoded boxes of the last runObjectDetection call before nms
+   * @return detection candidates
+   */
+  const DetectionCandidates& getCandidates() const { return m_candidates; }
+
+  /**
+   * @brief returns the detections of the last runObjectDetectionBatch call, one per frame
+   * @return object detection output per batch slot
+   */
+  const std::vector<DetectedObjects>& getBatchDetections() const { return m_batchOutput; }
+
+  /**
+   * @brief returns the decoded boxes of the last runObjectDetectionBatch call before nms
+   * @return detection candidates per batch slot
+   */
+  const std::vector<DetectionCandidates>& getBatchCandidates() const 
+  { 
+    return m_batchCandidates; 
+  }
+
+  /**
+   * @brief returns the segmentation of the last runSemanticDetection call
+   * @return semantic segmentation output
+   */
+  const DetectedSemantics& getSemantics() const { return m_semantics; }
+
+  /**
+   * @brief returns the class names loaded from the classes file
+   * @return class names
+   */
+  const std::vector<std::string>& getClassNames() const { return m_classNames; }
+
+  /**
+   * @brief attaches a recorder, every following inference streams its raw outputs to it
+   * @param recorder recorder, nullptr to stop recording
+   */
+  void setRecorder(TensorRecorder* recorder) { m_recorder = recorder; }
+
   virtual ~AbsEngine() = default;
 };
 
@@ -0,0 +1,208 @@
+#include "null.h"
+#include "../utils/profiler/profiler.h"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+namespace
+{
+// candidate rows of the usual exports at 640x640
+int defaultBoxes(ModelArch arch)
+{
+  switch (arch)
+  {
+    case ModelArch::YOLO5: return 25200;
+    case ModelArch::YOLO10: return 300;
+    case ModelArch::SSD: return 100;
+    default: return 8400;
+  }
+}
+}
+
+bool EngineNull::loadModel(const std::string& path)
+{
+  const NullEngineConfig& geometry {m_config->m_nullEngine};
+  spdlog::info("EngineNull::loadModel: no model, synthetic {}x{} outputs", geometry.m_width,
+               geometry.m_height);
+  m_width = geometry.m_width;
+  m_height = geometry.m_height;
+  m_inputChannels = 3;
+
+  // the output geometry depends on the class count, which init loads after the model
+  if (!loadClassNames(m_config->m_classNamesPath) || m_classNames.empty())
+  {
+    spdlog::error("EngineNull::loadModel: the synthetic outputs need the class names");
+    return false;
+  }
+
+  if (m_config->m_benchType != TestBenchType::OBJECT_DETECTION)
+  {
+    // one-hot class scores per output pixel
+    const std::size_t numClasses {m_classNames.size()};
+    std::mt19937 rng {42};
+    std::uniform_int_distribution<std::size_t> classDist {0, numClasses - 1};
+    m_output.assign(static_cast<std::size_t>(m_width) * m_height * numClasses, 0.0f);
+    for (std::size_t pixel {0}; pixel < m_output.size() / numClasses; ++pixel)
+      m_output[pixel * numClasses + classDist(rng)] = 1.0f;
+    const int dims[] {1, m_height, m_width, static_cast<int>(numClasses)};
+    m_outputViews = {TensorView::dense(m_output.data(), TensorDtype::FLOAT32, dims)};
+    return bindSemantic(m_outputViews.front());
+  }
+
+  if (m_config->m_arch == ModelArch::UNKNOWN)
+  {
+    spdlog::info("EngineNull::loadModel: no <arch> configured, using yolov8 outputs");
+    m_config->m_arch = ModelArch::YOLOV8;
+  }
+  const int numBoxes {geometry.m_boxes > 0 ? geometry.m_boxes : 
+                                              defaultBoxes(m_config->m_arch)};
+
+  // dense heads are told apart from their transpose by the boxes being the larger dim, an
+  // output with fewer boxes than row values would be decoded the wrong way round
+  const int numClasses {static_cast<int>(m_classNames.size())};
+  const int rowValues {m_config->m_arch == ModelArch::YOLO5 ? 5 + numClasses :
+                       m_config->m_arch == ModelArch::YOLOV8 ? 4 + numClasses : 0};
+  if (numBoxes <= rowValues)
+  {
+    spdlog::error("EngineNull::loadModel: {} outputs need more <boxes> than the {} values of "
+                  "a row, got {}", modelArchToString(m_config->m_arch), rowValues, numBoxes);
+    return false;
+  }
+  const std::vector<int> shape {fillDetections(numBoxes)};
+  m_outputViews = {TensorView::dense(m_output.data(), TensorDtype::FLOAT32, shape)};
+  return bindArch(m_outputViews);
+}
+
+std::vector<int> EngineNull::fillDetections(int numBoxes)
+{
+  const NullEngineConfig& geometry {m_config->m_nullEngine};
+  const int numClasses {static_cast<int>(m_classNames.size())};
+  const int numCandidates {std::min(geometry.m_candidates, numBoxes)};
+  const float confidence {std::clamp(m_config->m_confidenceThreshold, 0.0f, 0.99f)};
+
+  // fixed seed, every run decodes the same candidates spread over random rows
+  std::mt19937 rng {42};
+  std::vector<int> rows(numBoxes);
+  std::iota(rows.begin(), rows.end(), 0);
+  std::shuffle(rows.begin(), rows.end(), rng);
+  std::uniform_real_distribution<float> centerDist {0.1f, 0.9f};
+  std::uniform_real_distribution<float> sizeDist {0.05f, 0.2f};
+  std::uniform_real_distribution<float> scoreDist {confidence + (1.0f - confidence) * 0.05f,
+                                                   1.0f};
+  std::uniform_int_distribution<int> classDist {0, numClasses - 1};
+
+  std::vector<int> shape;
+  switch (m_config->m_arch)
+  {
+    case ModelArch::YOLO5: shape = {1, numBoxes, 5 + numClasses}; break;
+    case ModelArch::YOLOV8: shape = {1, 4 + numClasses, numBoxes}; break;
+    case ModelArch::YOLO10: shape = {1, numBoxes, 6}; break;
+    default: shape = {1, numBoxes, 7}; break;
+  }
+  m_output.assign(static_cast<std::size_t>(shape[1]) * shape[2], 0.0f);
+
+  for (int i {0}; i < numCandidates; ++i)
+  {
+    const int row {rows[i]};
+    const float cx {centerDist(rng)};
+    const float cy {centerDist(rng)};
+    const float w {sizeDist(rng)};
+    const float h {sizeDist(rng)};
+    const float score {scoreDist(rng)};
+    const int classId {classDist(rng)};
+    float* out {m_output.data()};
+    switch (m_config->m_arch)
+    {
+      case ModelArch::YOLO5:
+      {
+        float* values {out + row * shape[2]};
+        values[0] = cx;
+        values[1] = cy;
+        values[2] = w;
+        values[3] = h;
+        values[4] = score;
+        values[5 + classId] = 1.0f;
+        break;
+      }
+      case ModelArch::YOLOV8:
+        out[0 * numBoxes + row] = cx;
+        out[1 * numBoxes + row] = cy;
+        out[2 * numBoxes + row] = w;
+        out[3 * numBoxes + row] = h;
+        out[(4 + classId) * numBoxes + row] = score;
+        break;
+      case ModelArch::YOLO10:
+      {
+        float* values {out + row * 6};
+        values[0] = cx - w / 2.0f;
+        values[1] = cy - h / 2.0f;
+        values[2] = cx + w / 2.0f;
+        values[3] = cy + h / 2.0f;
+        values[4] = score;
+        values[5] = static_cast<float>(classId);
+        break;
+      }
+      default:
+      {
+        float* values {out + row * 7};
+        values[1] = static_cast<float>(classId);
+        values[2] = score;
+        values[3] = cx - w / 2.0f;
+        values[4] = cy - h / 2.0f;
+        values[5] = cx + w / 2.0f;
+        values[6] = cy + h / 2.0f;
+        break;
+      }
+    }
+  }
+  spdlog::info("EngineNull::fillDetections: {} outputs, {} of {} rows above the threshold",
+               modelArchToString(m_config->m_arch), numCandidates, numBoxes);
+  return shape;
+}
+
+InputView EngineNull::inputView(std::size_t slot)
+{
+  if (m_externalInput == nullptr)
+    return AbsEngine::inputView(slot);
+  return {m_externalInput, m_width, m_height, 3, CV_32F,
+          static_cast<std::size_t>(m_width) * 3 * sizeof(float), 0};
+}
+
+bool EngineNull::bindInputBuffer(void* data, std::size_t bytes)
+{
+  const std::size_t required {static_cast<std::size_t>(m_width) * m_height * 3 * sizeof(float)};
+  if (data != nullptr && bytes < required)
+  {
+    spdlog::error("EngineNull::bindInputBuffer: the buffer has to hold {} bytes, got {}",
+                  required, bytes);
+    return false;
+  }
+  m_externalInput = data;
+  return true;
+}
+
+bool EngineNull::runObjectDetection(const cv::Mat& frame)
+{
+  {
+    PROFILE_SCOPE("EngineNull::preprocess");
+    resizeAndNormalize(frame);
+  }
+
+  PROFILE_SCOPE("EngineNull::postprocess");
+  return (this->*m_postProcess)(m_outputViews, frame.cols, frame.rows, m_candidates,
+                                m_odOutput);
+}
+
+bool EngineNull::runSemanticDetection(const cv::Mat& frame)
+{
+  {
+    PROFILE_SCOPE("EngineNull::preprocess");
+    resizeAndNormalize(frame);
+  }
+
+  PROFILE_SCOPE("EngineNull::postprocess");
+  (this->*m_semanticPostProcess)(m_outputViews.front(), frame.cols, frame.rows);
+  return true;
+}
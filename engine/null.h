@@ -0,0 +1,41 @@
+#pragma once
+
+#include "base.h"
+
+#include <vector>
+
+/**
+ * @brief Null engine, runs no model. The frames are preprocessed to the configured input 
+ * geometry and synthetic outputs of the configured architecture are decoded, so a run 
+ * measures the framework, preprocessing and post-processing cost without any inference.
+ */
+class EngineNull : public AbsEngine
+{
+  std::vector<float> m_output;                    /// \var synthetic output tensor
+  std::vector<TensorView> m_outputViews;          /// \var view of the synthetic output
+  void* m_externalInput {nullptr};                /// \var caller owned input, nullptr = own
+
+  /**
+   * @brief fills the synthetic object detection output, the candidate rows get random
+   * boxes and classes with scores above the confidence threshold, every other row scores 0
+   * @param numBoxes candidate rows of the output
+   * @return output shape
+   */
+  std::vector<int> fillDetections(int numBoxes);
+
+public:
+  /**
+   * @brief returns the bound caller owned buffer as an interleaved float view, else the
+   * engine owned one
+   */
+  InputView inputView(std::size_t slot);
+
+  /**
+   * @brief binds a caller owned interleaved float buffer of the input geometry
+   */
+  bool bindInputBuffer(void* data, std::size_t bytes);
+
+  bool runObjectDetection(const cv::Mat& frame);
+  bool runSemanticDetection(const cv::Mat& frame);
+  bool loadModel(const std::string& path);
+};
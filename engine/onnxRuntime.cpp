@@ -0,0 +1,311 @@
+#include "onnxRuntime.h"
+#include "../utils/profiler/profiler.h"
+#ifdef EDGE_ENGINE_PLUGIN
+#include "plugin.h"
+#endif
+
+#include <spdlog/spdlog.h>
+
+#ifdef HAVE_ONNXRUNTIME
+
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <numeric>
+
+namespace
+{
+GraphOptimizationLevel toOrtLevel(GraphOptimization level)
+{
+  switch (level)
+  {
+    case GraphOptimization::DISABLED: return GraphOptimizationLevel::ORT_DISABLE_ALL;
+    case GraphOptimization::BASIC: return GraphOptimizationLevel::ORT_ENABLE_BASIC;
+    case GraphOptimization::EXTENDED: return GraphOptimizationLevel::ORT_ENABLE_EXTENDED;
+    default: return GraphOptimizationLevel::ORT_ENABLE_ALL;
+  }
+}
+
+// a dynamic batch is pinned to 1, any other dynamic dim can not be preallocated
+bool staticShape(std::vector<std::int64_t>& shape)
+{
+  if (!shape.empty() && shape.front() < 0)
+    shape.front() = 1;
+  return std::all_of(shape.begin(), shape.end(), [](std::int64_t dim) { return dim > 0; });
+}
+
+std::size_t elementCount(const std::vector<std::int64_t>& shape)
+{
+  return std::accumulate(shape.begin(), shape.end(), std::size_t{1}, std::multiplies<>());
+}
+
+// channels first outputs are read as channels last, nothing is moved
+constexpr int kChannelsLast[] {0, 2, 3, 1};
+}
+
+bool EngineOrt::loadModel(const std::string& path)
+{
+  spdlog::info("EngineOrt::loadModel: loading model from {}", path);
+
+  try
+  {
+    Ort::SessionOptions options;
+    options.SetIntraOpNumThreads(m_config->m_intraOpThreads);
+    options.SetInterOpNumThreads(m_config->m_interOpThreads);
+    options.SetExecutionMode(m_config->m_interOpThreads > 1 ? ExecutionMode::ORT_PARALLEL :
+                                                              ExecutionMode::ORT_SEQUENTIAL);
+    options.SetGraphOptimizationLevel(toOrtLevel(m_config->m_graphOptimization));
+
+    // a cached optimized model newer than the source skips the graph optimization, it is
+    // specific to the machine that wrote it
+    std::string sessionPath {path};
+    const std::string& cachePath {m_config->m_optimizedModelPath};
+    if (!cachePath.empty())
+    {
+      std::error_code cacheError;
+      std::error_code modelError;
+      const auto cacheTime {std::filesystem::last_write_time(cachePath, cacheError)};
+      const auto modelTime {std::filesystem::last_write_time(path, modelError)};
+      if (!cacheError && !modelError && cacheTime >= modelTime)
+      {
+        spdlog::info("EngineOrt::loadModel: using the optimized model {}", cachePath);
+        sessionPath = cachePath;
+        options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+      }
+      else
+      {
+        spdlog::info("EngineOrt::loadModel: writing the optimized model to {}", cachePath);
+        options.SetOptimizedModelFilePath(cachePath.c_str());
+      }
+    }
+    m_session = Ort::Session(m_env, sessionPath.c_str(), options);
+
+    if (m_session.GetInputCount() != 1)
+    {
+      spdlog::error("EngineOrt::loadModel: expected one input, the model has {}",
+                    m_session.GetInputCount());
+      return false;
+    }
+    Ort::AllocatorWithDefaultOptions allocator;
+    const Ort::TypeInfo inputType {m_session.GetInputTypeInfo(0)};
+    const auto inputInfo {inputType.GetTensorTypeAndShapeInfo()};
+    std::vector<std::int64_t> inputShape {inputInfo.GetShape()};
+    if (inputInfo.GetElementType() != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT ||
+        inputShape.size() != 4 || !staticShape(inputShape))
+    {
+      spdlog::error("EngineOrt::loadModel: the input has to be a float32 4D tensor with a "
+                    "static frame size");
+      return false;
+    }
+
+    // channels first models keep their 3 input channels in dim 1
+    m_channelsFirst = inputShape[1] == 3;
+    m_inputChannels = static_cast<int>(m_channelsFirst ? inputShape[1] : inputShape[3]);
+    m_height = static_cast<int>(m_channelsFirst ? inputShape[2] : inputShape[1]);
+    m_width = static_cast<int>(m_channelsFirst ? inputShape[3] : inputShape[2]);
+    if (m_inputChannels != 3)
+    {
+      spdlog::error("EngineOrt::loadModel: expected 3 input channels, got {}",
+                    m_inputChannels);
+      return false;
+    }
+
+    m_binding = Ort::IoBinding(m_session);
+    m_values.clear();
+    m_inputName = m_session.GetInputNameAllocated(0, allocator).get();
+    m_inputShape = inputShape;
+    m_inputBuffer.assign(elementCount(inputShape), 0.0f);
+    m_values.push_back(Ort::Value{nullptr});
+    if (!bindInputBuffer(nullptr, 0))
+      return false;
+
+    const std::size_t numOutputs {m_session.GetOutputCount()};
+    m_outputBuffers.resize(numOutputs);
+    m_outputShapes.resize(numOutputs);
+    m_outputViews.clear();
+    for (std::size_t i {0}; i < numOutputs; ++i)
+    {
+      const Ort::TypeInfo outputType {m_session.GetOutputTypeInfo(i)};
+      const auto outputInfo {outputType.GetTensorTypeAndShapeInfo()};
+      const Ort::AllocatedStringPtr name {m_session.GetOutputNameAllocated(i, allocator)};
+      std::vector<std::int64_t>& shape {m_outputShapes[i]};
+      shape = outputInfo.GetShape();
+      if (outputInfo.GetElementType() != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT ||
+          !staticShape(shape))
+      {
+        spdlog::error("EngineOrt::loadModel: output {} has to be float32 with a static "
+                      "shape, export the model with fixed output sizes", name.get());
+        return false;
+      }
+
+      m_outputBuffers[i].assign(elementCount(shape), 0.0f);
+      m_values.push_back(Ort::Value::CreateTensor<float>(m_memoryInfo,
+        m_outputBuffers[i].data(), m_outputBuffers[i].size(), shape.data(), shape.size()));
+      m_binding.BindOutput(name.get(), m_values.back());
+      const std::vector<int> dims(shape.begin(), shape.end());
+      m_outputViews.push_back(TensorView::dense(m_outputBuffers[i].data(),
+                                                TensorDtype::FLOAT32, dims));
+    }
+  }
+  catch (const std::exception& e)
+  {
+    spdlog::error("EngineOrt::loadModel: {}", e.what());
+    return false;
+  }
+
+  // the outputs are bound once, their views never move
+  if (m_config->m_benchType == TestBenchType::OBJECT_DETECTION)
+    return bindArch(m_outputViews);
+  TensorView& output {m_outputViews.front()};
+  if (m_channelsFirst && output.m_rank == 4)
+    output = output.permuted(kChannelsLast);
+  return bindSemantic(output);
+}
+
+bool EngineOrt::runInference(const cv::Mat& frame)
+{
+  {
+    PROFILE_SCOPE("EngineOrt::preprocess");
+    resizeAndNormalize(frame);
+  }
+
+  PROFILE_SCOPE("EngineOrt::inference");
+  try
+  {
+    m_session.Run(Ort::RunOptions{nullptr}, m_binding);
+  }
+  catch (const std::exception& e)
+  {
+    spdlog::error("EngineOrt::runInference: {}", e.what());
+    return false;
+  }
+  return true;
+}
+
+InputView EngineOrt::inputView(std::size_t slot)
+{
+  const std::size_t rowStep {static_cast<std::size_t>(m_width) * sizeof(float) *
+                             (m_channelsFirst ? 1 : m_inputChannels)};
+  return {m_inputData, m_width, m_height, m_inputChannels, CV_32F, rowStep,
+          m_channelsFirst ? rowStep * m_height : 0};
+}
+
+bool EngineOrt::bindInputBuffer(void* data, std::size_t bytes)
+{
+  const std::size_t required {elementCount(m_inputShape) * sizeof(float)};
+  if (data != nullptr && bytes < required)
+  {
+    spdlog::error("EngineOrt::bindInputBuffer: the buffer has to hold {} bytes, got {}",
+                  required, bytes);
+    return false;
+  }
+
+  float* input {data != nullptr ? static_cast<float*>(data) : m_inputBuffer.data()};
+  try
+  {
+    // the input value stays first in m_values, the binding references it
+    m_values.front() = Ort::Value::CreateTensor<float>(m_memoryInfo, input,
+      required / sizeof(float), m_inputShape.data(), m_inputShape.size());
+    m_binding.BindInput(m_inputName.c_str(), m_values.front());
+  }
+  catch (const std::exception& e)
+  {
+    spdlog::error("EngineOrt::bindInputBuffer: {}", e.what());
+    return false;
+  }
+  m_inputData = input;
+  return true;
+}
+
+void EngineOrt::recordOutput(const cv::Mat& frame)
+{
+  if (m_recorder == nullptr)
+    return;
+
+  PROFILE_SCOPE("EngineOrt::record");
+  for (std::size_t i {0}; i < m_outputBuffers.size(); ++i)
+  {
+    const std::vector<std::int64_t>& shape {m_outputShapes[i]};
+    TensorRecordHeader header;
+    header.m_payloadBytes = m_outputBuffers[i].size() * sizeof(float);
+    header.m_frameWidth = frame.cols;
+    header.m_frameHeight = frame.rows;
+    header.m_rank = static_cast<std::uint8_t>(
+      std::min<std::size_t>(shape.size(), TensorRecordHeader::kMaxRank));
+    for (int d {0}; d < header.m_rank; ++d)
+      header.m_dims[d] = static_cast<std::int32_t>(shape[d]);
+    header.m_dtype = TensorDtype::FLOAT32;
+    header.m_outputIdx = static_cast<std::uint8_t>(i);
+    header.m_numOutputs = static_cast<std::uint8_t>(m_outputBuffers.size());
+    m_recorder->record(header, m_outputBuffers[i].data());
+  }
+}
+
+bool EngineOrt::runObjectDetection(const cv::Mat& frame)
+{
+  if (!runInference(frame))
+  {
+    spdlog::error("EngineOrt::runObjectDetection: inference failed");
+    return false;
+  }
+  recordOutput(frame);
+
+  PROFILE_SCOPE("EngineOrt::postprocess");
+  return (this->*m_postProcess)(m_outputViews, frame.cols, frame.rows, m_candidates,
+                                m_odOutput);
+}
+
+bool EngineOrt::runSemanticDetection(const cv::Mat& frame)
+{
+  if (!runInference(frame))
+  {
+    spdlog::error("EngineOrt::runSemanticDetection: inference failed");
+    return false;
+  }
+  recordOutput(frame);
+
+  PROFILE_SCOPE("EngineOrt::postprocess");
+  (this->*m_semanticPostProcess)(m_outputViews.front(), frame.cols, frame.rows);
+  return true;
+}
+
+void EngineOrt::collectMemoryStats(MemoryStats& stats) const
+{
+  stats.m_modelFileBytes = MemoryProbe::fileSize(m_config->m_modelPath);
+}
+
+#else
+
+namespace
+{
+constexpr const char* kMissing {
+  "built without ONNX Runtime, configure with -DENABLE_ONNXRUNTIME=ON"};
+}
+
+bool EngineOrt::loadModel(const std::string& path)
+{
+  spdlog::error("EngineOrt::loadModel: {}", kMissing);
+  return false;
+}
+
+bool EngineOrt::runObjectDetection(const cv::Mat& frame)
+{
+  spdlog::error("EngineOrt::runObjectDetection: {}", kMissing);
+  return false;
+}
+
+bool EngineOrt::runSemanticDetection(const cv::Mat& frame)
+{
+  spdlog::error("EngineOrt::runSemanticDetection: {}", kMissing);
+  return false;
+}
+
+void EngineOrt::collectMemoryStats(MemoryStats& stats) const {}
+
+#endif
+
+#ifdef EDGE_ENGINE_PLUGIN
+EDGE_INFERENCE_ENGINE_PLUGIN(EngineOrt, "onnxruntime")
+#endif
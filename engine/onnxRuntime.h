@@ -0,0 +1,73 @@
+#pragma once
+
+#include "base.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#ifdef HAVE_ONNXRUNTIME
+#include <onnxruntime_cxx_api.h>
+#endif
+
+/**
+ * @brief ONNX Runtime inference engine implementation on the CPU execution provider. Input
+ * and outputs are preallocated and bound once with IOBinding, the preprocessing writes into
+ * the bound input, NCHW inputs plane by plane, and the decoders read the bound outputs in
+ * their layout. Without ONNX Runtime (configure with -DENABLE_ONNXRUNTIME=ON) every call
+ * fails.
+ */
+class EngineOrt : public AbsEngine
+{
+#ifdef HAVE_ONNXRUNTIME
+  Ort::Env m_env {ORT_LOGGING_LEVEL_WARNING, "edge_inference"};
+  Ort::Session m_session {nullptr};
+  Ort::IoBinding m_binding {nullptr};             /// \var input and outputs bound once at load
+  Ort::MemoryInfo m_memoryInfo {Ort::MemoryInfo::CreateCpu(OrtArenaAllocator,
+                                                           OrtMemTypeDefault)};
+  std::vector<float> m_inputBuffer;               /// \var engine owned input tensor data
+  float* m_inputData {nullptr};                   /// \var bound input, owned or caller bound
+  std::string m_inputName;                        /// \var name of the model input
+  std::vector<std::int64_t> m_inputShape;         /// \var static shape of the input
+  std::vector<std::vector<float>> m_outputBuffers; /// \var bound output tensor data
+  std::vector<std::vector<std::int64_t>> m_outputShapes; /// \var shape of every output
+  std::vector<Ort::Value> m_values;               /// \var tensors over the bound buffers
+  std::vector<TensorView> m_outputViews;          /// \var every bound output for the decoder
+  bool m_channelsFirst {false};                   /// \var input (and outputs) are NCHW
+
+  /**
+   * @brief preprocesses the frame into the bound input and runs the session
+   * @param frame input frame
+   * @return true if successful, false otherwise
+   */
+  bool runInference(const cv::Mat& frame);
+
+  /**
+   * @brief streams the bound outputs to the attached recorder, if any
+   * @param frame input frame, its size is stored with the tensor
+   */
+  void recordOutput(const cv::Mat& frame);
+#endif
+
+public:
+#ifdef HAVE_ONNXRUNTIME
+  /**
+   * @brief returns the bound input, planar for a NCHW model
+   * @param slot batch slot, the input has one
+   * @return input view
+   */
+  InputView inputView(std::size_t slot);
+
+  /**
+   * @brief binds a tensor over the buffer as the session input
+   * @param data float buffer, nullptr for the engine owned buffer
+   * @param bytes size of the buffer, at least the input tensor size
+   * @return true if successful, false otherwise
+   */
+  bool bindInputBuffer(void* data, std::size_t bytes);
+#endif
+
+  bool runObjectDetection(const cv::Mat& frame);
+  bool runSemanticDetection(const cv::Mat& frame);
+  bool loadModel(const std::string& path);
+  void collectMemoryStats(MemoryStats& stats) const;
+};
@@ -1,20 +1,349 @@
 #include "openVino.h"
 #include "../utils/profiler/profiler.h"
+#ifdef EDGE_ENGINE_PLUGIN
+#include "plugin.h"
+#endif
 
-bool EngineVino::runObjectDetection(const cv::Mat& frame)
+#include <spdlog/spdlog.h>
+
+#ifdef HAVE_OPENVINO
+
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <filesystem>
+
+namespace
+{
+// channels first models keep their 1 or 3 input channels in dim 1
+ov::Layout modelLayout(const ov::Shape& shape)
+{
+  return shape[1] == 1 || shape[1] == 3 ? ov::Layout{"NCHW"} : ov::Layout{"NHWC"};
+}
+
+// channels first outputs are read as channels last, nothing is moved
+constexpr int kChannelsLast[] {0, 2, 3, 1};
+}
+
+bool EngineVino::loadModel(const std::string& path)
 {
-  // TODO
+  spdlog::info("EngineVino::loadModel: loading model from {}", path);
+
+  bool channelsFirst {false};
+  m_outputViews.clear();
+  try
+  {
+    std::shared_ptr<ov::Model> model {m_core.read_model(path)};
+    if (model->inputs().size() != 1)
+    {
+      spdlog::error("EngineVino::loadModel: expected one input, the model has {}",
+                    model->inputs().size());
+      return false;
+    }
+    const ov::PartialShape& inputShape {model->input().get_partial_shape()};
+    if (inputShape.is_dynamic() || inputShape.rank().get_length() != 4)
+    {
+      spdlog::error("EngineVino::loadModel: the input has to have a static 4D shape");
+      return false;
+    }
+    const ov::Shape shape {inputShape.to_shape()};
+    const ov::Layout layout {modelLayout(shape)};
+    channelsFirst = layout == ov::Layout{"NCHW"};
+    m_height = static_cast<int>(shape[ov::layout::height_idx(layout)]);
+    m_width = static_cast<int>(shape[ov::layout::width_idx(layout)]);
+    m_inputChannels = static_cast<int>(shape[ov::layout::channels_idx(layout)]);
+
+    // the model takes the decoded frame as it is, resize and normalize run inside the graph
+    ov::preprocess::PrePostProcessor ppp(model);
+    ov::preprocess::InputInfo& input {ppp.input()};
+    input.tensor()
+      .set_element_type(ov::element::u8)
+      .set_layout("NHWC")
+      .set_spatial_dynamic_shape();
+    input.preprocess()
+      .convert_element_type(ov::element::f32)
+      .resize(ov::preprocess::ResizeAlgorithm::RESIZE_LINEAR)
+      .scale(255.0f);
+    input.model().set_layout(layout);
+
+    // f16 outputs of compressed IRs are converted by the plugin, outputs keep their layout
+    for (std::size_t i {0}; i < model->outputs().size(); ++i)
+      ppp.output(i).tensor().set_element_type(ov::element::f32);
+    model = ppp.build();
+
+    const ov::hint::PerformanceMode mode {
+      m_config->m_performanceHint == PerformanceHint::THROUGHPUT ?
+        ov::hint::PerformanceMode::THROUGHPUT : ov::hint::PerformanceMode::LATENCY};
+    m_compiledModel = m_core.compile_model(model, "CPU", ov::hint::performance_mode(mode),
+      ov::hint::num_requests(static_cast<std::uint32_t>(m_config->m_inferRequests)));
+
+    std::uint32_t numRequests {static_cast<std::uint32_t>(m_config->m_inferRequests)};
+    if (numRequests == 0)
+      numRequests = m_compiledModel.get_property(ov::optimal_number_of_infer_requests);
+    m_requests.clear();
+    for (std::uint32_t i {0}; i < std::max(numRequests, 1u); ++i)
+      m_requests.push_back(m_compiledModel.create_infer_request());
+    m_contiguous.resize(m_requests.size());
+    spdlog::info("EngineVino::loadModel: compiled for {} with {} infer requests",
+                 performanceHintToString(m_config->m_performanceHint), m_requests.size());
+
+    for (const ov::Output<const ov::Node>& output : m_compiledModel.outputs())
+    {
+      if (output.get_partial_shape().is_dynamic())
+      {
+        spdlog::error("EngineVino::loadModel: output {} has a dynamic shape",
+                      output.get_any_name());
+        return false;
+      }
+      const ov::Shape outputShape {output.get_shape()};
+      const std::vector<int> dims(outputShape.begin(), outputShape.end());
+      m_outputViews.push_back(TensorView::dense(nullptr, TensorDtype::FLOAT32, dims));
+    }
+  }
+  catch (const std::exception& e)
+  {
+    spdlog::error("EngineVino::loadModel: {}", e.what());
+    return false;
+  }
+
+  if (m_config->m_benchType == TestBenchType::OBJECT_DETECTION)
+    return bindArch(m_outputViews);
+  TensorView& output {m_outputViews.front()};
+  if (channelsFirst && output.m_rank == 4)
+    output = output.permuted(kChannelsLast);
+  return bindSemantic(output);
+}
+
+bool EngineVino::setInput(ov::InferRequest& request, const cv::Mat& frame, std::size_t slot)
+{
+  if (frame.type() != CV_8UC(m_inputChannels))
+  {
+    spdlog::error("EngineVino::setInput: expected 8 bit frames with {} channels",
+                  m_inputChannels);
+    return false;
+  }
+
+  const cv::Mat* input {&frame};
+  if (!frame.isContinuous())
+  {
+    frame.copyTo(m_contiguous[slot]);
+    input = &m_contiguous[slot];
+  }
+
+  // the tensor aliases the frame, which outlives the request
+  const ov::Shape shape {1, static_cast<std::size_t>(input->rows),
+                         static_cast<std::size_t>(input->cols),
+                         static_cast<std::size_t>(m_inputChannels)};
+  request.set_input_tensor(ov::Tensor(ov::element::u8, shape, input->data));
+  return true;
+}
+
+bool EngineVino::runInference(const cv::Mat& frame)
+{
+  ov::InferRequest& request {m_requests.front()};
+  {
+    PROFILE_SCOPE("EngineVino::preprocess");
+    if (!setInput(request, frame, 0))
+      return false;
+  }
+
+  PROFILE_SCOPE("EngineVino::inference");
+  try
+  {
+    request.infer();
+  }
+  catch (const std::exception& e)
+  {
+    spdlog::error("EngineVino::runInference: {}", e.what());
+    return false;
+  }
   return true;
 }
 
+void EngineVino::bindOutputs(ov::InferRequest& request, std::vector<TensorView>& outputs)
+{
+  // the tensors are owned by the request, valid until it runs again
+  for (std::size_t i {0}; i < outputs.size(); ++i)
+    outputs[i].m_data = request.get_output_tensor(i).data();
+}
+
+void EngineVino::recordOutput(ov::InferRequest& request, const cv::Mat& frame)
+{
+  if (m_recorder == nullptr)
+    return;
+
+  PROFILE_SCOPE("EngineVino::record");
+  for (std::size_t i {0}; i < m_outputViews.size(); ++i)
+  {
+    const ov::Tensor output {request.get_output_tensor(i)};
+    const ov::Shape& shape {output.get_shape()};
+    TensorRecordHeader header;
+    header.m_payloadBytes = output.get_byte_size();
+    header.m_frameWidth = frame.cols;
+    header.m_frameHeight = frame.rows;
+    header.m_rank = static_cast<std::uint8_t>(
+      std::min<std::size_t>(shape.size(), TensorRecordHeader::kMaxRank));
+    for (int d {0}; d < header.m_rank; ++d)
+      header.m_dims[d] = static_cast<std::int32_t>(shape[d]);
+    header.m_dtype = TensorDtype::FLOAT32;
+    header.m_outputIdx = static_cast<std::uint8_t>(i);
+    header.m_numOutputs = static_cast<std::uint8_t>(m_outputViews.size());
+    m_recorder->record(header, output.data());
+  }
+}
+
+bool EngineVino::setBatchSize(std::size_t batchSize)
+{
+  if (!AbsEngine::setBatchSize(batchSize))
+    return false;
+
+  m_batchOutputViews.assign(batchSize, m_outputViews);
+  if (batchSize > m_requests.size())
+    spdlog::warn("EngineVino::setBatchSize: batch {} is larger than the {} infer requests, "
+                 "it runs in waves", batchSize, m_requests.size());
+  return true;
+}
+
+bool EngineVino::runObjectDetectionBatch(std::span<const cv::Mat> frames)
+{
+  if (frames.size() > m_batchSize)
+  {
+    spdlog::error("EngineVino::runObjectDetectionBatch: {} frames exceed the batch size {}",
+                  frames.size(), m_batchSize);
+    return false;
+  }
+
+  std::atomic<bool> succeeded {true};
+  for (std::size_t first {0}; first < frames.size(); first += m_requests.size())
+  {
+    const std::size_t count {std::min(m_requests.size(), frames.size() - first)};
+    {
+      PROFILE_SCOPE("EngineVino::preprocess");
+      for (std::size_t i {0}; i < count; ++i)
+        if (!setInput(m_requests[i], frames[first + i], i))
+          return false;
+    }
+
+    {
+      PROFILE_SCOPE("EngineVino::inference");
+      try
+      {
+        for (std::size_t i {0}; i < count; ++i)
+          m_requests[i].start_async();
+        for (std::size_t i {0}; i < count; ++i)
+          m_requests[i].wait();
+      }
+      catch (const std::exception& e)
+      {
+        spdlog::error("EngineVino::runObjectDetectionBatch: {}", e.what());
+        return false;
+      }
+    }
+    for (std::size_t i {0}; i < count; ++i)
+      recordOutput(m_requests[i], frames[first + i]);
+
+    // decoded before the next wave reuses the requests
+    PROFILE_SCOPE("EngineVino::postprocess");
+    cv::parallel_for_(cv::Range(0, static_cast<int>(count)), [&](const cv::Range& range) {
+      for (int i {range.start}; i < range.end; ++i)
+      {
+        const std::size_t slot {first + i};
+        std::vector<TensorView>& outputs {m_batchOutputViews[slot]};
+        bindOutputs(m_requests[i], outputs);
+        if (!(this->*m_postProcess)(outputs, frames[slot].cols, frames[slot].rows,
+                                    m_batchCandidates[slot], m_batchOutput[slot]))
+          succeeded = false;
+      }
+    });
+  }
+  return succeeded;
+}
+
+bool EngineVino::runObjectDetection(const cv::Mat& frame)
+{
+  if (!runInference(frame))
+  {
+    spdlog::error("EngineVino::runObjectDetection: inference failed");
+    return false;
+  }
+  ov::InferRequest& request {m_requests.front()};
+  recordOutput(request, frame);
+
+  PROFILE_SCOPE("EngineVino::postprocess");
+  bindOutputs(request, m_outputViews);
+  return (this->*m_postProcess)(m_outputViews, frame.cols, frame.rows, m_candidates,
+                                m_odOutput);
+}
+
 bool EngineVino::runSemanticDetection(const cv::Mat& frame)
 {
-  // TODO
+  if (!runInference(frame))
+  {
+    spdlog::error("EngineVino::runSemanticDetection: inference failed");
+    return false;
+  }
+  ov::InferRequest& request {m_requests.front()};
+  recordOutput(request, frame);
+
+  PROFILE_SCOPE("EngineVino::postprocess");
+  bindOutputs(request, m_outputViews);
+  (this->*m_semanticPostProcess)(m_outputViews.front(), frame.cols, frame.rows);
   return true;
 }
 
+void EngineVino::collectMemoryStats(MemoryStats& stats) const
+{
+  // IR models keep their weights next to the topology
+  stats.m_modelFileBytes = MemoryProbe::fileSize(m_config->m_modelPath);
+  std::filesystem::path weights {m_config->m_modelPath};
+  if (weights.extension() == ".xml")
+  {
+    weights.replace_extension(".bin");
+    stats.m_modelFileBytes += MemoryProbe::fileSize(weights.string());
+  }
+}
+
+#else
+
+namespace
+{
+constexpr const char* kMissing {"built without OpenVINO, configure with -DENABLE_OPENVINO=ON"};
+}
+
 bool EngineVino::loadModel(const std::string& path)
 {
-  // TODO
-  return true;
+  spdlog::error("EngineVino::loadModel: {}", kMissing);
+  return false;
+}
+
+bool EngineVino::setBatchSize(std::size_t batchSize)
+{
+  return AbsEngine::setBatchSize(batchSize);
 }
+
+bool EngineVino::runObjectDetectionBatch(std::span<const cv::Mat> frames)
+{
+  spdlog::error("EngineVino::runObjectDetectionBatch: {}", kMissing);
+  return false;
+}
+
+bool EngineVino::runObjectDetection(const cv::Mat& frame)
+{
+  spdlog::error("EngineVino::runObjectDetection: {}", kMissing);
+  return false;
+}
+
+bool EngineVino::runSemanticDetection(const cv::Mat& frame)
+{
+  spdlog::error("EngineVino::runSemanticDetection: {}", kMissing);
+  return false;
+}
+
+void EngineVino::collectMemoryStats(MemoryStats& stats) const {}
+
+#endif
+
+#ifdef EDGE_ENGINE_PLUGIN
+EDGE_INFERENCE_ENGINE_PLUGIN(EngineVino, "openvino")
+#endif
@@ -2,9 +2,75 @@
 
 #include "base.h"
 
-struct EngineVino : public AbsEngine
+#include <vector>
+#ifdef HAVE_OPENVINO
+#include <openvino/openvino.hpp>
+#endif
+
+/**
+ * @brief OpenVINO inference engine implementation on the CPU plugin. Resize, u8 to f32
+ * conversion and scaling are folded into the compiled model, frames are passed as they are.
+ * Without OpenVINO (configure with -DENABLE_OPENVINO=ON) every call fails.
+ */
+class EngineVino : public AbsEngine
 {
+#ifdef HAVE_OPENVINO
+  ov::Core m_core;                                /// \var OpenVINO runtime
+  ov::CompiledModel m_compiledModel;              /// \var model compiled for the CPU plugin
+  std::vector<ov::InferRequest> m_requests;       /// \var pool of async infer requests
+  std::vector<cv::Mat> m_contiguous;              /// \var scratch: copy of a non contiguous frame
+  std::vector<TensorView> m_outputViews;          /// \var every output for the decoder
+  std::vector<std::vector<TensorView>> m_batchOutputViews; /// \var output views per batch slot
+
+  /**
+   * @brief wraps the frame as the u8 NHWC input tensor of a request, without a copy
+   * @param request infer request
+   * @param frame input frame, BGR
+   * @param slot scratch slot used if the frame is not contiguous
+   * @return true if successful, false otherwise
+   */
+  bool setInput(ov::InferRequest& request, const cv::Mat& frame, std::size_t slot);
+
+  /**
+   * @brief runs the first request of the pool synchronously on one frame
+   * @param frame input frame
+   * @return true if successful, false otherwise
+   */
+  bool runInference(const cv::Mat& frame);
+
+  /**
+   * @brief points the output views at the output tensors of a request
+   * @param request finished infer request
+   * @param outputs output views, one per model output
+   */
+  void bindOutputs(ov::InferRequest& request, std::vector<TensorView>& outputs);
+
+  /**
+   * @brief streams the output tensors of a request to the attached recorder, if any
+   * @param request finished infer request
+   * @param frame input frame, its size is stored with the tensor
+   */
+  void recordOutput(ov::InferRequest& request, const cv::Mat& frame);
+#endif
+
+public:
+  /**
+   * @brief sizes the batch buffers, the frames of a batch are spread over the request pool
+   * @param batchSize frames per batch
+   * @return true if successful, false otherwise
+   */
+  bool setBatchSize(std::size_t batchSize);
+
+  /**
+   * @brief starts every frame on its own infer request of the pool, waits for them and
+   * decodes the outputs in parallel. Batches larger than the pool run in waves.
+   * @param frames input frames, up to the batch size
+   * @return true if successful, false otherwise
+   */
+  bool runObjectDetectionBatch(std::span<const cv::Mat> frames);
+
   bool runObjectDetection(const cv::Mat& frame);
   bool runSemanticDetection(const cv::Mat& frame);
   bool loadModel(const std::string& path);
+  void collectMemoryStats(MemoryStats& stats) const;
 };
@@ -0,0 +1,81 @@
+#include "plugin.h"
+
+#include <spdlog/spdlog.h>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <filesystem>
+#include <map>
+#include <mutex>
+
+std::string EnginePlugin::defaultPath(EngineType type)
+{
+  const std::string file {std::string{"libedge_engine_"} + engineTypeToString(type) + ".so"};
+  const char* dir {std::getenv("EDGE_INFERENCE_PLUGIN_DIR")};
+  if (dir != nullptr && *dir != '\0')
+    return (std::filesystem::path{dir} / file).string();
+
+  std::error_code error;
+  const std::filesystem::path executable {
+    std::filesystem::read_symlink("/proc/self/exe", error)};
+  return error ? file : (executable.parent_path() / file).string();
+}
+
+std::unique_ptr<AbsEngine> EnginePlugin::create(const std::string& path, EngineType type)
+{
+  // plugins are never unloaded, engines created from them may live until exit
+  static std::mutex mtx;
+  static std::map<std::string, const EnginePluginInfo*> loaded;
+
+  const EnginePluginInfo* info {nullptr};
+  {
+    std::lock_guard<std::mutex> lock {mtx};
+    const auto it {loaded.find(path)};
+    if (it != loaded.end())
+    {
+      info = it->second;
+    }
+    else
+    {
+      void* handle {dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL)};
+      if (handle == nullptr)
+      {
+        spdlog::error("EnginePlugin::create: could not load {}: {}", path, dlerror());
+        return nullptr;
+      }
+
+      const auto entry {
+        reinterpret_cast<EnginePluginEntry>(dlsym(handle, kEnginePluginEntry))};
+      info = entry != nullptr ? entry() : nullptr;
+      if (info == nullptr)
+      {
+        spdlog::error("EnginePlugin::create: {} has no {} entry point", path, 
+                      kEnginePluginEntry);
+        dlclose(handle);
+        return nullptr;
+      }
+      if (info->m_abiVersion != kEnginePluginAbiVersion ||
+          info->m_engineSize != sizeof(AbsEngine))
+      {
+        spdlog::error("EnginePlugin::create: {} was built for plugin ABI {} (engine size {}), "
+                      "expected {} ({}), rebuild it against this version", path, 
+                      info->m_abiVersion, info->m_engineSize, kEnginePluginAbiVersion, 
+                      sizeof(AbsEngine));
+        dlclose(handle);
+        return nullptr;
+      }
+      spdlog::info("EnginePlugin::create: loaded {} engine from {}", info->m_engineType, path);
+      loaded.emplace(path, info);
+    }
+  }
+
+  if (info->m_engineType == nullptr || 
+      std::strcmp(info->m_engineType, engineTypeToString(type)) != 0)
+  {
+    spdlog::error("EnginePlugin::create: {} serves {}, configured engine type is {}", path,
+                  info->m_engineType != nullptr ? info->m_engineType : "nothing", 
+                  engineTypeToString(type));
+    return nullptr;
+  }
+  return std::unique_ptr<AbsEngine>(info->m_create());
+}
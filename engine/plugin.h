@@ -0,0 +1,69 @@
+#pragma once
+
+#include "base.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/// \var version of the engine plugin ABI, bumped whenever AbsEngine or EnginePluginInfo change
+constexpr std::uint32_t kEnginePluginAbiVersion {3};
+
+/// \var name of the entry point every engine plugin exports
+constexpr const char* kEnginePluginEntry {"edge_inference_engine_plugin"};
+
+extern "C"
+{
+/**
+ * @brief EnginePluginInfo describes an engine plugin, returned by its entry point
+ */
+struct EnginePluginInfo
+{
+  std::uint32_t m_abiVersion;             /// \var kEnginePluginAbiVersion of the plugin build
+  std::uint32_t m_engineSize;             /// \var sizeof(AbsEngine) of the plugin build
+  const char* m_engineType;               /// \var config string of the engine type it serves
+  AbsEngine* (*m_create)();               /// \var creates an engine, released with delete
+};
+
+/// \brief signature of the entry point
+using EnginePluginEntry = const EnginePluginInfo* (*)();
+}
+
+/**
+ * @brief defines the entry point of an engine plugin, used once in the plugin sources
+ * @param EngineClass AbsEngine implementation, default constructible
+ * @param engineType config string of the engine type, e.g. "openvino"
+ */
+#define EDGE_INFERENCE_ENGINE_PLUGIN(EngineClass, engineType)                              \
+  extern "C" __attribute__((visibility("default"))) const EnginePluginInfo*               \
+  edge_inference_engine_plugin()                                                          \
+  {                                                                                       \
+    static const EnginePluginInfo info {kEnginePluginAbiVersion,                          \
+      static_cast<std::uint32_t>(sizeof(AbsEngine)), engineType,                          \
+      []() -> AbsEngine* { return new EngineClass(); }};                                  \
+    return &info;                                                                         \
+  }
+
+/**
+ * @brief EnginePlugin loads engines from shared objects on demand. A plugin stays mapped
+ * for the rest of the process once loaded, the code of its engines lives in it.
+ */
+struct EnginePlugin
+{
+  /**
+   * @brief returns the default plugin file of an engine type: libedge_engine_<type>.so in
+   * $EDGE_INFERENCE_PLUGIN_DIR, or next to the executable
+   * @param type engine type
+   * @return plugin path
+   */
+  static std::string defaultPath(EngineType type);
+
+  /**
+   * @brief loads the plugin (once) and creates an engine, the plugin has to match the ABI
+   * version, the AbsEngine layout and the engine type
+   * @param path plugin file
+   * @param type configured engine type
+   * @return engine, nullptr on error
+   */
+  static std::unique_ptr<AbsEngine> create(const std::string& path, EngineType type);
+};
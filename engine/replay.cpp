@@ -0,0 +1,86 @@
+#include "replay.h"
+#include "../utils/profiler/profiler.h"
+
+#include <spdlog/spdlog.h>
+
+bool EngineReplay::loadModel(const std::string& path)
+{
+  spdlog::info("EngineReplay::loadModel: replaying recorded outputs from {}", path);
+  if (!m_recording.open(path))
+  {
+    spdlog::error("EngineReplay::loadModel: could not open recording: {}", path);
+    return false;
+  }
+
+  const RecordingHeader& header {m_recording.fileHeader()};
+  if (header.m_benchType != static_cast<std::uint32_t>(m_config->m_benchType))
+    spdlog::warn("EngineReplay::loadModel: recording was made with bench type {}, "
+                 "configured {}", header.m_benchType, 
+                 static_cast<std::uint32_t>(m_config->m_benchType));
+  m_nextFrame = 0;
+
+  // quantized tensors are decoded from the mapped payloads with their recorded parameters
+  m_outputViews.clear();
+  for (std::size_t i {0}; i < m_recording.numOutputs(0); ++i)
+  {
+    const TensorRecordHeader& output {m_recording.header(0, i)};
+    m_outputViews.push_back(TensorView::dense(nullptr, output.m_dtype,
+      std::span<const int>(output.m_dims, output.m_rank), output.m_scale, output.m_zeroPoint));
+  }
+
+  if (m_config->m_benchType != TestBenchType::OBJECT_DETECTION)
+  {
+    // channels first recordings have fewer channels than columns
+    TensorView& output {m_outputViews.front()};
+    constexpr int kChannelsLast[] {0, 2, 3, 1};
+    if (output.m_rank == 4 && output.dim(1) < output.dim(3))
+      output = output.permuted(kChannelsLast);
+    return bindSemantic(output);
+  }
+
+  // the recording knows the architecture it was made with, the config can override it
+  if (m_config->m_arch == ModelArch::UNKNOWN && 
+      header.m_arch < static_cast<std::uint32_t>(ModelArch::UNKNOWN))
+    m_config->m_arch = static_cast<ModelArch>(header.m_arch);
+  else if (header.m_arch != static_cast<std::uint32_t>(m_config->m_arch))
+    spdlog::warn("EngineReplay::loadModel: recording was made with arch {}, configured {}",
+                 header.m_arch, static_cast<std::uint32_t>(m_config->m_arch));
+  return bindArch(m_outputViews);
+}
+
+std::size_t EngineReplay::nextFrame()
+{
+  const std::size_t frame {m_nextFrame};
+  m_nextFrame = (m_nextFrame + 1) % m_recording.numFrames();
+  return frame;
+}
+
+void EngineReplay::bindOutputs(std::size_t frame)
+{
+  // payloads are aligned in the file, every tensor is used in place
+  for (std::size_t i {0}; i < m_outputViews.size(); ++i)
+    m_outputViews[i].m_data = m_recording.payload(frame, i);
+}
+
+bool EngineReplay::runObjectDetection(const cv::Mat& frame)
+{
+  const std::size_t recorded {nextFrame()};
+  const TensorRecordHeader& header {m_recording.header(recorded)};
+  bindOutputs(recorded);
+
+  PROFILE_SCOPE("EngineReplay::postprocess");
+  return (this->*m_postProcess)(m_outputViews, header.m_frameWidth, header.m_frameHeight,
+                                m_candidates, m_odOutput);
+}
+
+bool EngineReplay::runSemanticDetection(const cv::Mat& frame)
+{
+  const std::size_t recorded {nextFrame()};
+  const TensorRecordHeader& header {m_recording.header(recorded)};
+  bindOutputs(recorded);
+
+  PROFILE_SCOPE("EngineReplay::postprocess");
+  (this->*m_semanticPostProcess)(m_outputViews.front(), header.m_frameWidth,
+                                 header.m_frameHeight);
+  return true;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "base.h"
+
+/**
+ * @brief Replay engine, feeds recorded raw output tensors straight to the post-processing
+ * instead of running a model. The model path is the recording file, the recorded frame
+ * sizes are used instead of the input frames, and the recording is cycled.
+ */
+class EngineReplay : public AbsEngine
+{
+  TensorRecording m_recording;                    /// \var mapped recording
+  std::size_t m_nextFrame {0};                    /// \var next recorded frame
+  std::vector<TensorView> m_outputViews;          /// \var recorded outputs, read in place
+
+  /**
+   * @brief advances to the next recorded frame, the recording is cycled
+   * @return recorded frame index
+   */
+  std::size_t nextFrame();
+
+  /**
+   * @brief points the output views at the tensors of a recorded frame
+   * @param frame recorded frame index
+   */
+  void bindOutputs(std::size_t frame);
+
+public:
+  bool runObjectDetection(const cv::Mat& frame);
+  bool runSemanticDetection(const cv::Mat& frame);
+  bool loadModel(const std::string& path);
+};
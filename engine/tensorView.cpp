@@ -0,0 +1,58 @@
+#include "tensorView.h"
+
+#include <algorithm>
+
+TensorView TensorView::dense(const void* data, TensorDtype dtype, std::span<const int> dims,
+                             float scale, std::int32_t zeroPoint)
+{
+  TensorView view;
+  view.m_data = data;
+  view.m_dtype = dtype;
+  view.m_rank = static_cast<int>(std::min<std::size_t>(dims.size(), kMaxRank));
+  std::int64_t stride {1};
+  for (int d {view.m_rank - 1}; d >= 0; --d)
+  {
+    view.m_dims[d] = dims[d];
+    view.m_strides[d] = stride;
+    stride *= std::max(dims[d], 1);
+  }
+
+  // tensors without quantization parameters are read as they are
+  view.m_scale = scale != 0.0f ? scale : 1.0f;
+  view.m_zeroPoint = scale != 0.0f ? zeroPoint : 0;
+  return view;
+}
+
+std::size_t TensorView::elementSize(TensorDtype dtype)
+{
+  switch (dtype)
+  {
+    case TensorDtype::FLOAT32: return sizeof(float);
+    case TensorDtype::UINT8: return sizeof(std::uint8_t);
+    case TensorDtype::INT8: return sizeof(std::int8_t);
+    case TensorDtype::INT32: return sizeof(std::int32_t);
+    default: return 0;
+  }
+}
+
+TensorView TensorView::permuted(std::span<const int> order) const
+{
+  TensorView view {*this};
+  for (int d {0}; d < m_rank && d < static_cast<int>(order.size()); ++d)
+  {
+    view.m_dims[d] = m_dims[order[d]];
+    view.m_strides[d] = m_strides[order[d]];
+  }
+  return view;
+}
+
+TensorView TensorView::slice(std::size_t index) const
+{
+  TensorView view {*this};
+  if (m_rank == 0)
+    return view;
+  view.m_data = static_cast<const std::uint8_t*>(m_data) +
+                static_cast<std::int64_t>(index) * m_strides[0] * elementSize(m_dtype);
+  view.m_dims[0] = 1;
+  return view;
+}
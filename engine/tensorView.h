@@ -0,0 +1,123 @@
+#pragma once
+
+#include "../utils/recorder/recorder.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief TensorView describes an output tensor where the engine left it: element type,
+ * shape, element strides and quantization. Engines build the views once at load, the
+ * decoders are bound to the layout and element type then, per frame only m_data moves.
+ */
+struct TensorView
+{
+  static constexpr int kMaxRank {TensorRecordHeader::kMaxRank};
+
+  const void* m_data {nullptr};                   /// \var first element
+  TensorDtype m_dtype {TensorDtype::FLOAT32};     /// \var element type
+  int m_rank {0};                                 /// \var number of valid dims
+  std::array<int, kMaxRank> m_dims {};            /// \var shape
+  std::array<std::int64_t, kMaxRank> m_strides {}; /// \var elements between steps of a dim
+  float m_scale {1.0f};                           /// \var quantization scale, 1 if not quantized
+  std::int32_t m_zeroPoint {0};                   /// \var quantization zero point
+
+  /**
+   * @brief creates a view of a dense row-major tensor
+   * @param data first element, may be set later
+   * @param dtype element type
+   * @param dims shape, up to kMaxRank dims
+   * @param scale quantization scale, 0 if not quantized
+   * @param zeroPoint quantization zero point
+   * @return tensor view
+   */
+  static TensorView dense(const void* data, TensorDtype dtype, std::span<const int> dims,
+                          float scale = 0.0f, std::int32_t zeroPoint = 0);
+
+  /**
+   * @brief returns the size of one element of a type
+   * @param dtype element type
+   * @return bytes per element, 0 if unknown
+   */
+  static std::size_t elementSize(TensorDtype dtype);
+
+  /**
+   * @brief returns a dim, negative indexes count from the last dim
+   * @param d dim index
+   * @return size of the dim
+   */
+  int dim(int d) const { return m_dims[d < 0 ? m_rank + d : d]; }
+
+  /**
+   * @brief returns a stride, negative indexes count from the last dim
+   * @param d dim index
+   * @return elements between steps of the dim
+   */
+  std::int64_t stride(int d) const { return m_strides[d < 0 ? m_rank + d : d]; }
+
+  /**
+   * @brief returns the shape as a vector
+   * @return dims
+   */
+  std::vector<int> shape() const { return {m_dims.begin(), m_dims.begin() + m_rank}; }
+
+  /**
+   * @brief returns the same data with the dims reordered, nothing is moved, e.g. a NCHW
+   * tensor read as NHWC with order {0, 2, 3, 1}
+   * @param order source dim of every dim of the result
+   * @return permuted view
+   */
+  TensorView permuted(std::span<const int> order) const;
+
+  /**
+   * @brief returns the view of one index of the first dim, a batch slot
+   * @param index index in the first dim
+   * @return view with a first dim of 1
+   */
+  TensorView slice(std::size_t index) const;
+};
+
+/**
+ * @brief element type of a TensorDtype, the decoders are instantiated for each
+ */
+template <TensorDtype Dtype> struct TensorElement;
+template <> struct TensorElement<TensorDtype::FLOAT32> { using type = float; };
+template <> struct TensorElement<TensorDtype::UINT8> { using type = std::uint8_t; };
+template <> struct TensorElement<TensorDtype::INT8> { using type = std::int8_t; };
+template <> struct TensorElement<TensorDtype::INT32> { using type = std::int32_t; };
+
+/**
+ * @brief reads the elements of a view as floats, dequantizing integer elements on the fly
+ */
+template <TensorDtype Dtype>
+class TensorReader
+{
+  using Element = typename TensorElement<Dtype>::type;
+
+  const Element* m_data;                          /// \var first element
+  float m_scale;                                  /// \var quantization scale
+  float m_zeroPoint;                              /// \var quantization zero point
+
+public:
+  explicit TensorReader(const TensorView& view)
+    : m_data {static_cast<const Element*>(view.m_data)}, m_scale {view.m_scale},
+      m_zeroPoint {static_cast<float>(view.m_zeroPoint)}
+  {}
+
+  /**
+   * @brief returns an element
+   * @param offset element offset, sum of index times stride over the dims
+   * @return value of the element
+   */
+  float operator[](std::int64_t offset) const
+  {
+    if constexpr (std::is_same_v<Element, float>)
+      return m_data[offset];
+    else
+      return m_scale * (static_cast<float>(m_data[offset]) - m_zeroPoint);
+  }
+};
@@ -1,12 +1,35 @@
 #include "tfLite.h"
-#include "../../utils/profiler/profiler.h"
+#include "../utils/profiler/profiler.h"
 
 #include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <fstream>
+#include <string_view>
+#include <tensorflow/lite/core/subgraph.h>
 #include <tensorflow/lite/interpreter_builder.h>
 #include <tensorflow/lite/kernels/register.h>
 #include <spdlog/spdlog.h>
 
+namespace
+{
+// alignment TFLite requires of custom allocations (tflite::kDefaultTensorAlignment)
+constexpr std::size_t kInputAlignment {64};
+
+TensorDtype toDtype(TfLiteType type)
+{
+  switch (type)
+  {
+    case kTfLiteFloat32: return TensorDtype::FLOAT32;
+    case kTfLiteUInt8: return TensorDtype::UINT8;
+    case kTfLiteInt8: return TensorDtype::INT8;
+    case kTfLiteInt32: return TensorDtype::INT32;
+    default: return TensorDtype::UNKNOWN;
+  }
+}
+}
+
 bool EngineLite::loadModel(const std::string& path)
 {
   spdlog::info("EngineLite::loadModel: loading model from {}", path);
@@ -33,7 +56,24 @@ bool EngineLite::loadModel(const std::string& path)
   }
 
   m_inputTensor = m_interpreter->tensor(m_interpreter->inputs()[0]);
-  m_outputTensor = m_interpreter->tensor(m_interpreter->outputs()[0]);
+  m_outputTensors.clear();
+  for (const int output : m_interpreter->outputs())
+    m_outputTensors.push_back(m_interpreter->tensor(output));
+
+  // exporters do not keep the op output order, the tensor names do: the op name for the
+  // boxes, then ":1" classes, ":2" scores and ":3" count
+  auto opOutputIdx = [](const TfLiteTensor* tensor) {
+    const std::string_view name {tensor->name != nullptr ? tensor->name : ""};
+    const std::size_t colon {name.rfind(':')};
+    return colon == std::string_view::npos ? 0 : std::atoi(name.data() + colon + 1);
+  };
+  if (m_outputTensors.size() == 4 && std::all_of(m_outputTensors.begin(), m_outputTensors.end(),
+      [](const TfLiteTensor* tensor) { return tensor->name != nullptr && 
+        std::string_view(tensor->name).find("TFLite_Detection_PostProcess") == 0; }))
+    std::sort(m_outputTensors.begin(), m_outputTensors.end(), 
+              [&](const TfLiteTensor* a, const TfLiteTensor* b) {
+                return opOutputIdx(a) < opOutputIdx(b); });
+  m_outputTensor = m_outputTensors.empty() ? nullptr : m_outputTensors.front();
 
   if (m_inputTensor == nullptr || m_outputTensor == nullptr)
   {
@@ -54,64 +94,254 @@ bool EngineLite::loadModel(const std::string& path)
     return false;
   } 
 
+  if (m_inputTensor->type != kTfLiteFloat32 && m_inputTensor->type != kTfLiteUInt8)
+  {
+    spdlog::error("EngineLite::loadModel: the input has to be float32 or uint8");
+    return false;
+  }
+  m_externalInput = nullptr;
+  m_externalInputBytes = 0;
+  if (!bindInputBuffer(nullptr, 0))
+    return false;
+
+  // quantized outputs are decoded in place, the views carry their scale and zero point
+  m_outputViews.clear();
+  for (const TfLiteTensor* output : m_outputTensors)
+    m_outputViews.push_back(TensorView::dense(output->data.raw, toDtype(output->type),
+      std::span<const int>(output->dims->data, output->dims->size), output->params.scale,
+      output->params.zero_point));
+
+  if (m_config->m_benchType != TestBenchType::OBJECT_DETECTION)
+    return bindSemantic(m_outputViews.front());
+  return bindArch(m_outputViews);
+}
+
+bool EngineLite::runInference(const cv::Mat& frame)
+{
+  {
+    PROFILE_SCOPE("EngineLite::preprocess");
+    // resize and normalize the input frame straight into the input tensor
+    resizeAndNormalize(frame);
+  }
+
+  // run inference
+  PROFILE_SCOPE("EngineLite::inference");
+  if (m_interpreter->Invoke() != kTfLiteOk)
+    return false;
+
+  // tensor data moves when the tensors are reallocated
+  for (std::size_t i {0}; i < m_outputTensors.size(); ++i)
+    m_outputViews[i].m_data = m_outputTensors[i]->data.raw;
   return true;
 }
 
-float* EngineLite::runInference(const cv::Mat& frame)
+
+void EngineLite::recordOutput(const cv::Mat& frame, std::size_t slot)
 {
-  // resize and normalize the input frame
-  resizeAndNormalize(frame);
+  if (m_recorder == nullptr)
+    return;
 
-  // copy data to input tensor
-  memcpy(m_inputTensor->data.f, m_normalizedFrame.data, 
-         m_normalizedFrame.total() * m_normalizedFrame.elemSize());
+  PROFILE_SCOPE("EngineLite::record");
+  for (std::size_t i {0}; i < m_outputTensors.size(); ++i)
+  {
+    const TfLiteTensor* output {m_outputTensors[i]};
+    const std::size_t sliceBytes {output->bytes / std::max(output->dims->data[0], 1)};
+    TensorRecordHeader header;
+    header.m_payloadBytes = sliceBytes;
+    header.m_frameWidth = frame.cols;
+    header.m_frameHeight = frame.rows;
+    header.m_rank = static_cast<std::uint8_t>(
+      std::min(output->dims->size, TensorRecordHeader::kMaxRank));
+    for (int d {0}; d < header.m_rank; ++d)
+      header.m_dims[d] = output->dims->data[d];
+    header.m_dims[0] = 1;
+    header.m_dtype = toDtype(output->type);
+    header.m_scale = output->params.scale;
+    header.m_zeroPoint = output->params.zero_point;
+    header.m_outputIdx = static_cast<std::uint8_t>(i);
+    header.m_numOutputs = static_cast<std::uint8_t>(m_outputTensors.size());
+    m_recorder->record(header, output->data.raw + slot * sliceBytes);
+  }
+}
 
-  // run inference
-  return m_interpreter->Invoke() != kTfLiteOk ? nullptr : m_outputTensor->data.f;
+bool EngineLite::setBatchSize(std::size_t batchSize)
+{
+  if (!AbsEngine::setBatchSize(batchSize))
+    return false;
+
+  const int batch {static_cast<int>(batchSize)};
+  if (m_inputTensor->dims->data[0] != batch)
+  {
+    // the custom allocation is validated against the resized input when it is rebound
+    const int input {m_interpreter->inputs()[0]};
+    if (m_interpreter->ResizeInputTensor(input, {batch, m_height, m_width, m_inputChannels}) !=
+        kTfLiteOk || !bindInputBuffer(m_externalInput, m_externalInputBytes))
+    {
+      spdlog::error("EngineLite::setBatchSize: could not resize the input to batch {}", batch);
+      return false;
+    }
+  }
+
+  for (const TfLiteTensor* output : m_outputTensors)
+  {
+    if (output->dims->data[0] != batch)
+    {
+      spdlog::error("EngineLite::setBatchSize: output {} has batch {} instead of {}, the "
+                    "model does not support batching", output->name != nullptr ? 
+                    output->name : "", output->dims->data[0], batch);
+      return false;
+    }
+  }
+  m_batchOutputViews.assign(batchSize, m_outputViews);
+  m_batchResized.resize(batchSize);
+  spdlog::info("EngineLite::setBatchSize: batch size {}", batch);
+  return true;
 }
 
+bool EngineLite::runObjectDetectionBatch(std::span<const cv::Mat> frames)
+{
+  if (frames.size() > m_batchSize)
+  {
+    spdlog::error("EngineLite::runObjectDetectionBatch: {} frames exceed the batch size {}",
+                  frames.size(), m_batchSize);
+    return false;
+  }
+  const int numFrames {static_cast<int>(frames.size())};
+
+  {
+    // slots of a partial batch keep their previous frame, their outputs are not decoded
+    PROFILE_SCOPE("EngineLite::preprocess");
+    cv::parallel_for_(cv::Range(0, numFrames), [&](const cv::Range& range) {
+      cv::Mat plane;
+      for (int i {range.start}; i < range.end; ++i)
+        preprocess(frames[i], inputView(i), m_batchResized[i], plane);
+    });
+  }
+
+  {
+    PROFILE_SCOPE("EngineLite::inference");
+    if (m_interpreter->Invoke() != kTfLiteOk)
+    {
+      spdlog::error("EngineLite::runObjectDetectionBatch: inference failed");
+      return false;
+    }
+  }
+  for (int i {0}; i < numFrames; ++i)
+    recordOutput(frames[i], i);
+
+  PROFILE_SCOPE("EngineLite::postprocess");
+  std::atomic<bool> succeeded {true};
+  cv::parallel_for_(cv::Range(0, numFrames), [&](const cv::Range& range) {
+    for (int i {range.start}; i < range.end; ++i)
+    {
+      std::vector<TensorView>& outputs {m_batchOutputViews[i]};
+      for (std::size_t o {0}; o < m_outputTensors.size(); ++o)
+      {
+        outputs[o].m_data = m_outputTensors[o]->data.raw;
+        outputs[o] = outputs[o].slice(i);
+      }
+      if (!(this->*m_postProcess)(outputs, frames[i].cols, frames[i].rows, m_batchCandidates[i],
+                                  m_batchOutput[i]))
+        succeeded = false;
+    }
+  });
+  return succeeded;
+}
+
+InputView EngineLite::inputView(std::size_t slot)
+{
+  const std::size_t elementSize {m_inputTensor->type == kTfLiteUInt8 ? sizeof(std::uint8_t) :
+                                                                       sizeof(float)};
+  const std::size_t rowStep {static_cast<std::size_t>(m_width) * m_inputChannels * elementSize};
+  return {m_inputTensor->data.raw + slot * rowStep * m_height, m_width, m_height,
+          m_inputChannels, m_inputTensor->type == kTfLiteUInt8 ? CV_8U : CV_32F, rowStep, 0};
+}
+
+bool EngineLite::bindInputBuffer(void* data, std::size_t bytes)
+{
+  const int input {m_interpreter->inputs()[0]};
+  const std::size_t required {m_interpreter->tensor(input)->bytes};
+  void* buffer {data};
+  std::size_t bufferBytes {bytes};
+  if (data == nullptr)
+  {
+    // aligned_alloc takes multiples of the alignment, the buffer only grows
+    const std::size_t size {(required + kInputAlignment - 1) / kInputAlignment * kInputAlignment};
+    if (m_inputBufferBytes < size)
+    {
+      m_inputBuffer.reset(static_cast<std::uint8_t*>(std::aligned_alloc(kInputAlignment, size)));
+      m_inputBufferBytes = m_inputBuffer != nullptr ? size : 0;
+    }
+    buffer = m_inputBuffer.get();
+    bufferBytes = m_inputBufferBytes;
+    if (buffer == nullptr)
+    {
+      spdlog::error("EngineLite::bindInputBuffer: could not allocate {} input bytes", size);
+      return false;
+    }
+  }
+  else if (reinterpret_cast<std::uintptr_t>(data) % kInputAlignment != 0 || bytes < required)
+  {
+    spdlog::error("EngineLite::bindInputBuffer: the buffer has to be {} byte aligned and hold "
+                  "{} bytes, got {}", kInputAlignment, required, bytes);
+    return false;
+  }
+
+  if (m_interpreter->SetCustomAllocationForTensor(input, {buffer, bufferBytes}) != kTfLiteOk ||
+      m_interpreter->AllocateTensors() != kTfLiteOk)
+  {
+    spdlog::error("EngineLite::bindInputBuffer: could not assign the input buffer");
+    return false;
+  }
+  m_inputTensor = m_interpreter->tensor(input);
+  m_externalInput = data;
+  m_externalInputBytes = data != nullptr ? bytes : 0;
+  return true;
+}
 
 bool EngineLite::runObjectDetection(const cv::Mat& frame)
 {
-  float* outputData {runInference(frame)};
-  if (outputData == nullptr)
+  if (!runInference(frame))
   {
     spdlog::error("EngineLite::runObjectDetection: inference failed");
     return false;
   }
-  m_numBoxes = m_outputTensor->dims->data[1];
-  switch (m_config->m_arch)
-  {
-    case ModelArch::YOLO5:
-      return yoloFivePostProc(outputData, frame.cols, frame.rows);
-    case ModelArch::YOLOV8:
-      return yoloEightPostProc(outputData, frame.cols, frame.rows);
-    case ModelArch::YOLO10:
-      return yoloTenPostProc(outputData, frame.cols, frame.rows);
-    case ModelArch::SSD:
-      return ssdPostProc(outputData, frame.cols, frame.rows);
-    default:
-      spdlog::error("EngineLite::runObjectDetection: unsupported architecture");
-      return false;
-  }
+  recordOutput(frame);
+
+  PROFILE_SCOPE("EngineLite::postprocess");
+  return (this->*m_postProcess)(m_outputViews, frame.cols, frame.rows, m_candidates,
+                                m_odOutput);
 }
 
 bool EngineLite::runSemanticDetection(const cv::Mat& frame)
 {
-  float* outputData {runInference(frame)};
-  if (outputData == nullptr)
+  if (!runInference(frame))
   {
     spdlog::error("EngineLite::runSemanticDetection: inference failed");
     return false;
   }
+  recordOutput(frame);
 
-  // get output tensor dimensions
-  const int outH {m_outputTensor->dims->data[1]};
-  const int outW {m_outputTensor->dims->data[2]};
-  const int numClasses {m_outputTensor->dims->data[3]};
-
-  semanticPostProc(outputData, outW, outH, numClasses, frame.cols, frame.rows);
-
+  PROFILE_SCOPE("EngineLite::postprocess");
+  (this->*m_semanticPostProcess)(m_outputViews.front(), frame.cols, frame.rows);
   return true;
 }
 
+
+void EngineLite::collectMemoryStats(MemoryStats& stats) const
+{
+  if (m_interpreter == nullptr || m_flatBufferModel == nullptr)
+    return;
+
+  tflite::SubgraphAllocInfo allocInfo {};
+  m_interpreter->primary_subgraph().GetMemoryAllocInfo(&allocInfo);
+  stats.m_arenaBytes = allocInfo.arena_size;
+  stats.m_arenaPersistentBytes = allocInfo.arena_persist_size;
+
+  // the flatbuffer is mmapped, only the touched pages count towards the rss
+  const tflite::Allocation* allocation {m_flatBufferModel->allocation()};
+  if (allocation != nullptr)
+    stats.m_modelResidentBytes = MemoryProbe::residentBytes(allocation->base(), 
+                                                            allocation->bytes());
+  stats.m_modelFileBytes = MemoryProbe::fileSize(m_config->m_modelPath);
+}
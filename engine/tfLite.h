@@ -1,24 +1,91 @@
 #pragma once
 
+#include <cstdint>
+#include <cstdlib>
 #include <memory>
+#include <vector>
 #include <tensorflow/lite/model.h>
 
 #include "base.h"
 
 /**
- * @brief TensorFlow Lite inference engine implementation
+ * @brief TensorFlow Lite inference engine implementation. The input tensor is a custom
+ * allocation over an aligned buffer, engine owned or bound by the caller, that the
+ * preprocessing writes into.
  */
 class EngineLite : public AbsEngine
 {
+  /// \brief releases buffers of std::aligned_alloc
+  struct AlignedFree
+  {
+    void operator()(std::uint8_t* data) const { std::free(data); }
+  };
+
   std::unique_ptr<tflite::FlatBufferModel> m_flatBufferModel {nullptr};
   std::unique_ptr<tflite::Interpreter> m_interpreter {nullptr};
   TfLiteTensor* m_inputTensor {nullptr};
   TfLiteTensor* m_outputTensor {nullptr};
+  std::vector<TfLiteTensor*> m_outputTensors;     /// \var every output, SSD postprocess in op order
+  std::vector<TensorView> m_outputViews;          /// \var every output for the decoder
+  std::vector<std::vector<TensorView>> m_batchOutputViews; /// \var output slices per batch slot
+  std::vector<cv::Mat> m_batchResized;            /// \var scratch: resized frame per batch slot
+  std::unique_ptr<std::uint8_t, AlignedFree> m_inputBuffer; /// \var engine owned input
+  std::size_t m_inputBufferBytes {0};             /// \var size of the engine owned input
+  void* m_externalInput {nullptr};                /// \var caller bound input, nullptr if owned
+  std::size_t m_externalInputBytes {0};           /// \var size of the caller bound input
+
+  /**
+   * @brief preprocesses the frame into the input tensor, invokes and points the output
+   * views at the output tensors
+   * @param frame input frame
+   * @return true if successful, false otherwise
+   */
+  bool runInference(const cv::Mat& frame);
 
-  float* runInference(const cv::Mat& frame);
+  /**
+   * @brief streams the output tensors to the attached recorder, if any. Every batch slot is
+   * recorded as its own frame.
+   * @param frame input frame, its size is stored with the tensor
+   * @param slot batch slot of the frame
+   */
+  void recordOutput(const cv::Mat& frame, std::size_t slot = 0);
 
 public:
+  /**
+   * @brief resizes the batch dimension of the input and reallocates the tensors, every
+   * output has to follow the batch dimension
+   * @param batchSize frames per batch
+   * @return true if successful, false otherwise
+   */
+  bool setBatchSize(std::size_t batchSize);
+
+  /**
+   * @brief preprocesses the frames in parallel straight into their input slots, invokes
+   * once and decodes the output slices in parallel
+   * @param frames input frames, up to the batch size
+   * @return true if successful, false otherwise
+   */
+  bool runObjectDetectionBatch(std::span<const cv::Mat> frames);
+
+  /**
+   * @brief returns the slice of the input tensor of a batch slot, float32 inputs are
+   * normalized, uint8 inputs take the pixels as they are
+   * @param slot batch slot
+   * @return input view
+   */
+  InputView inputView(std::size_t slot);
+
+  /**
+   * @brief assigns the buffer as the custom allocation of the input tensor and reallocates
+   * the tensors. A batch resize keeps the binding if the buffer is large enough.
+   * @param data buffer aligned to 64 bytes, nullptr for the engine owned buffer
+   * @param bytes size of the buffer, at least the input tensor size
+   * @return true if successful, false otherwise
+   */
+  bool bindInputBuffer(void* data, std::size_t bytes);
+
   bool runObjectDetection(const cv::Mat& frame);
   bool runSemanticDetection(const cv::Mat& input);
   bool loadModel(const std::string& path);
+  void collectMemoryStats(MemoryStats& stats) const;
 };
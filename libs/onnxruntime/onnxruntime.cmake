@@ -0,0 +1,41 @@
+include(FetchContent)
+
+# prebuilt CPU release, the source build takes far longer than the rest of the project
+set(ORT_VERSION "1.20.1")
+
+# the archive is verified before it is extracted, the digests belong to ORT_VERSION and have
+# to be updated with it (sha256sum of the release asset)
+set(ONNXRUNTIME_SHA256_X64 "" CACHE STRING 
+  "SHA256 of onnxruntime-linux-x64-${ORT_VERSION}.tgz")
+set(ONNXRUNTIME_SHA256_AARCH64 "" CACHE STRING 
+  "SHA256 of onnxruntime-linux-aarch64-${ORT_VERSION}.tgz")
+if(CMAKE_SYSTEM_PROCESSOR MATCHES "aarch64|arm64")
+  set(ORT_ARCH "aarch64")
+  set(ORT_SHA256 ${ONNXRUNTIME_SHA256_AARCH64})
+else()
+  set(ORT_ARCH "x64")
+  set(ORT_SHA256 ${ONNXRUNTIME_SHA256_X64})
+endif()
+
+set(ORT_ARCHIVE onnxruntime-linux-${ORT_ARCH}-${ORT_VERSION}.tgz)
+if(NOT ORT_SHA256 MATCHES "^[0-9a-fA-F]+$")
+  string(TOUPPER ${ORT_ARCH} ORT_ARCH_UPPER)
+  message(FATAL_ERROR "No SHA256 for ${ORT_ARCHIVE}, set ONNXRUNTIME_SHA256_${ORT_ARCH_UPPER} "
+                      "to the sha256sum of the release asset")
+endif()
+
+message(STATUS "Fetching ONNX Runtime ${ORT_VERSION} (${ORT_ARCH})...")
+
+FetchContent_Declare(
+  onnxruntime
+  URL https://github.com/microsoft/onnxruntime/releases/download/v${ORT_VERSION}/${ORT_ARCHIVE}
+  URL_HASH SHA256=${ORT_SHA256}
+)
+
+FetchContent_MakeAvailable(onnxruntime)
+
+add_library(onnxruntime::onnxruntime SHARED IMPORTED)
+set_target_properties(onnxruntime::onnxruntime PROPERTIES
+  IMPORTED_LOCATION ${onnxruntime_SOURCE_DIR}/lib/libonnxruntime.so
+  INTERFACE_INCLUDE_DIRECTORIES ${onnxruntime_SOURCE_DIR}/include
+)
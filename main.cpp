@@ -1,18 +1,62 @@
 #include "testBench/testBench.h"
 #include <spdlog/spdlog.h>
 
+static int printUsage(const char* program)
+{
+  spdlog::error("Usage: {} --config <path/to/config.xml> [--compare <baseline.json>] "
+                "[--serve <socket> | --client <socket> | --produce <shm> | --consume <shm>]",
+                program);
+  return -1;
+}
+
 int main(int argc, char *argv[])
 {
-  if (argc == 3 && std::string(argv[1]) == "--config")
-  {
-    const std::string configPath {argv[2]};
-    TestBenchFactory tbfactory;
-    tbfactory.start(configPath);
-  }
-  else
+  // options come in pairs: --option value
+  if (argc % 2 == 0)
+    return printUsage(argv[0]);
+
+  std::string configPath;
+  std::string baselinePath;
+  std::string servePath;
+  std::string clientPath;
+  std::string producePath;
+  std::string consumePath;
+  for (int i {1}; i < argc; i += 2)
   {
-    spdlog::error("Usage: {} --config <path/to/config.xml>", argv[0]);
-    return -1;
+    const std::string option {argv[i]};
+    if (option == "--config")
+      configPath = argv[i + 1];
+    else if (option == "--compare")
+      baselinePath = argv[i + 1];
+    else if (option == "--serve")
+      servePath = argv[i + 1];
+    else if (option == "--client")
+      clientPath = argv[i + 1];
+    else if (option == "--produce")
+      producePath = argv[i + 1];
+    else if (option == "--consume")
+      consumePath = argv[i + 1];
+    else
+      return printUsage(argv[0]);
   }
-  return 0;
+
+  const int modes {!servePath.empty() + !clientPath.empty() + !producePath.empty() + 
+                   !consumePath.empty()};
+  if (configPath.empty() || modes > 1)
+    return printUsage(argv[0]);
+
+  // long-running server, shared-memory frame ring ends or their load generators instead 
+  // of a benchmark run
+  TestBenchFactory tbfactory;
+  if (!servePath.empty())
+    return tbfactory.serve(configPath, servePath) ? 0 : 1;
+  if (!clientPath.empty())
+    return tbfactory.runClient(configPath, clientPath) ? 0 : 1;
+  if (!producePath.empty())
+    return tbfactory.produce(configPath, producePath) ? 0 : 1;
+  if (!consumePath.empty())
+    return tbfactory.consume(configPath, consumePath) ? 0 : 1;
+
+  // a failed run or a significant regression against the baseline exits nonzero
+  return tbfactory.start(configPath, baselinePath) ? 0 : 1;
 }
@@ -0,0 +1,48 @@
+#include "dataset.h"
+
+#include <opencv2/imgcodecs.hpp>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+
+bool Dataset::load(const std::string& path, Dataset& dataset)
+{
+  std::error_code error;
+  std::vector<std::filesystem::path> files;
+  for (const auto& entry : std::filesystem::directory_iterator(path, error))
+  {
+    if (!entry.is_regular_file())
+      continue;
+    std::string extension {entry.path().extension().string()};
+    std::transform(extension.begin(), extension.end(), extension.begin(), 
+                   [](unsigned char c) { return std::tolower(c); });
+    if (extension == ".jpg" || extension == ".jpeg" || extension == ".png" || extension == ".bmp")
+      files.push_back(entry.path());
+  }
+  if (error)
+  {
+    spdlog::error("Dataset::load: could not read directory {}: {}", path, 
+                  error.message());
+    return false;
+  }
+
+  // file name order, so runs and annotations line up across machines
+  std::sort(files.begin(), files.end());
+  dataset.m_frames.clear();
+  dataset.m_names.clear();
+  dataset.m_frames.reserve(files.size());
+  for (const std::filesystem::path& file : files)
+  {
+    cv::Mat frame {cv::imread(file.string(), cv::IMREAD_COLOR)};
+    if (frame.empty())
+    {
+      spdlog::warn("Dataset::load: could not decode {}, skipping", file.string());
+      continue;
+    }
+    dataset.m_frames.push_back(std::move(frame));
+    dataset.m_names.push_back(file.filename().string());
+  }
+  spdlog::info("Dataset::load: {} frames from {}", dataset.m_frames.size(), path);
+  return !dataset.m_frames.empty();
+}
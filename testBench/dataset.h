@@ -0,0 +1,22 @@
+#pragma once
+
+#include <opencv2/core/mat.hpp>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Dataset holds the decoded benchmark frames, decoded once and shared by every run
+ */
+struct Dataset
+{
+  std::vector<cv::Mat> m_frames;          /// \var decoded frames, in file name order
+  std::vector<std::string> m_names;       /// \var file name of every frame
+
+  /**
+   * @brief decodes every image (.jpg, .jpeg, .png, .bmp) of a directory
+   * @param path path to the dataset directory
+   * @param dataset output dataset
+   * @return true if at least one frame was decoded, false otherwise
+   */
+  static bool load(const std::string& path, Dataset& dataset);
+};
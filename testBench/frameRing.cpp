@@ -0,0 +1,413 @@
+#include "frameRing.h"
+
+#include <spdlog/spdlog.h>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+{
+
+constexpr char kRingMagic[8] {'E', 'I', 'F', 'R', 'I', 'N', 'G', '\0'};
+constexpr std::uint32_t kRingVersion {1};
+constexpr std::uint32_t kWriting {0x80000000u};  // slot state: producer owns the slot
+constexpr std::size_t kPageBytes {4096};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free &&
+              sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t),
+              "the ring atomics have to be address free to be shared between processes");
+
+/**
+ * @brief RingHeader starts the segment. The producer sets m_version last, a consumer only
+ * maps a ring whose version is set.
+ */
+struct alignas(64) RingHeader
+{
+  char m_magic[8] {};
+  std::atomic<std::uint32_t> m_version {0};
+  std::uint32_t m_width {0};
+  std::uint32_t m_height {0};
+  std::uint32_t m_step {0};                       // bytes per frame row
+  std::uint32_t m_slots {0};
+  std::uint32_t m_resultSlots {0};
+  std::uint64_t m_slotBytes {0};                  // page aligned
+  std::uint64_t m_pixelsOffset {0};
+  std::uint64_t m_totalBytes {0};
+  alignas(64) std::atomic<std::uint64_t> m_latest {0}; // (sequence << 16) | slot, 0 = none
+  std::atomic<std::uint32_t> m_frameFutex {0};    // bumped by every publish
+  std::atomic<std::uint32_t> m_frameWaiters {0};
+  std::atomic<std::uint32_t> m_consumers {0};
+  alignas(64) std::atomic<std::uint64_t> m_resultHead {0};
+  alignas(64) std::atomic<std::uint64_t> m_resultTail {0};
+  std::atomic<std::uint32_t> m_resultFutex {0};   // bumped by every pushed result
+  std::atomic<std::uint32_t> m_resultWaiters {0};
+  std::atomic<std::uint64_t> m_droppedResults {0};
+};
+
+/**
+ * @brief SlotHeader describes one frame slot. The state is kWriting while the producer owns
+ * the slot, the number of consumers pinning it otherwise. Sequence and timestamp are only
+ * written while the producer owns the slot and only read while it is pinned.
+ */
+struct alignas(64) SlotHeader
+{
+  std::atomic<std::uint32_t> m_state {0};
+  std::uint64_t m_sequence {0};
+  std::int64_t m_captureNs {0};
+};
+
+/**
+ * @brief ResultCell is a cell of the bounded results queue, its turn tells whether it is
+ * free (turn == position) or holds the result of that position (turn == position + 1)
+ */
+struct alignas(64) ResultCell
+{
+  std::atomic<std::uint64_t> m_turn {0};
+  FrameResult m_result;
+};
+
+std::size_t alignUp(std::size_t bytes, std::size_t alignment)
+{
+  return (bytes + alignment - 1) / alignment * alignment;
+}
+
+RingHeader& ringHeader(std::uint8_t* data)
+{
+  return *reinterpret_cast<RingHeader*>(data);
+}
+
+SlotHeader* slotHeaders(std::uint8_t* data)
+{
+  return reinterpret_cast<SlotHeader*>(data + sizeof(RingHeader));
+}
+
+ResultCell* resultCells(std::uint8_t* data)
+{
+  return reinterpret_cast<ResultCell*>(
+    data + sizeof(RingHeader) + ringHeader(data).m_slots * sizeof(SlotHeader));
+}
+
+std::uint8_t* slotPixels(std::uint8_t* data, std::uint32_t slot)
+{
+  const RingHeader& ring {ringHeader(data)};
+  return data + ring.m_pixelsOffset + slot * ring.m_slotBytes;
+}
+
+// the futexes are shared between processes, so not FUTEX_PRIVATE
+void futexWait(std::atomic<std::uint32_t>& word, std::uint32_t expected,
+               std::chrono::nanoseconds timeout)
+{
+  const timespec relative {static_cast<time_t>(timeout.count() / 1000000000),
+                           static_cast<long>(timeout.count() % 1000000000)};
+  syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT, expected,
+          &relative, nullptr, 0);
+}
+
+void notify(std::atomic<std::uint32_t>& word, std::atomic<std::uint32_t>& waiters)
+{
+  word.fetch_add(1);
+  if (waiters.load() > 0)
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr,
+            nullptr, 0);
+}
+
+/**
+ * @brief retries an operation until it succeeds or the timeout passes, sleeping on the
+ * futex word in between. The word is read before every attempt, so a notification after a
+ * failed attempt makes the wait return right away.
+ */
+template <typename Attempt>
+bool waitUntil(std::atomic<std::uint32_t>& word, std::atomic<std::uint32_t>& waiters,
+               int timeoutMs, Attempt attempt)
+{
+  const std::chrono::steady_clock::time_point deadline {
+    std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs)};
+  while (true)
+  {
+    const std::uint32_t observed {word.load()};
+    if (attempt())
+      return true;
+
+    const std::chrono::steady_clock::time_point now {std::chrono::steady_clock::now()};
+    if (now >= deadline)
+      return false;
+    waiters.fetch_add(1);
+    futexWait(word, observed, deadline - now);
+    waiters.fetch_sub(1);
+  }
+}
+
+}  // namespace
+
+FrameRing::~FrameRing()
+{
+  if (m_data != nullptr)
+    munmap(m_data, m_size);
+  if (m_owner)
+    shm_unlink(m_name.c_str());
+}
+
+bool FrameRing::map(int fd, std::size_t size)
+{
+  // populated up front, the first frames do not pay for page faults
+  void* data {mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0)};
+  close(fd);
+  if (data == MAP_FAILED)
+  {
+    spdlog::error("FrameRing::map: could not map {}: {}", m_name, std::strerror(errno));
+    return false;
+  }
+  m_data = static_cast<std::uint8_t*>(data);
+  m_size = size;
+  return true;
+}
+
+bool FrameRing::create(const std::string& name, const FrameRingConfig& config)
+{
+  if (m_data != nullptr || name.size() < 2 || name.front() != '/')
+  {
+    spdlog::error("FrameRing::create: invalid shm name '{}', expected '/name'", name);
+    return false;
+  }
+  m_name = name;
+
+  const std::size_t step {static_cast<std::size_t>(config.m_width) * 3};
+  const std::size_t slotBytes {alignUp(step * config.m_height, kPageBytes)};
+  const std::size_t pixelsOffset {alignUp(sizeof(RingHeader) +
+    config.m_slots * sizeof(SlotHeader) + config.m_resultSlots * sizeof(ResultCell),
+    kPageBytes)};
+  const std::size_t totalBytes {pixelsOffset + config.m_slots * slotBytes};
+
+  // a segment left behind by a killed producer is replaced
+  shm_unlink(name.c_str());
+  const int fd {shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600)};
+  if (fd < 0 || ftruncate(fd, static_cast<off_t>(totalBytes)) != 0)
+  {
+    spdlog::error("FrameRing::create: could not create {} ({} bytes): {}", name, totalBytes,
+                  std::strerror(errno));
+    if (fd >= 0)
+    {
+      close(fd);
+      shm_unlink(name.c_str());
+    }
+    return false;
+  }
+  m_owner = true;
+  if (!map(fd, totalBytes))
+    return false;
+
+  RingHeader& ring {*new (m_data) RingHeader{}};
+  std::memcpy(ring.m_magic, kRingMagic, sizeof(kRingMagic));
+  ring.m_width = static_cast<std::uint32_t>(config.m_width);
+  ring.m_height = static_cast<std::uint32_t>(config.m_height);
+  ring.m_step = static_cast<std::uint32_t>(step);
+  ring.m_slots = static_cast<std::uint32_t>(config.m_slots);
+  ring.m_resultSlots = static_cast<std::uint32_t>(config.m_resultSlots);
+  ring.m_slotBytes = slotBytes;
+  ring.m_pixelsOffset = pixelsOffset;
+  ring.m_totalBytes = totalBytes;
+  for (std::uint32_t i {0}; i < ring.m_slots; ++i)
+    new (slotHeaders(m_data) + i) SlotHeader{};
+  for (std::uint32_t i {0}; i < ring.m_resultSlots; ++i)
+  {
+    ResultCell* cell {new (resultCells(m_data) + i) ResultCell{}};
+    cell->m_turn.store(i, std::memory_order_relaxed);
+  }
+  m_writeSlot = ring.m_slots - 1;
+  ring.m_version.store(kRingVersion, std::memory_order_release);
+
+  spdlog::info("FrameRing::create: {} slots of {}x{} bgr in {} ({:.1f} MiB)", ring.m_slots,
+               ring.m_width, ring.m_height, name, totalBytes / (1024.0 * 1024.0));
+  return true;
+}
+
+bool FrameRing::open(const std::string& name)
+{
+  m_name = name;
+  const int fd {shm_open(name.c_str(), O_RDWR, 0)};
+  struct stat info {};
+  if (fd < 0 || fstat(fd, &info) != 0 ||
+      static_cast<std::size_t>(info.st_size) < sizeof(RingHeader))
+  {
+    spdlog::error("FrameRing::open: no frame ring {}, is the producer running?", name);
+    if (fd >= 0)
+      close(fd);
+    return false;
+  }
+  if (!map(fd, static_cast<std::size_t>(info.st_size)))
+    return false;
+
+  RingHeader& ring {ringHeader(m_data)};
+  if (ring.m_version.load(std::memory_order_acquire) != kRingVersion ||
+      std::memcmp(ring.m_magic, kRingMagic, sizeof(kRingMagic)) != 0 ||
+      ring.m_totalBytes != m_size)
+  {
+    spdlog::error("FrameRing::open: {} is not a version {} frame ring", name, kRingVersion);
+    return false;
+  }
+  m_consumer = ring.m_consumers.fetch_add(1);
+  spdlog::info("FrameRing::open: consumer {} of {}, {} slots of {}x{}", m_consumer, name,
+               ring.m_slots, ring.m_width, ring.m_height);
+  return true;
+}
+
+cv::Mat FrameRing::beginWrite()
+{
+  // oldest first, the slot of the newest frame is the last choice
+  const RingHeader& ring {ringHeader(m_data)};
+  for (std::uint32_t i {1}; i <= ring.m_slots; ++i)
+  {
+    const std::uint32_t slot {(m_writeSlot + i) % ring.m_slots};
+    std::uint32_t idle {0};
+    if (slotHeaders(m_data)[slot].m_state.compare_exchange_strong(idle, kWriting,
+                                                                   std::memory_order_acquire))
+    {
+      m_writeSlot = slot;
+      return cv::Mat(static_cast<int>(ring.m_height), static_cast<int>(ring.m_width), CV_8UC3,
+                     slotPixels(m_data, slot), ring.m_step);
+    }
+  }
+  return cv::Mat();
+}
+
+void FrameRing::publish(std::int64_t captureNs)
+{
+  RingHeader& ring {ringHeader(m_data)};
+  SlotHeader& slot {slotHeaders(m_data)[m_writeSlot]};
+  const std::uint64_t sequence {(ring.m_latest.load(std::memory_order_relaxed) >> 16) + 1};
+  slot.m_sequence = sequence;
+  slot.m_captureNs = captureNs;
+  slot.m_state.store(0, std::memory_order_release);
+  ring.m_latest.store(sequence << 16 | m_writeSlot, std::memory_order_release);
+  notify(ring.m_frameFutex, ring.m_frameWaiters);
+}
+
+bool FrameRing::acquire(FrameLease& lease, int timeoutMs)
+{
+  RingHeader& ring {ringHeader(m_data)};
+  return waitUntil(ring.m_frameFutex, ring.m_frameWaiters, timeoutMs, [&] {
+    const std::uint64_t latest {ring.m_latest.load(std::memory_order_acquire)};
+    const std::uint64_t sequence {latest >> 16};
+    if (sequence <= m_lastSequence)
+      return false;
+
+    // pin unless the producer is rewriting the slot, its publish wakes us up again
+    const std::uint32_t slotIdx {static_cast<std::uint32_t>(latest & 0xffff)};
+    SlotHeader& slot {slotHeaders(m_data)[slotIdx]};
+    std::uint32_t state {slot.m_state.load(std::memory_order_relaxed)};
+    do
+    {
+      if (state & kWriting)
+        return false;
+    } while (!slot.m_state.compare_exchange_weak(state, state + 1, std::memory_order_acquire,
+                                                 std::memory_order_relaxed));
+    if (slot.m_sequence != sequence)
+    {
+      // rewritten with a newer frame in between, which already bumped the futex word
+      slot.m_state.fetch_sub(1, std::memory_order_release);
+      return false;
+    }
+
+    if (m_lastSequence > 0)
+      m_skipped += sequence - m_lastSequence - 1;
+    m_lastSequence = sequence;
+    lease.m_sequence = sequence;
+    lease.m_captureNs = slot.m_captureNs;
+    lease.m_slot = slotIdx;
+    lease.m_frame = cv::Mat(static_cast<int>(ring.m_height), static_cast<int>(ring.m_width),
+                            CV_8UC3, slotPixels(m_data, slotIdx), ring.m_step);
+    return true;
+  });
+}
+
+void FrameRing::release(FrameLease& lease)
+{
+  lease.m_frame.release();
+  slotHeaders(m_data)[lease.m_slot].m_state.fetch_sub(1, std::memory_order_release);
+}
+
+bool FrameRing::pushResult(FrameResult& result)
+{
+  RingHeader& ring {ringHeader(m_data)};
+  ResultCell* cells {resultCells(m_data)};
+  result.m_consumer = m_consumer;
+  result.m_resultNs = nowNs();
+
+  std::uint64_t position {ring.m_resultHead.load(std::memory_order_relaxed)};
+  while (true)
+  {
+    ResultCell& cell {cells[position % ring.m_resultSlots]};
+    const std::uint64_t turn {cell.m_turn.load(std::memory_order_acquire)};
+    if (turn == position)
+    {
+      if (ring.m_resultHead.compare_exchange_weak(position, position + 1,
+                                                  std::memory_order_relaxed))
+      {
+        cell.m_result = result;
+        cell.m_turn.store(position + 1, std::memory_order_release);
+        notify(ring.m_resultFutex, ring.m_resultWaiters);
+        return true;
+      }
+    }
+    else if (turn < position)
+    {
+      // the producer is not draining the results, drop rather than stall the inference
+      ring.m_droppedResults.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    else
+    {
+      position = ring.m_resultHead.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+bool FrameRing::popResult(FrameResult& result, int timeoutMs)
+{
+  RingHeader& ring {ringHeader(m_data)};
+  ResultCell* cells {resultCells(m_data)};
+  return waitUntil(ring.m_resultFutex, ring.m_resultWaiters, timeoutMs, [&] {
+    std::uint64_t position {ring.m_resultTail.load(std::memory_order_relaxed)};
+    while (true)
+    {
+      ResultCell& cell {cells[position % ring.m_resultSlots]};
+      const std::uint64_t turn {cell.m_turn.load(std::memory_order_acquire)};
+      if (turn == position + 1)
+      {
+        if (ring.m_resultTail.compare_exchange_weak(position, position + 1,
+                                                    std::memory_order_relaxed))
+        {
+          result = cell.m_result;
+          cell.m_turn.store(position + ring.m_resultSlots, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (turn < position + 1)
+      {
+        return false;
+      }
+      else
+      {
+        position = ring.m_resultTail.load(std::memory_order_relaxed);
+      }
+    }
+  });
+}
+
+std::uint64_t FrameRing::droppedResults() const
+{
+  return ringHeader(m_data).m_droppedResults.load(std::memory_order_relaxed);
+}
+
+std::int64_t FrameRing::nowNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
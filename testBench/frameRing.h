@@ -0,0 +1,146 @@
+#pragma once
+
+#include "../utils/config/config.h"
+#include "server.h"
+
+#include <opencv2/core/mat.hpp>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief FrameResult is the detection result of one ring frame, sent back to the producer
+ */
+struct FrameResult
+{
+  static constexpr std::size_t kMaxDetections {100}; /// \var detections kept per frame
+
+  std::uint64_t m_sequence {0};           /// \var sequence number of the frame
+  std::int64_t m_captureNs {0};           /// \var capture timestamp of the frame
+  std::int64_t m_resultNs {0};            /// \var time the result was pushed
+  std::uint32_t m_consumer {0};           /// \var consumer that produced the result
+  std::uint16_t m_count {0};              /// \var valid entries of m_detections
+  std::uint16_t m_reserved {0};           /// \var padding, 0
+  ServeDetection m_detections[kMaxDetections]; /// \var detections, in the server encoding
+};
+
+/**
+ * @brief FrameLease is a frame pinned in its ring slot, read in place until released
+ */
+struct FrameLease
+{
+  cv::Mat m_frame;                        /// \var header over the shared slot, not a copy
+  std::uint64_t m_sequence {0};           /// \var sequence number, starts at 1
+  std::int64_t m_captureNs {0};           /// \var capture timestamp (steady clock ns)
+  std::uint32_t m_slot {0};               /// \var pinned slot
+};
+
+/**
+ * @brief FrameRing is a POSIX shared-memory ring handing frames from one capture process to
+ * any number of inference processes without a copy, plus a bounded ring carrying the
+ * results back. The producer never blocks on slow consumers: it writes the oldest slot no
+ * consumer has pinned, and consumers always take the newest frame, skipping the ones they
+ * were too slow for. A pinned slot is never overwritten, so a frame read in place can not
+ * tear. New frames and results wake the waiting processes through futexes in the segment.
+ * Timestamps are steady clock nanoseconds (CLOCK_MONOTONIC), comparable across processes.
+ */
+class FrameRing
+{
+  std::uint8_t* m_data {nullptr};         /// \var mapped segment
+  std::size_t m_size {0};                 /// \var mapped bytes
+  std::string m_name;                     /// \var shm object name
+  bool m_owner {false};                   /// \var created the segment, unlinks it
+  std::uint32_t m_consumer {0};           /// \var consumer index of this mapping
+  std::uint32_t m_writeSlot {0};          /// \var producer: slot being written
+  std::uint64_t m_lastSequence {0};       /// \var consumer: newest frame acquired
+  std::uint64_t m_skipped {0};            /// \var consumer: frames published but never taken
+
+  /**
+   * @brief maps the shm object and keeps the mapping
+   * @param fd shm object
+   * @param size bytes to map
+   * @return true if successful, false otherwise
+   */
+  bool map(int fd, std::size_t size);
+
+public:
+  FrameRing() = default;
+  FrameRing(const FrameRing&) = delete;
+  FrameRing& operator=(const FrameRing&) = delete;
+  ~FrameRing();
+
+  /**
+   * @brief creates the ring (producer side), replacing a stale segment of the same name
+   * @param name shm object name, e.g. "/edge_frames"
+   * @param config frame geometry and ring sizes
+   * @return true if successful, false otherwise
+   */
+  bool create(const std::string& name, const FrameRingConfig& config);
+
+  /**
+   * @brief maps a ring created by a producer (consumer side)
+   * @param name shm object name
+   * @return true if successful, false otherwise
+   */
+  bool open(const std::string& name);
+
+  /**
+   * @brief producer: claims the oldest slot no consumer has pinned
+   * @return 8 bit bgr header over the slot, empty if every slot is pinned
+   */
+  cv::Mat beginWrite();
+
+  /**
+   * @brief producer: publishes the slot of the last beginWrite and wakes the consumers
+   * @param captureNs capture timestamp
+   */
+  void publish(std::int64_t captureNs);
+
+  /**
+   * @brief consumer: pins the newest frame newer than the last one acquired
+   * @param lease output lease
+   * @param timeoutMs how long to wait for a new frame
+   * @return true if a frame was pinned, false on timeout
+   */
+  bool acquire(FrameLease& lease, int timeoutMs);
+
+  /**
+   * @brief consumer: unpins a frame, its slot may be overwritten afterwards
+   * @param lease lease of acquire
+   */
+  void release(FrameLease& lease);
+
+  /**
+   * @brief consumer: queues a result for the producer
+   * @param result result, m_consumer is set to this mapping
+   * @return true if queued, false if the results ring is full (the result is dropped)
+   */
+  bool pushResult(FrameResult& result);
+
+  /**
+   * @brief producer: takes the oldest queued result
+   * @param result output result
+   * @param timeoutMs how long to wait for a result
+   * @return true if a result was taken, false on timeout
+   */
+  bool popResult(FrameResult& result, int timeoutMs);
+
+  /**
+   * @brief returns the frames this consumer skipped because newer ones were published
+   */
+  std::uint64_t skippedFrames() const { return m_skipped; }
+
+  /**
+   * @brief returns the results dropped on a full results ring, by every consumer
+   */
+  std::uint64_t droppedResults() const;
+
+  /**
+   * @brief returns the consumer index of this mapping
+   */
+  std::uint32_t consumer() const { return m_consumer; }
+
+  /**
+   * @brief returns the current steady clock time in nanoseconds
+   */
+  static std::int64_t nowNs();
+};
@@ -0,0 +1,83 @@
+#include "hotSwap.h"
+
+#include <spdlog/spdlog.h>
+#include <chrono>
+
+namespace
+{
+
+std::int64_t nowNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace
+
+HotSwapEngine::HotSwapEngine(std::shared_ptr<AbsEngine> engine)
+  : m_current(std::move(engine))
+{
+}
+
+HotSwapEngine::~HotSwapEngine()
+{
+  wait();
+}
+
+bool HotSwapEngine::reload(Builder builder)
+{
+  if (m_reloading.exchange(true))
+  {
+    spdlog::warn("HotSwapEngine::reload: the previous reload is still running, ignored");
+    return false;
+  }
+  if (m_loader.joinable())
+    m_loader.join();
+  m_loader = std::thread(&HotSwapEngine::load, this, std::move(builder), nowNs());
+  return true;
+}
+
+void HotSwapEngine::load(Builder builder, std::int64_t requestNs)
+{
+  ReloadEvent event;
+  event.m_requestNs = requestNs;
+  std::shared_ptr<AbsEngine> engine {builder()};
+  const std::int64_t builtNs {nowNs()};
+  event.m_buildMs = static_cast<double>(builtNs - requestNs) / 1e6;
+  if (engine == nullptr)
+    spdlog::error("HotSwapEngine::load: could not build the new engine, the old one keeps "
+                  "serving");
+  else
+  {
+    std::shared_ptr<AbsEngine> previous {m_current.exchange(std::move(engine))};
+    event.m_swapNs = nowNs();
+    ++m_version;
+
+    // grace period: new frames can no longer take the old engine, wait for the ones that
+    // hold it and free it here instead of on the serving thread that drops it last
+    while (previous.use_count() > 1)
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    previous.reset();
+    event.m_freedNs = nowNs();
+    event.m_succeeded = true;
+    spdlog::info("HotSwapEngine::load: engine {} serving, built in {:.1f} ms, old engine "
+                 "freed {:.2f} ms after the swap", m_version.load(), event.m_buildMs,
+                 static_cast<double>(event.m_freedNs - event.m_swapNs) / 1e6);
+  }
+
+  std::lock_guard<std::mutex> lock {m_eventsMtx};
+  m_events.push_back(event);
+  m_reloading = false;
+}
+
+void HotSwapEngine::wait()
+{
+  if (m_loader.joinable())
+    m_loader.join();
+}
+
+std::vector<ReloadEvent> HotSwapEngine::events() const
+{
+  std::lock_guard<std::mutex> lock {m_eventsMtx};
+  return m_events;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "../engine/base.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief ReloadEvent holds the timeline of one reload, steady clock nanoseconds
+ */
+struct ReloadEvent
+{
+  std::int64_t m_requestNs {0};           /// \var reload() was called
+  std::int64_t m_swapNs {0};              /// \var new engine published, 0 if the build failed
+  std::int64_t m_freedNs {0};             /// \var last frame on the old engine done, old freed
+  double m_buildMs {0.0};                 /// \var load, delegates and warm-up of the new engine
+  bool m_succeeded {false};               /// \var the new engine is serving
+};
+
+/**
+ * @brief HotSwapEngine is the slot serving threads take their engine from, so a new model
+ * version can replace the running one without a restart. The new engine is built and warmed
+ * up on a loader thread while the old one keeps serving, then published with an atomic
+ * pointer swap: frames started before the swap finish on the old engine, frames started
+ * after it run on the new one. Like RCU, the old engine is freed by the loader thread once
+ * the last frame holding it is done, never on a serving thread. reload() and wait() are
+ * called from one control thread, acquire() from any number of serving threads.
+ */
+class HotSwapEngine
+{
+public:
+  /// \brief builds, initializes and warms up an engine, returns nullptr on failure. The
+  /// returned pointer owns whatever the engine refers to (e.g. its configuration).
+  using Builder = std::function<std::shared_ptr<AbsEngine>()>;
+
+private:
+  std::atomic<std::shared_ptr<AbsEngine>> m_current; /// \var engine of new frames
+  std::atomic<std::uint64_t> m_version {0};  /// \var successful swaps
+  std::atomic<bool> m_reloading {false};  /// \var a loader thread is running
+  std::thread m_loader;                   /// \var builds the new engine, frees the old one
+  mutable std::mutex m_eventsMtx;         /// \var guards m_events
+  std::vector<ReloadEvent> m_events;      /// \var timeline of every reload
+
+  void load(Builder builder, std::int64_t requestNs);
+
+public:
+  /**
+   * @param engine initialized engine serving until the first reload, the slot has to hold
+   * its only reference (the old engine is freed once nothing else refers to it)
+   */
+  explicit HotSwapEngine(std::shared_ptr<AbsEngine> engine);
+  HotSwapEngine(const HotSwapEngine&) = delete;
+  HotSwapEngine& operator=(const HotSwapEngine&) = delete;
+  ~HotSwapEngine();
+
+  /**
+   * @brief returns the current engine, keep it for the whole frame (run and read outputs)
+   */
+  std::shared_ptr<AbsEngine> acquire() const { return m_current.load(); }
+
+  /**
+   * @brief builds a new engine in the background and swaps it in once it is warm
+   * @param builder builds the new engine on the loader thread
+   * @return true if the reload started, false if the previous one is still running
+   */
+  bool reload(Builder builder);
+
+  /**
+   * @brief waits until the running reload swapped the engine and freed the old one
+   */
+  void wait();
+
+  /**
+   * @brief returns the number of successful swaps
+   */
+  std::uint64_t version() const { return m_version; }
+
+  /**
+   * @brief returns the timeline of every reload, a running one is not included
+   */
+  std::vector<ReloadEvent> events() const;
+};
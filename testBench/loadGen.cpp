@@ -0,0 +1,147 @@
+#include "loadGen.h"
+#include "../utils/stats/stats.h"
+
+#include <spdlog/spdlog.h>
+#include <spdlog/fmt/fmt.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+
+namespace
+{
+
+using SteadyClock = std::chrono::steady_clock;
+
+/**
+ * @brief upper estimate of the requests of one load level, poisson arrivals vary around
+ * rate * duration
+ */
+std::size_t levelCapacity(double rate, double durationSec)
+{
+  return static_cast<std::size_t>(rate * durationSec * 1.2) + 1;
+}
+
+/**
+ * @brief arrival offsets (seconds since level start) of one load level
+ */
+std::vector<double> buildSchedule(ArrivalProcess arrival, double rate, double durationSec,
+                                  std::mt19937& generator)
+{
+  std::vector<double> schedule;
+  schedule.reserve(levelCapacity(rate, durationSec));
+
+  std::exponential_distribution<double> interArrival {rate};
+  double time {0.0};
+  while (true)
+  {
+    time += arrival == ArrivalProcess::POISSON ? interArrival(generator) : 1.0 / rate;
+    if (time >= durationSec)
+      break;
+    schedule.push_back(time);
+  }
+  return schedule;
+}
+
+}  // namespace
+
+bool LoadGenerator::sweep(const LoadSweepConfig& config, const std::vector<cv::Mat>& dataset,
+                          const std::function<void(std::size_t, const cv::Mat&)>& process,
+                          std::vector<LoadPoint>& curve)
+{
+  if (dataset.empty())
+  {
+    spdlog::error("LoadGenerator::sweep: empty dataset!");
+    return false;
+  }
+
+  std::mt19937 generator {42};
+  curve.clear();
+  for (float rate : config.m_rates)
+  {
+    const std::vector<double> schedule {
+      buildSchedule(config.m_arrival, rate, config.m_durationSec, generator)};
+    std::vector<double> latencies(schedule.size(), 0.0);
+    std::atomic<std::size_t> next {0};
+
+    // workers claim requests in arrival order and wait for the arrival time if they are
+    // early; a late claim means the request queued, which counts towards its latency
+    const SteadyClock::time_point start {SteadyClock::now() + std::chrono::milliseconds(10)};
+    auto worker = [&](std::size_t instance) {
+      for (std::size_t i {next++}; i < schedule.size(); i = next++)
+      {
+        const SteadyClock::time_point arrival {start +
+          std::chrono::duration_cast<SteadyClock::duration>(
+            std::chrono::duration<double>(schedule[i]))};
+        std::this_thread::sleep_until(arrival);
+        process(instance, dataset[i % dataset.size()]);
+        latencies[i] = std::chrono::duration<double, std::milli>(
+          SteadyClock::now() - arrival).count();
+      }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(config.m_instances);
+    for (int instance {0}; instance < config.m_instances; ++instance)
+      workers.emplace_back(worker, static_cast<std::size_t>(instance));
+    for (std::thread& thread : workers)
+      thread.join();
+    const double elapsedSec {std::chrono::duration<double>(SteadyClock::now() - start).count()};
+
+    LoadPoint point;
+    point.m_offeredRps = rate;
+    point.m_requests = schedule.size();
+    point.m_achievedRps = elapsedSec > 0.0 ? schedule.size() / elapsedSec : 0.0;
+    const Summary summary {Stats::summarize(latencies)};
+    point.m_p50Ms = summary.m_p50;
+    point.m_p99Ms = summary.m_p99;
+    curve.push_back(point);
+
+    spdlog::info("LoadGenerator::sweep: offered {:.1f} rps, achieved {:.1f} rps, "
+                 "p50 {:.2f} ms, p99 {:.2f} ms", point.m_offeredRps, point.m_achievedRps,
+                 point.m_p50Ms, point.m_p99Ms);
+  }
+  return true;
+}
+
+std::size_t LoadGenerator::expectedRequests(const LoadSweepConfig& config)
+{
+  std::size_t requests {0};
+  for (float rate : config.m_rates)
+    requests += levelCapacity(rate, config.m_durationSec);
+  return requests;
+}
+
+int LoadGenerator::findKnee(const std::vector<LoadPoint>& curve, double kneeFactor)
+{
+  if (curve.empty())
+    return -1;
+
+  const double baseP99 {curve.front().m_p99Ms};
+  int knee {-1};
+  for (std::size_t i {0}; i < curve.size(); ++i)
+  {
+    const bool sustained {curve[i].m_achievedRps >= 0.95 * curve[i].m_offeredRps};
+    if (!sustained || curve[i].m_p99Ms > kneeFactor * baseP99)
+      break;
+    knee = static_cast<int>(i);
+  }
+  return knee;
+}
+
+void LoadGenerator::printCurve(const std::vector<LoadPoint>& curve, int knee)
+{
+  std::cout << "--- Open-Loop Load Sweep ---\n";
+  std::cout << fmt::format("{:>12} {:>12} {:>10} {:>10}\n", "offered rps", "achieved rps",
+                           "p50 ms", "p99 ms");
+  for (std::size_t i {0}; i < curve.size(); ++i)
+  {
+    const LoadPoint& point {curve[i]};
+    std::cout << fmt::format("{:>12.1f} {:>12.1f} {:>10.2f} {:>10.2f}{}\n",
+                             point.m_offeredRps, point.m_achievedRps, point.m_p50Ms,
+                             point.m_p99Ms, static_cast<int>(i) == knee ? "  <- knee" : "");
+  }
+  if (knee < 0)
+    std::cout << "No sustainable load level, even the lowest rate saturates the engines\n";
+}
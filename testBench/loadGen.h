@@ -0,0 +1,52 @@
+#pragma once
+
+#include "../utils/config/config.h"
+#include "../utils/report/report.h"
+
+#include <opencv2/core/mat.hpp>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief LoadGenerator drives engine instances with an open-loop arrival process: request
+ * arrival times are fixed up front and never wait for completions, so the measured
+ * latency includes the queueing a closed loop hides
+ */
+struct LoadGenerator
+{
+  /**
+   * @brief runs one load level per configured rate
+   * @param config load sweep configuration
+   * @param dataset dataset frames, cycled
+   * @param process processes one frame on the given engine instance
+   * @param curve output throughput/latency curve, one point per rate
+   * @return true if successful, false otherwise
+   */
+  static bool sweep(const LoadSweepConfig& config, const std::vector<cv::Mat>& dataset,
+                    const std::function<void(std::size_t, const cv::Mat&)>& process,
+                    std::vector<LoadPoint>& curve);
+
+  /**
+   * @brief upper estimate of the requests of a whole sweep, sized for poisson arrivals, used
+   * to reserve the sample buffers before measuring
+   * @param config load sweep configuration
+   * @return expected number of requests over every load level
+   */
+  static std::size_t expectedRequests(const LoadSweepConfig& config);
+
+  /**
+   * @brief finds the knee of the curve: the highest offered load that is still served
+   * (95% of it achieved) with a p99 below kneeFactor times the p99 at the lowest load
+   * @param curve throughput/latency curve ordered by offered load
+   * @param kneeFactor allowed p99 growth
+   * @return index of the knee point, -1 if even the lowest load is not sustained
+   */
+  static int findKnee(const std::vector<LoadPoint>& curve, double kneeFactor);
+
+  /**
+   * @brief prints the throughput/latency table
+   * @param curve throughput/latency curve
+   * @param knee index of the knee point
+   */
+  static void printCurve(const std::vector<LoadPoint>& curve, int knee);
+};
@@ -0,0 +1,146 @@
+#include "realtime.h"
+#include "../utils/profiler/profiler.h"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <random>
+#include <thread>
+
+FrameQueue::FrameQueue(std::size_t capacity)
+  : m_ring(std::max<std::size_t>(capacity, 1))
+{}
+
+bool FrameQueue::push(const PacedFrame& frame, DropPolicy policy, std::size_t& depth)
+{
+  std::unique_lock<std::mutex> lock {m_mtx};
+  bool dropped {false};
+  if (m_size == m_ring.size())
+  {
+    switch (policy)
+    {
+      case DropPolicy::DROP_NEWEST:
+        depth = m_size;
+        return true;
+      case DropPolicy::BLOCK:
+        m_notFull.wait(lock, [this] { return m_size < m_ring.size(); });
+        break;
+      case DropPolicy::DROP_OLDEST:
+      default:
+        m_head = (m_head + 1) % m_ring.size();
+        --m_size;
+        dropped = true;
+        break;
+    }
+  }
+
+  m_ring[(m_head + m_size) % m_ring.size()] = frame;
+  ++m_size;
+  depth = m_size;
+  lock.unlock();
+  m_notEmpty.notify_one();
+  return dropped;
+}
+
+bool FrameQueue::pop(PacedFrame& frame, std::size_t& depth)
+{
+  std::unique_lock<std::mutex> lock {m_mtx};
+  m_notEmpty.wait(lock, [this] { return m_size > 0 || m_closed; });
+  if (m_size == 0)
+    return false;
+
+  frame = m_ring[m_head];
+  m_head = (m_head + 1) % m_ring.size();
+  --m_size;
+  depth = m_size;
+  lock.unlock();
+  m_notFull.notify_one();
+  return true;
+}
+
+void FrameQueue::close()
+{
+  {
+    std::lock_guard<std::mutex> lock {m_mtx};
+    m_closed = true;
+  }
+  m_notEmpty.notify_all();
+}
+
+bool PacedRunner::run(const RealtimeConfig& config, const std::vector<cv::Mat>& dataset,
+                      const std::function<void(const cv::Mat&)>& process,
+                      RealtimeResults& results)
+{
+  if (dataset.empty())
+  {
+    spdlog::error("PacedRunner::run: empty dataset!");
+    return false;
+  }
+
+  const std::size_t numFrames {config.m_frames > 0 ? static_cast<std::size_t>(config.m_frames) :
+                                                     dataset.size()};
+  const std::chrono::duration<double, std::milli> period {1000.0 / config.m_fps};
+  const double deadlineMs {config.m_deadlineMs > 0.0f ? config.m_deadlineMs : period.count()};
+
+  results = RealtimeResults{};
+  results.m_enabled = true;
+  results.m_deadlineMs = deadlineMs;
+  // one depth sample per push and per pop, reserved so the timeline never reallocates
+  results.m_queueDepth.reserve(2 * numFrames);
+  std::mutex timelineMtx;
+
+  FrameQueue queue {static_cast<std::size_t>(config.m_queueSize)};
+  const SteadyClock::time_point start {SteadyClock::now()};
+  auto recordDepth = [&](std::size_t depth) {
+    const double timeMs {std::chrono::duration<double, std::milli>(
+      SteadyClock::now() - start).count()};
+    std::lock_guard<std::mutex> lock {timelineMtx};
+    results.m_queueDepth.emplace_back(timeMs, static_cast<std::uint32_t>(depth));
+    results.m_maxQueueDepth = std::max(results.m_maxQueueDepth, depth);
+  };
+
+  // the camera keeps its own clock, a blocked push delays only the frames after it
+  std::thread camera([&] {
+    std::mt19937 generator {42};
+    std::uniform_real_distribution<double> jitter {-config.m_jitterMs, config.m_jitterMs};
+    std::uint64_t dropped {0};
+    for (std::size_t i {0}; i < numFrames; ++i)
+    {
+      const auto offset {period * static_cast<double>(i) +
+                         std::chrono::duration<double, std::milli>(jitter(generator))};
+      std::this_thread::sleep_until(
+        start + std::chrono::duration_cast<SteadyClock::duration>(offset));
+
+      const PacedFrame frame {&dataset[i % dataset.size()], SteadyClock::now(), i};
+      std::size_t depth {0};
+      if (queue.push(frame, config.m_dropPolicy, depth))
+        ++dropped;
+      recordDepth(depth);
+    }
+    results.m_emitted = numFrames;
+    results.m_dropped = dropped;
+    queue.close();
+  });
+
+  PacedFrame frame;
+  std::size_t depth {0};
+  while (queue.pop(frame, depth))
+  {
+    recordDepth(depth);
+    process(*frame.m_frame);
+
+    const auto latency {std::chrono::duration_cast<std::chrono::microseconds>(
+      SteadyClock::now() - frame.m_captureTime)};
+    Storage::addData("PacedRunner::endToEnd", latency.count());
+    if (latency.count() / 1000.0 > deadlineMs)
+      ++results.m_deadlineMisses;
+    ++results.m_processed;
+  }
+  camera.join();
+
+  spdlog::info("PacedRunner::run: {} fps, {} emitted, {} processed, {} dropped ({}), "
+               "{} deadline misses (> {:.2f} ms), max queue depth {}", config.m_fps,
+               results.m_emitted, results.m_processed, results.m_dropped,
+               dropPolicyToString(config.m_dropPolicy), results.m_deadlineMisses,
+               deadlineMs, results.m_maxQueueDepth);
+  return true;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "../utils/config/config.h"
+#include "../utils/report/report.h"
+
+#include <opencv2/core/mat.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+using SteadyClock = std::chrono::steady_clock;
+
+/**
+ * @brief PacedFrame is a frame emitted by the simulated camera
+ */
+struct PacedFrame
+{
+  const cv::Mat* m_frame {nullptr};       /// \var dataset frame, not copied
+  SteadyClock::time_point m_captureTime;  /// \var capture timestamp
+  std::uint64_t m_sequence {0};           /// \var frame sequence number
+};
+
+/**
+ * @brief FrameQueue is a bounded queue between camera and engine on a preallocated ring,
+ * a full queue is resolved by the configured drop policy
+ */
+class FrameQueue
+{
+  std::vector<PacedFrame> m_ring;         /// \var ring storage
+  std::size_t m_head {0};                 /// \var index of the oldest frame
+  std::size_t m_size {0};                 /// \var number of queued frames
+  bool m_closed {false};                  /// \var no more frames will be pushed
+  std::mutex m_mtx;
+  std::condition_variable m_notEmpty;
+  std::condition_variable m_notFull;
+
+public:
+  /**
+   * @param capacity maximum number of queued frames
+   */
+  explicit FrameQueue(std::size_t capacity);
+
+  /**
+   * @brief pushes a frame, applying the drop policy if the queue is full
+   * @param frame frame to push
+   * @param policy drop policy
+   * @param depth queue depth after the push
+   * @return true if a frame (oldest or this one) was dropped, false otherwise
+   */
+  bool push(const PacedFrame& frame, DropPolicy policy, std::size_t& depth);
+
+  /**
+   * @brief pops the oldest frame, blocks until a frame is available or the queue is closed
+   * @param frame output frame
+   * @param depth queue depth after the pop
+   * @return true if a frame was popped, false if the queue is closed and empty
+   */
+  bool pop(PacedFrame& frame, std::size_t& depth);
+
+  /**
+   * @brief closes the queue and wakes up the consumer
+   */
+  void close();
+};
+
+/**
+ * @brief PacedRunner emits dataset frames on a fixed clock from a camera thread and
+ * processes them on the calling thread, like a live camera feeding the engine
+ */
+struct PacedRunner
+{
+  /**
+   * @brief runs the paced benchmark. The capture-to-result latency of every processed frame
+   * is recorded in the profiler under "PacedRunner::endToEnd".
+   * @param config realtime configuration
+   * @param dataset dataset frames, cycled if more frames are requested
+   * @param process processes one frame
+   * @param results output deadline, drop and queue depth accounting
+   * @return true if successful, false otherwise
+   */
+  static bool run(const RealtimeConfig& config, const std::vector<cv::Mat>& dataset,
+                  const std::function<void(const cv::Mat&)>& process,
+                  RealtimeResults& results);
+};
@@ -0,0 +1,269 @@
+#include "scheduler.h"
+#include "../utils/stats/stats.h"
+
+#include <spdlog/spdlog.h>
+#include <spdlog/fmt/fmt.h>
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <limits>
+
+namespace
+{
+
+double elapsedMs(std::chrono::steady_clock::time_point from,
+                 std::chrono::steady_clock::time_point to)
+{
+  return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+}  // namespace
+
+ModelScheduler::ModelScheduler(SchedulingPolicy policy, std::size_t numWorkers)
+  : m_policy {policy},
+    m_numWorkers {numWorkers > 0 ? numWorkers :
+                  std::max<std::size_t>(1, std::thread::hardware_concurrency())}
+{
+}
+
+ModelScheduler::~ModelScheduler()
+{
+  if (!m_workers.empty())
+    stop();
+}
+
+bool ModelScheduler::addModel(const SchedulerModelConfig& config,
+                              std::vector<std::unique_ptr<AbsEngine>> engines, Invoke invoke,
+                              std::vector<cv::Mat> frames)
+{
+  if (!m_workers.empty() || engines.empty() || frames.empty() || !invoke)
+  {
+    spdlog::error("ModelScheduler::addModel: model {} needs engines, frames and an invoke, "
+                  "before start()", config.m_name);
+    return false;
+  }
+
+  auto model {std::make_unique<Model>()};
+  model->m_config = config;
+  model->m_config.m_cores = static_cast<int>(engines.size());
+  model->m_invoke = std::move(invoke);
+  model->m_frames = std::move(frames);
+  model->m_costMs = std::numeric_limits<double>::max();
+  for (std::unique_ptr<AbsEngine>& engine : engines)
+  {
+    // the first invoke pays for lazy allocations, keep it out of the accounting
+    const auto begin {SteadyClock::now()};
+    if (!model->m_invoke(engine.get(), model->m_frames.front()))
+    {
+      spdlog::error("ModelScheduler::addModel: warm-up of model {} failed", config.m_name);
+      return false;
+    }
+    model->m_costMs = std::min(model->m_costMs, elapsedMs(begin, SteadyClock::now()));
+    model->m_idle.push_back(engine.get());
+  }
+  model->m_engines = std::move(engines);
+  m_models.push_back(std::move(model));
+  return true;
+}
+
+void ModelScheduler::start()
+{
+  m_closed = false;
+  m_virtualTime = 0.0;
+  m_started = SteadyClock::now();
+  for (std::size_t i {0}; i < m_numWorkers; ++i)
+    m_workers.emplace_back(&ModelScheduler::workLoop, this);
+}
+
+bool ModelScheduler::submit(std::size_t model, const cv::Mat& frame)
+{
+  const SteadyClock::time_point arrival {SteadyClock::now()};
+  std::lock_guard<std::mutex> lock {m_mtx};
+  if (m_closed || model >= m_models.size())
+    return false;
+
+  Model& target {*m_models[model]};
+  const SchedulerModelConfig& config {target.m_config};
+  const double deadlineMs {config.m_deadlineMs > 0.0f ? config.m_deadlineMs :
+                                                         1000.0 / config.m_fps};
+  Request request {frame, arrival,
+    arrival + std::chrono::duration_cast<SteadyClock::duration>(
+      std::chrono::duration<double, std::milli>(deadlineMs))};
+
+  bool dropped {false};
+  if (target.m_queue.size() >= static_cast<std::size_t>(config.m_queueSize))
+  {
+    target.m_queue.pop_front();
+    ++target.m_metrics.m_dropped;
+    dropped = true;
+  }
+  target.m_queue.push_back(std::move(request));
+  ++target.m_metrics.m_submitted;
+  m_cv.notify_one();
+  return !dropped;
+}
+
+std::size_t ModelScheduler::pick() const
+{
+  std::size_t best {m_models.size()};
+  for (std::size_t i {0}; i < m_models.size(); ++i)
+  {
+    const Model& model {*m_models[i]};
+    if (model.m_queue.empty() || model.m_idle.empty())
+      continue;
+    if (best == m_models.size())
+    {
+      best = i;
+      continue;
+    }
+
+    // queues are in arrival order, their fronts have the earliest deadline
+    const Model& current {*m_models[best]};
+    const bool higherPriority {model.m_config.m_priority > current.m_config.m_priority};
+    if (m_policy == SchedulingPolicy::EDF)
+    {
+      const SteadyClock::time_point candidate {model.m_queue.front().m_deadline};
+      const SteadyClock::time_point chosen {current.m_queue.front().m_deadline};
+      if (candidate < chosen || (candidate == chosen && higherPriority))
+        best = i;
+    }
+    else
+    {
+      const double candidate {startTag(model)};
+      const double chosen {startTag(current)};
+      if (candidate < chosen || (candidate == chosen && higherPriority))
+        best = i;
+    }
+  }
+  return best;
+}
+
+double ModelScheduler::startTag(const Model& model) const
+{
+  // a request starts when the model's previous one finishes in virtual time, or now if
+  // the model was idle
+  return std::max(m_virtualTime, model.m_lastFinishTag);
+}
+
+void ModelScheduler::workLoop()
+{
+  auto drained = [this] {
+    return std::all_of(m_models.begin(), m_models.end(), [](const auto& model) {
+      return model->m_queue.empty(); });
+  };
+
+  std::unique_lock<std::mutex> lock {m_mtx};
+  while (true)
+  {
+    std::size_t next {m_models.size()};
+    m_cv.wait(lock, [&] {
+      next = pick();
+      return next < m_models.size() || (m_closed && drained());
+    });
+    if (next == m_models.size())
+    {
+      // the pool is drained, let the other waiting workers exit as well
+      m_cv.notify_all();
+      return;
+    }
+
+    Model& model {*m_models[next]};
+    Request request {std::move(model.m_queue.front())};
+    model.m_queue.pop_front();
+    AbsEngine* engine {model.m_idle.back()};
+    model.m_idle.pop_back();
+    // the request takes its cost scaled down by the priority
+    const double start {startTag(model)};
+    model.m_lastFinishTag = start + model.m_costMs / model.m_config.m_priority;
+    m_virtualTime = start;
+    lock.unlock();
+
+    const SteadyClock::time_point dispatched {SteadyClock::now()};
+    const bool success {model.m_invoke(engine, request.m_frame)};
+    const SteadyClock::time_point done {SteadyClock::now()};
+
+    lock.lock();
+    model.m_idle.push_back(engine);
+    ModelMetrics& metrics {model.m_metrics};
+    const double serviceMs {elapsedMs(dispatched, done)};
+    metrics.m_serviceMs += serviceMs;
+    if (success)
+    {
+      ++metrics.m_completed;
+      metrics.m_latencyMs.push_back(elapsedMs(request.m_arrival, done));
+      metrics.m_queueMs.push_back(elapsedMs(request.m_arrival, dispatched));
+      if (done > request.m_deadline)
+        ++metrics.m_deadlineMisses;
+      model.m_costMs = 0.8 * model.m_costMs + 0.2 * serviceMs;
+    }
+    else
+      ++metrics.m_failed;
+    m_cv.notify_one();
+  }
+}
+
+void ModelScheduler::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock {m_mtx};
+    m_closed = true;
+  }
+  m_cv.notify_all();
+  for (std::thread& worker : m_workers)
+    worker.join();
+  m_workers.clear();
+  m_wallMs = elapsedMs(m_started, SteadyClock::now());
+}
+
+void ModelScheduler::run(double durationSec)
+{
+  start();
+
+  // one paced camera per model, a late camera catches up with a burst like a real one
+  std::atomic<bool> stopping {false};
+  std::vector<std::thread> cameras;
+  for (std::size_t i {0}; i < m_models.size(); ++i)
+  {
+    cameras.emplace_back([this, i, &stopping] {
+      const Model& model {*m_models[i]};
+      const auto period {std::chrono::duration_cast<SteadyClock::duration>(
+        std::chrono::duration<double>(1.0 / model.m_config.m_fps))};
+      SteadyClock::time_point next {SteadyClock::now()};
+      for (std::size_t frame {0}; !stopping; ++frame)
+      {
+        next += period;
+        std::this_thread::sleep_until(next);
+        submit(i, model.m_frames[frame % model.m_frames.size()]);
+      }
+    });
+  }
+
+  std::this_thread::sleep_for(std::chrono::duration<double>(durationSec));
+  stopping = true;
+  for (std::thread& camera : cameras)
+    camera.join();
+  stop();
+}
+
+void ModelScheduler::printSummary()
+{
+  std::cout << fmt::format("--- Multi-Model Scheduler ({}, {} workers, {:.1f} s) ---\n",
+                           schedulingPolicyToString(m_policy), m_numWorkers, m_wallMs / 1000.0);
+  std::cout << fmt::format("{:<16} {:>6} {:>5} {:>8} {:>8} {:>7} {:>7} {:>8} {:>9} {:>9} "
+                           "{:>9} {:>7}\n", "model", "prio", "cores", "done", "dropped",
+                           "failed", "missed", "fps", "p50 ms", "p99 ms", "queue ms", "share");
+  for (const std::unique_ptr<Model>& model : m_models)
+  {
+    ModelMetrics& metrics {model->m_metrics};
+    const Summary latency {Stats::summarize(metrics.m_latencyMs)};
+    const Summary queue {Stats::summarize(metrics.m_queueMs)};
+    const double wallSec {std::max(m_wallMs, 1e-3) / 1000.0};
+    const double share {metrics.m_serviceMs / (std::max(m_wallMs, 1e-3) * m_numWorkers)};
+    std::cout << fmt::format("{:<16} {:>6.2f} {:>5} {:>8} {:>8} {:>7} {:>7} {:>8.1f} {:>9.2f} "
+                             "{:>9.2f} {:>9.2f} {:>6.1f}%\n", model->m_config.m_name,
+                             model->m_config.m_priority, model->m_config.m_cores,
+                             metrics.m_completed, metrics.m_dropped, metrics.m_failed,
+                             metrics.m_deadlineMisses, metrics.m_completed / wallSec,
+                             latency.m_p50, latency.m_p99, queue.m_p50, share * 100.0);
+  }
+}
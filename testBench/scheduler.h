@@ -0,0 +1,160 @@
+#pragma once
+
+#include "../engine/base.h"
+#include "../utils/config/config.h"
+
+#include <opencv2/core/mat.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief ModelMetrics holds the accounting of one model of a scheduler run
+ */
+struct ModelMetrics
+{
+  std::size_t m_submitted {0};            /// \var requests submitted
+  std::size_t m_dropped {0};              /// \var requests replaced by newer ones on a full queue
+  std::size_t m_completed {0};            /// \var requests run successfully
+  std::size_t m_failed {0};               /// \var requests whose invoke failed
+  std::size_t m_deadlineMisses {0};       /// \var completed after their deadline
+  std::vector<double> m_latencyMs;        /// \var submit to result of completed requests
+  std::vector<double> m_queueMs;          /// \var submit to dispatch of completed requests
+  double m_serviceMs {0.0};               /// \var worker time spent in the model's invokes
+};
+
+/**
+ * @brief ModelScheduler hosts several engines in one process and runs their invocations on
+ * one shared worker pool. Every model gets a core budget, the number of engine instances it
+ * owns: a model holds at most that many workers at a time, so a slow model can not starve
+ * the others of cores. Among the models with a free instance the next request is picked by
+ * weighted fair queuing (start-time fair queuing over the estimated invoke cost, a model
+ * with twice the priority gets twice the worker time under contention) or by the earliest
+ * deadline, priority breaking ties.
+ */
+class ModelScheduler
+{
+public:
+  /// \brief runs one frame on an engine instance of the model, returns false on failure
+  using Invoke = std::function<bool(AbsEngine* engine, const cv::Mat& frame)>;
+
+private:
+  using SteadyClock = std::chrono::steady_clock;
+
+  /**
+   * @brief Request is a frame waiting for a worker
+   */
+  struct Request
+  {
+    cv::Mat m_frame;                      /// \var frame to run
+    SteadyClock::time_point m_arrival;    /// \var submit time
+    SteadyClock::time_point m_deadline;   /// \var result expected by (edf)
+  };
+
+  /**
+   * @brief Model is a hosted model, its engine instances and its pending requests
+   */
+  struct Model
+  {
+    SchedulerModelConfig m_config;        /// \var budget, rate and deadline
+    std::vector<std::unique_ptr<AbsEngine>> m_engines; /// \var instances, one per core
+    std::vector<AbsEngine*> m_idle;       /// \var instances no worker is running
+    Invoke m_invoke;                      /// \var runs a frame on an instance
+    std::vector<cv::Mat> m_frames;        /// \var frames submitted by run()
+    std::deque<Request> m_queue;          /// \var pending requests, oldest first
+    double m_costMs {0.0};                /// \var estimated invoke time (wfq)
+    double m_lastFinishTag {0.0};         /// \var virtual finish time of the last dispatch
+    ModelMetrics m_metrics;               /// \var accounting
+  };
+
+  SchedulingPolicy m_policy {SchedulingPolicy::WFQ}; /// \var picks the next request
+  std::size_t m_numWorkers {1};           /// \var threads of the shared pool
+  std::vector<std::unique_ptr<Model>> m_models; /// \var hosted models
+  std::vector<std::thread> m_workers;     /// \var shared pool
+  std::mutex m_mtx;                       /// \var guards the models' queues and metrics
+  std::condition_variable m_cv;           /// \var signals requests, idle instances and stop
+  bool m_closed {false};                  /// \var stop() was called, drain and exit
+  double m_virtualTime {0.0};             /// \var start tag of the last dispatched request
+  SteadyClock::time_point m_started;      /// \var start() time
+  double m_wallMs {0.0};                  /// \var start() to the end of stop()
+
+  /**
+   * @brief returns the model whose request runs next, or m_models.size() if no model has
+   * both a pending request and an idle instance. Called with m_mtx held.
+   */
+  std::size_t pick() const;
+
+  /**
+   * @brief returns the virtual start time the head of the model's queue gets if it is
+   * dispatched now. Tags are only taken at dispatch, so dropped requests cost no share.
+   */
+  double startTag(const Model& model) const;
+
+  void workLoop();
+
+public:
+  /**
+   * @param policy picks the next request among the eligible models
+   * @param numWorkers threads of the shared pool, 0 = hardware threads
+   */
+  ModelScheduler(SchedulingPolicy policy, std::size_t numWorkers);
+  ~ModelScheduler();
+
+  /**
+   * @brief hosts a model, before start(). Every instance is warmed up with the first frame,
+   * the fastest warm-up invoke seeds the cost estimate.
+   * @param config budget, rate and deadline of the model, m_cores is the number of engines
+   * @param engines initialized engine instances
+   * @param invoke runs a frame on an instance
+   * @param frames frames submitted by run(), at least one
+   * @return true if successful, false otherwise
+   */
+  bool addModel(const SchedulerModelConfig& config,
+                std::vector<std::unique_ptr<AbsEngine>> engines, Invoke invoke,
+                std::vector<cv::Mat> frames);
+
+  /**
+   * @brief starts the worker pool
+   */
+  void start();
+
+  /**
+   * @brief queues a frame of a model, replacing the model's oldest pending request if its
+   * queue is full
+   * @param model index in order of addModel
+   * @param frame frame, kept by reference until it ran
+   * @return true if queued without dropping a request, false otherwise
+   */
+  bool submit(std::size_t model, const cv::Mat& frame);
+
+  /**
+   * @brief runs the pending requests to completion and joins the worker pool
+   */
+  void stop();
+
+  /**
+   * @brief starts the pool, submits the frames of every model at its configured rate for
+   * the given duration, then stops
+   * @param durationSec duration of the run
+   */
+  void run(double durationSec);
+
+  /**
+   * @brief returns the accounting of a model, only valid after stop()
+   * @param model index in order of addModel
+   */
+  const ModelMetrics& metrics(std::size_t model) const { return m_models[model]->m_metrics; }
+
+  /**
+   * @brief prints one row of accounting per model, only valid after stop() (the latencies
+   * are sorted in place)
+   */
+  void printSummary();
+};
@@ -0,0 +1,491 @@
+#include "server.h"
+
+#include <opencv2/imgproc.hpp>
+#include <spdlog/spdlog.h>
+#include <spdlog/fmt/fmt.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static_assert(sizeof(ServeRequestHeader) == 16 && sizeof(ServeResponseHeader) == 16 &&
+              sizeof(ServeDetection) == 12, "the wire structs must not be padded");
+
+namespace
+{
+
+using SteadyClock = std::chrono::steady_clock;
+
+constexpr std::size_t kLengthBytes {sizeof(std::uint32_t)};
+
+double elapsedMs(SteadyClock::time_point from, SteadyClock::time_point to)
+{
+  return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+std::int16_t clampCoordinate(int value)
+{
+  return static_cast<std::int16_t>(std::clamp(value, -32768, 32767));
+}
+
+bool socketAddress(const std::string& path, sockaddr_un& address)
+{
+  address = {};
+  address.sun_family = AF_UNIX;
+  if (path.empty() || path.size() >= sizeof(address.sun_path))
+  {
+    spdlog::error("ServeProtocol: invalid socket path '{}', at most {} characters", path,
+                  sizeof(address.sun_path) - 1);
+    return false;
+  }
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+  return true;
+}
+
+void printLatency(const char* name, std::vector<double>& samples)
+{
+  const Summary summary {Stats::summarize(samples)};
+  std::cout << fmt::format("{:<12} {:>10.3f} {:>10.3f} {:>10.3f} {:>10.3f}\n", name,
+                           summary.m_mean, summary.m_p50, summary.m_p99, summary.m_max);
+}
+
+}  // namespace
+
+std::size_t ServeProtocol::encodeDetections(const DetectedObjects& detections,
+                                            ServeDetection* out, std::size_t capacity)
+{
+  const std::size_t count {std::min(detections.m_classNameIdxs.size(), capacity)};
+  for (std::size_t i {0}; i < count; ++i)
+  {
+    out[i].m_x1 = clampCoordinate(detections.m_firstPoints[i].x);
+    out[i].m_y1 = clampCoordinate(detections.m_firstPoints[i].y);
+    out[i].m_x2 = clampCoordinate(detections.m_secondPoints[i].x);
+    out[i].m_y2 = clampCoordinate(detections.m_secondPoints[i].y);
+    out[i].m_classIdx = static_cast<std::uint16_t>(detections.m_classNameIdxs[i]);
+    out[i].m_score = static_cast<std::uint16_t>(std::lround(
+      std::clamp(detections.m_classProbabilities[i], 0.0f, 1.0f) * 65535.0f));
+  }
+  return count;
+}
+
+void ServeProtocol::encodeResponse(std::uint32_t id, ServeStatus status, std::uint32_t serverUs,
+                                   const DetectedObjects& detections,
+                                   std::vector<std::uint8_t>& message)
+{
+  const std::size_t count {status == ServeStatus::OK ?
+    std::min<std::size_t>(detections.m_classNameIdxs.size(), UINT16_MAX) : 0};
+
+  ServeResponseHeader header;
+  header.m_length = static_cast<std::uint32_t>(
+    sizeof(header) - kLengthBytes + count * sizeof(ServeDetection));
+  header.m_id = id;
+  header.m_status = status;
+  header.m_count = static_cast<std::uint16_t>(count);
+  header.m_serverUs = serverUs;
+
+  message.resize(sizeof(header) + count * sizeof(ServeDetection));
+  std::memcpy(message.data(), &header, sizeof(header));
+  encodeDetections(detections, reinterpret_cast<ServeDetection*>(message.data() + sizeof(header)),
+                   count);
+}
+
+bool ServeProtocol::validRequest(const ServeRequestHeader& header)
+{
+  if (header.m_width == 0 || header.m_height == 0 ||
+      (header.m_channels != 1 && header.m_channels != 3))
+    return false;
+
+  const std::size_t pixelBytes {
+    std::size_t{header.m_width} * header.m_height * header.m_channels};
+  return pixelBytes <= kMaxFrameBytes &&
+         header.m_length == sizeof(header) - kLengthBytes + pixelBytes;
+}
+
+bool ServeProtocol::readAll(int fd, void* data, std::size_t bytes)
+{
+  auto* out {static_cast<std::uint8_t*>(data)};
+  while (bytes > 0)
+  {
+    const ssize_t received {recv(fd, out, bytes, 0)};
+    if (received < 0 && errno == EINTR)
+      continue;
+    if (received <= 0)
+      return false;
+    out += received;
+    bytes -= static_cast<std::size_t>(received);
+  }
+  return true;
+}
+
+bool ServeProtocol::writeAll(int fd, const void* data, std::size_t bytes)
+{
+  // a peer that went away fails the send instead of raising SIGPIPE
+  const auto* in {static_cast<const std::uint8_t*>(data)};
+  while (bytes > 0)
+  {
+    const ssize_t sent {send(fd, in, bytes, MSG_NOSIGNAL)};
+    if (sent < 0 && errno == EINTR)
+      continue;
+    if (sent <= 0)
+      return false;
+    in += sent;
+    bytes -= static_cast<std::size_t>(sent);
+  }
+  return true;
+}
+
+InferenceServer::Connection::~Connection()
+{
+  if (m_fd >= 0)
+    close(m_fd);
+}
+
+InferenceServer::InferenceServer(AbsEngine* engine, const ServeConfig& config)
+  : InferenceServer(std::shared_ptr<AbsEngine>(engine, [](AbsEngine*) {}), config)
+{
+}
+
+InferenceServer::InferenceServer(std::shared_ptr<AbsEngine> engine, const ServeConfig& config,
+                                 std::shared_ptr<AbsEngine> singleEngine)
+  : m_engine(std::move(engine)), m_config(config)
+{
+  if (singleEngine != nullptr)
+    m_singleEngine = std::make_unique<HotSwapEngine>(std::move(singleEngine));
+}
+
+InferenceServer::~InferenceServer()
+{
+  stop();
+}
+
+bool InferenceServer::start(const std::string& socketPath)
+{
+  sockaddr_un address;
+  if (!socketAddress(socketPath, address))
+    return false;
+
+  m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (m_listenFd < 0)
+  {
+    spdlog::error("InferenceServer::start: socket failed: {}", std::strerror(errno));
+    return false;
+  }
+
+  // a socket file left behind by a killed server would fail the bind
+  unlink(socketPath.c_str());
+  if (bind(m_listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0 ||
+      listen(m_listenFd, SOMAXCONN) < 0)
+  {
+    spdlog::error("InferenceServer::start: could not listen on {}: {}", socketPath,
+                  std::strerror(errno));
+    close(m_listenFd);
+    m_listenFd = -1;
+    return false;
+  }
+  m_socketPath = socketPath;
+
+  m_metrics = ServeMetrics{};
+  m_stopping = false;
+  m_queueClosed = false;
+  m_batcher = std::thread(&InferenceServer::batchLoop, this);
+  m_acceptor = std::thread(&InferenceServer::acceptLoop, this);
+  spdlog::info("InferenceServer::start: serving on {}, max batch {}, max delay {} us",
+               socketPath, m_config.m_maxBatch, m_config.m_maxDelayUs);
+  return true;
+}
+
+void InferenceServer::stop()
+{
+  if (m_listenFd < 0 || m_stopping.exchange(true))
+    return;
+
+  // shutting a socket down wakes up the thread blocked on it
+  shutdown(m_listenFd, SHUT_RDWR);
+  m_acceptor.join();
+  {
+    std::lock_guard<std::mutex> lock(m_connectionsMtx);
+    for (const std::shared_ptr<Connection>& connection : m_connections)
+      shutdown(connection->m_fd, SHUT_RDWR);
+    for (const std::shared_ptr<Connection>& connection : m_connections)
+      connection->m_reader.join();
+    m_connections.clear();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_queueMtx);
+    m_queueClosed = true;
+  }
+  m_queueCv.notify_one();
+  m_batcher.join();
+
+  close(m_listenFd);
+  m_listenFd = -1;
+  unlink(m_socketPath.c_str());
+}
+
+void InferenceServer::acceptLoop()
+{
+  while (!m_stopping)
+  {
+    const int fd {accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC)};
+    if (fd < 0)
+    {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      if (!m_stopping)
+        spdlog::error("InferenceServer::acceptLoop: accept failed: {}", std::strerror(errno));
+      return;
+    }
+
+    auto connection {std::make_shared<Connection>()};
+    connection->m_fd = fd;
+    std::lock_guard<std::mutex> lock(m_connectionsMtx);
+    if (m_stopping)
+      return;
+
+    // reap the readers of closed connections, queued requests keep their connection alive
+    std::erase_if(m_connections, [](const std::shared_ptr<Connection>& closed) {
+      if (!closed->m_done)
+        return false;
+      closed->m_reader.join();
+      return true;
+    });
+    connection->m_reader = std::thread(&InferenceServer::readLoop, this, connection);
+    m_connections.push_back(std::move(connection));
+  }
+}
+
+void InferenceServer::readLoop(std::shared_ptr<Connection> connection)
+{
+  const DetectedObjects noDetections;
+  std::vector<std::uint8_t> rejection;
+  ServeRequestHeader header;
+  while (ServeProtocol::readAll(connection->m_fd, &header, sizeof(header)))
+  {
+    if (!ServeProtocol::validRequest(header))
+    {
+      // the stream can not be resynchronized, the client sees the connection close
+      spdlog::error("InferenceServer::readLoop: invalid request {} ({}x{}x{}, {} bytes), "
+                    "closing the connection", header.m_id, header.m_width, header.m_height,
+                    header.m_channels, header.m_length);
+      shutdown(connection->m_fd, SHUT_RDWR);
+      break;
+    }
+
+    // the pixels are received straight into the frame the engine will read
+    Request request;
+    request.m_connection = connection;
+    request.m_id = header.m_id;
+    request.m_frame.create(header.m_height, header.m_width, CV_8UC(header.m_channels));
+    if (!ServeProtocol::readAll(connection->m_fd, request.m_frame.data,
+                                request.m_frame.total() * request.m_frame.elemSize()))
+      break;
+    // every engine preprocesses bgr frames, a gray one would not fill its input
+    if (request.m_frame.channels() == 1)
+      cv::cvtColor(request.m_frame, request.m_frame, cv::COLOR_GRAY2BGR);
+    request.m_arrival = SteadyClock::now();
+
+    bool queued {false};
+    {
+      std::lock_guard<std::mutex> lock(m_queueMtx);
+      if (m_queue.size() < static_cast<std::size_t>(m_config.m_queueSize))
+      {
+        m_queue.push_back(std::move(request));
+        queued = true;
+      }
+      else
+      {
+        ++m_metrics.m_overloaded;
+      }
+    }
+    if (queued)
+    {
+      m_queueCv.notify_one();
+      continue;
+    }
+
+    // reject right away, the client decides whether to retry
+    ServeProtocol::encodeResponse(header.m_id, ServeStatus::OVERLOADED, 0, noDetections,
+                                  rejection);
+    respond(*connection, rejection);
+  }
+  connection->m_done = true;
+}
+
+void InferenceServer::batchLoop()
+{
+  const std::size_t maxBatch {static_cast<std::size_t>(m_config.m_maxBatch)};
+  const std::chrono::microseconds maxDelay {m_config.m_maxDelayUs};
+  std::vector<Request> batch;
+  std::vector<cv::Mat> frames;
+  std::vector<std::uint8_t> message;
+  batch.reserve(maxBatch);
+  frames.reserve(maxBatch);
+
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(m_queueMtx);
+      m_queueCv.wait(lock, [this] { return m_queueClosed || !m_queue.empty(); });
+      if (m_queueClosed)
+        break;
+
+      // the oldest request bounds the wait, a full batch starts right away
+      const SteadyClock::time_point deadline {m_queue.front().m_arrival + maxDelay};
+      m_queueCv.wait_until(lock, deadline, [this, maxBatch] {
+        return m_queueClosed || m_queue.size() >= maxBatch;
+      });
+      if (m_queueClosed)
+        break;
+
+      const std::size_t size {std::min(maxBatch, m_queue.size())};
+      for (std::size_t i {0}; i < size; ++i)
+      {
+        batch.push_back(std::move(m_queue.front()));
+        m_queue.pop_front();
+      }
+    }
+    runBatch(batch, frames, message);
+    batch.clear();
+  }
+
+  // requests still queued at shutdown are dropped with their connections
+  std::lock_guard<std::mutex> lock(m_queueMtx);
+  m_queue.clear();
+}
+
+void InferenceServer::runBatch(std::vector<Request>& batch, std::vector<cv::Mat>& frames,
+                               std::vector<std::uint8_t>& message)
+{
+  frames.clear();
+  for (const Request& request : batch)
+    frames.push_back(request.m_frame);
+
+  // a lone request runs on the batch size 1 engine if there is one, a batched invoke would
+  // cost the full batch. The batch keeps its engine alive across a reload until its
+  // detections are encoded.
+  const bool single {batch.size() == 1 && m_singleEngine != nullptr};
+  const bool batched {m_config.m_maxBatch > 1 && !single};
+  const std::shared_ptr<AbsEngine> engine {single ? m_singleEngine->acquire() :
+                                                    m_engine.acquire()};
+  const SteadyClock::time_point start {SteadyClock::now()};
+  const bool succeeded {batched ? engine->runObjectDetectionBatch(frames) :
+                                  engine->runObjectDetection(frames.front())};
+  const SteadyClock::time_point end {SteadyClock::now()};
+  if (!succeeded)
+  {
+    spdlog::error("InferenceServer::runBatch: inference of {} requests failed", batch.size());
+    m_metrics.m_failed += batch.size();
+  }
+
+  const DetectedObjects noDetections;
+  m_metrics.m_batchSizes.push_back(static_cast<double>(batch.size()));
+  for (std::size_t i {0}; i < batch.size(); ++i)
+  {
+    const Request& request {batch[i]};
+    const DetectedObjects& detections {!succeeded ? noDetections :
+      batched ? engine->getBatchDetections()[i] : engine->getDetections()};
+    const std::uint32_t serverUs {static_cast<std::uint32_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+        SteadyClock::now() - request.m_arrival).count())};
+    ServeProtocol::encodeResponse(request.m_id,
+                                  succeeded ? ServeStatus::OK : ServeStatus::FAILED,
+                                  serverUs, detections, message);
+    respond(*request.m_connection, message);
+
+    m_metrics.m_queueMs.push_back(elapsedMs(request.m_arrival, start));
+    m_metrics.m_inferenceMs.push_back(elapsedMs(start, end));
+    m_metrics.m_endToEndMs.push_back(elapsedMs(request.m_arrival, SteadyClock::now()));
+  }
+}
+
+void InferenceServer::respond(Connection& connection, const std::vector<std::uint8_t>& message)
+{
+  std::lock_guard<std::mutex> lock(connection.m_writeMtx);
+  if (!ServeProtocol::writeAll(connection.m_fd, message.data(), message.size()))
+    spdlog::warn("InferenceServer::respond: client went away, response dropped");
+}
+
+void InferenceServer::printSummary()
+{
+  ServeMetrics& metrics {m_metrics};
+  const Summary batches {Stats::summarize(metrics.m_batchSizes)};
+  std::cout << "--- Inference Server ---\n";
+  std::cout << fmt::format("Requests: {} served, {} rejected (queue full), {} failed\n",
+                           metrics.m_endToEndMs.size(), metrics.m_overloaded,
+                           metrics.m_failed);
+  std::cout << fmt::format("Batches: {}, mean size {:.2f}, max size {:.0f}\n",
+                           batches.m_count, batches.m_mean, batches.m_max);
+  if (metrics.m_endToEndMs.empty())
+    return;
+
+  std::cout << fmt::format("{:<12} {:>10} {:>10} {:>10} {:>10}\n", "ms", "mean", "p50",
+                           "p99", "max");
+  printLatency("queue", metrics.m_queueMs);
+  printLatency("inference", metrics.m_inferenceMs);
+  printLatency("end-to-end", metrics.m_endToEndMs);
+}
+
+ServeClient::~ServeClient()
+{
+  if (m_fd >= 0)
+    close(m_fd);
+}
+
+bool ServeClient::connect(const std::string& socketPath)
+{
+  sockaddr_un address;
+  if (!socketAddress(socketPath, address))
+    return false;
+
+  m_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (m_fd < 0 ||
+      ::connect(m_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0)
+  {
+    spdlog::error("ServeClient::connect: could not connect to {}: {}", socketPath,
+                  std::strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+bool ServeClient::request(std::uint32_t id, const cv::Mat& frame, ServeResponseHeader& header,
+                          std::vector<ServeDetection>& detections)
+{
+  if (frame.depth() != CV_8U || !frame.isContinuous())
+  {
+    spdlog::error("ServeClient::request: frames have to be continuous 8 bit images");
+    return false;
+  }
+
+  ServeRequestHeader request;
+  request.m_id = id;
+  request.m_width = static_cast<std::uint16_t>(frame.cols);
+  request.m_height = static_cast<std::uint16_t>(frame.rows);
+  request.m_channels = static_cast<std::uint16_t>(frame.channels());
+  const std::size_t pixelBytes {frame.total() * frame.elemSize()};
+  request.m_length = static_cast<std::uint32_t>(sizeof(request) - kLengthBytes + pixelBytes);
+  if (!ServeProtocol::validRequest(request))
+  {
+    spdlog::error("ServeClient::request: unsupported frame {}x{}x{}", frame.cols, frame.rows,
+                  frame.channels());
+    return false;
+  }
+  if (!ServeProtocol::writeAll(m_fd, &request, sizeof(request)) ||
+      !ServeProtocol::writeAll(m_fd, frame.data, pixelBytes) ||
+      !ServeProtocol::readAll(m_fd, &header, sizeof(header)))
+    return false;
+
+  const std::size_t payload {header.m_length + kLengthBytes - sizeof(header)};
+  if (header.m_id != id || payload != header.m_count * sizeof(ServeDetection))
+  {
+    spdlog::error("ServeClient::request: malformed response to request {}", id);
+    return false;
+  }
+  detections.resize(header.m_count);
+  return ServeProtocol::readAll(m_fd, detections.data(), payload);
+}
@@ -0,0 +1,293 @@
+#pragma once
+
+#include "../engine/base.h"
+#include "../utils/config/config.h"
+#include "../utils/stats/stats.h"
+#include "hotSwap.h"
+
+#include <opencv2/core/mat.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Wire protocol of the inference server, a stream of length-prefixed messages over a Unix
+ * domain socket in host byte order (both ends are on the same device). A request is a
+ * ServeRequestHeader followed by the 8 bit pixels (rows x cols x channels, no padding), a
+ * response is a ServeResponseHeader followed by m_count ServeDetection entries. Every
+ * m_length counts the bytes that follow the length field itself.
+ */
+
+/**
+ * @brief ServeStatus is the outcome of a request
+ */
+enum class ServeStatus : std::uint16_t {OK, OVERLOADED, FAILED};
+
+/**
+ * @brief ServeRequestHeader precedes the pixels of a request
+ */
+struct ServeRequestHeader
+{
+  std::uint32_t m_length {0};             /// \var bytes after this field
+  std::uint32_t m_id {0};                 /// \var request id, echoed in the response
+  std::uint16_t m_width {0};              /// \var frame width
+  std::uint16_t m_height {0};             /// \var frame height
+  std::uint16_t m_channels {0};           /// \var 1 (gray) or 3 (bgr)
+  std::uint16_t m_reserved {0};           /// \var padding, 0
+};
+
+/**
+ * @brief ServeResponseHeader precedes the detections of a response
+ */
+struct ServeResponseHeader
+{
+  std::uint32_t m_length {0};             /// \var bytes after this field
+  std::uint32_t m_id {0};                 /// \var id of the answered request
+  ServeStatus m_status {ServeStatus::OK}; /// \var outcome of the request
+  std::uint16_t m_count {0};              /// \var detections that follow
+  std::uint32_t m_serverUs {0};           /// \var request received to response sent
+};
+
+/**
+ * @brief ServeDetection is one detection of a response, 12 bytes
+ */
+struct ServeDetection
+{
+  std::int16_t m_x1 {0};                  /// \var top-left x in frame pixels
+  std::int16_t m_y1 {0};                  /// \var top-left y in frame pixels
+  std::int16_t m_x2 {0};                  /// \var bottom-right x in frame pixels
+  std::int16_t m_y2 {0};                  /// \var bottom-right y in frame pixels
+  std::uint16_t m_classIdx {0};           /// \var class name index
+  std::uint16_t m_score {0};              /// \var confidence scaled to [0, 65535]
+};
+
+/**
+ * @brief ServeProtocol encodes and decodes the messages of the wire protocol
+ */
+struct ServeProtocol
+{
+  static constexpr std::size_t kMaxFrameBytes {64u << 20}; /// \var largest accepted frame
+
+  /**
+   * @brief encodes detections, coordinates are clamped to the int16 range
+   * @param detections detections of a frame
+   * @param out output entries
+   * @param capacity entries of out, further detections are cut
+   * @return number of encoded entries
+   */
+  static std::size_t encodeDetections(const DetectedObjects& detections, ServeDetection* out,
+                                      std::size_t capacity);
+
+  /**
+   * @brief encodes a response, see encodeDetections
+   * @param id request id
+   * @param status outcome of the request
+   * @param serverUs request received to response sent in microseconds
+   * @param detections detections of the frame, ignored unless status is OK
+   * @param message output message, reused
+   */
+  static void encodeResponse(std::uint32_t id, ServeStatus status, std::uint32_t serverUs,
+                             const DetectedObjects& detections,
+                             std::vector<std::uint8_t>& message);
+
+  /**
+   * @brief validates a request header against the frame it announces
+   * @param header received header
+   * @return true if the header describes a supported frame, false otherwise
+   */
+  static bool validRequest(const ServeRequestHeader& header);
+
+  /**
+   * @brief reads exactly the given number of bytes, retrying on EINTR
+   * @param fd socket
+   * @param data output buffer
+   * @param bytes bytes to read
+   * @return true if every byte was read, false on error or end of stream
+   */
+  static bool readAll(int fd, void* data, std::size_t bytes);
+
+  /**
+   * @brief writes exactly the given number of bytes, retrying on EINTR
+   * @param fd socket
+   * @param data input buffer
+   * @param bytes bytes to write
+   * @return true if every byte was written, false on error
+   */
+  static bool writeAll(int fd, const void* data, std::size_t bytes);
+};
+
+/**
+ * @brief ServeMetrics holds the per-request latencies of a serving run
+ */
+struct ServeMetrics
+{
+  std::vector<double> m_queueMs;          /// \var request received to batch start
+  std::vector<double> m_inferenceMs;      /// \var batch run time of the request
+  std::vector<double> m_endToEndMs;       /// \var request received to response sent
+  std::vector<double> m_batchSizes;       /// \var requests per batch
+  std::size_t m_overloaded {0};           /// \var requests rejected on a full queue
+  std::size_t m_failed {0};               /// \var requests whose batch failed
+};
+
+/**
+ * @brief InferenceServer serves object detection requests from other processes over a Unix
+ * domain socket. Every connection has a reader thread queueing its requests, one batcher
+ * thread owns the engine and runs the queue in batches of up to maxBatch requests, waiting
+ * at most maxDelayUs after the oldest request for a batch to fill. The engine is taken from
+ * a hot swap slot per batch, so a reloaded model serves from the next batch on.
+ */
+class InferenceServer
+{
+  /**
+   * @brief Connection is an accepted client, closed once its reader and every in-flight
+   * request are done with it
+   */
+  struct Connection
+  {
+    int m_fd {-1};                        /// \var connected socket
+    std::mutex m_writeMtx;                /// \var serializes responses of the connection
+    std::thread m_reader;                 /// \var reads and queues the requests
+    std::atomic<bool> m_done {false};     /// \var reader has exited
+
+    ~Connection();
+  };
+
+  /**
+   * @brief Request is a received frame waiting for its batch
+   */
+  struct Request
+  {
+    std::shared_ptr<Connection> m_connection; /// \var connection to answer on
+    std::uint32_t m_id {0};               /// \var request id
+    cv::Mat m_frame;                      /// \var received frame
+    std::chrono::steady_clock::time_point m_arrival; /// \var frame fully received
+  };
+
+  HotSwapEngine m_engine;                 /// \var engine slot, only run by the batcher
+  std::unique_ptr<HotSwapEngine> m_singleEngine; /// \var batch size 1 slot, lone requests
+  ServeConfig m_config;                   /// \var batching parameters
+  std::string m_socketPath;               /// \var bound socket file
+  int m_listenFd {-1};                    /// \var listening socket
+  std::atomic<bool> m_stopping {false};   /// \var stop() was called
+  std::thread m_acceptor;                 /// \var accepts connections
+  std::thread m_batcher;                  /// \var runs the batches
+  std::mutex m_connectionsMtx;            /// \var guards m_connections
+  std::vector<std::shared_ptr<Connection>> m_connections; /// \var live connections
+  std::mutex m_queueMtx;                  /// \var guards m_queue and m_queueClosed
+  std::condition_variable m_queueCv;      /// \var signals queued requests
+  std::deque<Request> m_queue;            /// \var requests waiting for a batch
+  bool m_queueClosed {false};             /// \var no more requests will be queued
+  ServeMetrics m_metrics;                 /// \var latencies, written by the batcher
+
+  void acceptLoop();
+  void readLoop(std::shared_ptr<Connection> connection);
+  void batchLoop();
+
+  /**
+   * @brief runs one batch and answers its requests
+   * @param batch requests of the batch
+   * @param frames scratch: frames of the batch
+   * @param message scratch: encoded response
+   */
+  void runBatch(std::vector<Request>& batch, std::vector<cv::Mat>& frames,
+                std::vector<std::uint8_t>& message);
+
+  /**
+   * @brief sends an encoded response, a failed send only drops the response
+   * @param connection connection to answer on
+   * @param message encoded response
+   */
+  static void respond(Connection& connection, const std::vector<std::uint8_t>& message);
+
+public:
+  /**
+   * @param engine initialized object detection engine, its batch size has to be at least
+   * config.m_maxBatch. Not owned, it has to outlive the server and is never reloaded.
+   * @param config batching parameters
+   */
+  InferenceServer(AbsEngine* engine, const ServeConfig& config);
+
+  /**
+   * @param engine initialized object detection engine, see above, owned by the engine slot
+   * @param config batching parameters
+   * @param singleEngine optional engine of batch size 1 a batch of one request runs on, so
+   * it does not pay for a full batch. Owned by its own slot.
+   */
+  InferenceServer(std::shared_ptr<AbsEngine> engine, const ServeConfig& config,
+                  std::shared_ptr<AbsEngine> singleEngine = nullptr);
+  ~InferenceServer();
+
+  /**
+   * @brief returns the engine slot, reloaded engines need the same batch size
+   */
+  HotSwapEngine& engine() { return m_engine; }
+
+  /**
+   * @brief returns the batch size 1 slot, nullptr if the server has none
+   */
+  HotSwapEngine* singleEngine() { return m_singleEngine.get(); }
+
+  /**
+   * @brief binds the socket, replacing a stale socket file, and starts serving
+   * @param socketPath path of the socket file
+   * @return true if successful, false otherwise
+   */
+  bool start(const std::string& socketPath);
+
+  /**
+   * @brief stops accepting, closes every connection, drops the queued requests and joins
+   * the threads
+   */
+  void stop();
+
+  /**
+   * @brief returns the metrics of the run, only valid after stop()
+   */
+  const ServeMetrics& metrics() const { return m_metrics; }
+
+  /**
+   * @brief prints the request count, batch sizes and latency percentiles, only valid after
+   * stop() (the latencies are sorted in place)
+   */
+  void printSummary();
+};
+
+/**
+ * @brief ServeClient is a blocking client connection, one request in flight at a time
+ */
+class ServeClient
+{
+  int m_fd {-1};                          /// \var connected socket
+  std::vector<std::uint8_t> m_message;    /// \var scratch: received response
+
+public:
+  ServeClient() = default;
+  ServeClient(const ServeClient&) = delete;
+  ServeClient& operator=(const ServeClient&) = delete;
+  ~ServeClient();
+
+  /**
+   * @brief connects to the server
+   * @param socketPath path of the socket file
+   * @return true if successful, false otherwise
+   */
+  bool connect(const std::string& socketPath);
+
+  /**
+   * @brief sends a frame and waits for its response
+   * @param id request id
+   * @param frame 8 bit frame with 1 or 3 channels
+   * @param header output response header
+   * @param detections output detections
+   * @return true if a response was received, false on a protocol or connection error
+   */
+  bool request(std::uint32_t id, const cv::Mat& frame, ServeResponseHeader& header,
+               std::vector<ServeDetection>& detections);
+};
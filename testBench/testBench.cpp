@@ -1,23 +1,718 @@
 #include "testBench.h"
+#include "../utils/profiler/profiler.h"
+#include "../utils/report/matrix.h"
 
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
 #include <spdlog/spdlog.h>
+#include <spdlog/fmt/fmt.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <csignal>
+#include <pthread.h>
+#include <thread>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
-bool TestBenchFactory::start(const std::string& path)
+namespace
 {
-  if (!m_config.parseConfigFile(path))
+
+/**
+ * @brief blocks SIGINT and SIGTERM in the calling thread. Threads started afterwards inherit
+ * the mask, so only waitForStopSignal receives them.
+ * @param reloadSignal also block SIGHUP, see waitForStopSignal
+ */
+sigset_t blockStopSignals(bool reloadSignal = false)
+{
+  sigset_t stopSignals;
+  sigemptyset(&stopSignals);
+  sigaddset(&stopSignals, SIGINT);
+  sigaddset(&stopSignals, SIGTERM);
+  if (reloadSignal)
+    sigaddset(&stopSignals, SIGHUP);
+  pthread_sigmask(SIG_BLOCK, &stopSignals, nullptr);
+  return stopSignals;
+}
+
+/**
+ * @brief waits for SIGINT or SIGTERM, then unblocks them so a second one ends the process
+ * @param stopSignals signals of blockStopSignals
+ * @param caller name logged with the signal
+ * @param onReload called on every SIGHUP if blockStopSignals blocked it
+ */
+void waitForStopSignal(const sigset_t& stopSignals, const char* caller,
+                       const std::function<void()>& onReload = {})
+{
+  int signal {0};
+  while (sigwait(&stopSignals, &signal) == 0 && signal == SIGHUP)
+  {
+    spdlog::info("{}: {} received, reloading", caller, strsignal(signal));
+    onReload();
+  }
+  pthread_sigmask(SIG_UNBLOCK, &stopSignals, nullptr);
+  spdlog::info("{}: {} received, stopping", caller, strsignal(signal));
+}
+
+/**
+ * @brief EngineWithConfig keeps the configuration an engine refers to alive with the engine
+ */
+struct EngineWithConfig
+{
+  TestBenchConfig m_config;               /// \var configuration of the engine
+  std::unique_ptr<AbsEngine> m_engine;    /// \var engine, refers to m_config
+};
+
+/**
+ * @brief creates and initializes the configured engine and runs one warm-up invoke on a
+ * blank frame, the first invoke pays for lazy allocations
+ * @param config test bench configuration, the engine keeps a copy
+ * @param batchSize frames per invoke, above 1 the batch size is set and warmed up
+ * @return engine owning its configuration, nullptr on failure
+ */
+std::shared_ptr<AbsEngine> buildWarmEngine(const TestBenchConfig& config, int batchSize)
+{
+  auto built {std::make_shared<EngineWithConfig>()};
+  built->m_config = config;
+  built->m_engine = AbsTestBench::getEngine(built->m_config);
+  AbsEngine* engine {built->m_engine.get()};
+  if (engine == nullptr || !engine->init(&built->m_config))
+    return nullptr;
+  if (batchSize > 1 && !engine->setBatchSize(static_cast<std::size_t>(batchSize)))
+    return nullptr;
+
+  const cv::Mat blank(480, 640, CV_8UC3, cv::Scalar(0, 0, 0));
+  if (config.m_benchType == TestBenchType::SEMANTIC_SEGMENTATION)
+    engine->runSemanticDetection(blank);
+  else if (batchSize > 1)
+    engine->runObjectDetectionBatch(std::span<const cv::Mat>(&blank, 1));
+  else
+    engine->runObjectDetection(blank);
+  return std::shared_ptr<AbsEngine>(built, engine);
+}
+
+/**
+ * @brief runs a function in a forked child and waits for the child
+ * @param run work of the child, its result is the child's exit code
+ * @return wait status of the child, -1 if the fork failed
+ */
+int runForked(const std::function<bool()>& run)
+{
+  std::cout.flush();
+  std::fflush(nullptr);
+  const pid_t child {fork()};
+  if (child < 0)
+  {
+    spdlog::error("runForked: fork failed: {}", std::strerror(errno));
+    return -1;
+  }
+  if (child == 0)
+  {
+    const bool succeeded {run()};
+    std::cout.flush();
+    std::fflush(nullptr);
+    _exit(succeeded ? 0 : 1);
+  }
+
+  int status {0};
+  while (waitpid(child, &status, 0) < 0 && errno == EINTR) {}
+  return status;
+}
+
+double elapsedMs(std::int64_t fromNs, std::int64_t toNs)
+{
+  return static_cast<double>(toNs - fromNs) / 1e6;
+}
+
+}  // namespace
+
+bool TestBenchFactory::start(const std::string& path, const std::string& baselinePath)
+{
+  if (!TestBenchConfig::parseMatrixFile(path, m_configs))
   {
     spdlog::error("TestBenchFactory::start: could not parse config file: {}", path);
     return false;
   }
 
-  std::unique_ptr<AbsTestBench> testBench {getTestBench(m_config.m_benchType)};
+  if (m_configs.size() > 1)
+    return runMatrix(baselinePath);
+
+  TestBenchConfig& config {m_configs.front()};
+  if (config.m_scheduler.m_enabled)
+    return runScheduler(config);
+  if (config.m_hotReload.m_enabled)
+    return runHotReload(config);
+
+  config.m_baselinePath = baselinePath;
+  Dataset dataset;
+  if (!Dataset::load(config.m_datasetDir, dataset))
+  {
+    spdlog::error("TestBenchFactory::start: could not load dataset from path: {}", 
+                  config.m_datasetDir);
+    return false;
+  }
+  return runConfig(config, dataset);
+}
+
+bool TestBenchFactory::runConfig(TestBenchConfig& config, const Dataset& dataset)
+{
+  std::unique_ptr<AbsTestBench> testBench {getTestBench(config.m_benchType)};
   if (testBench == nullptr)
   {
     spdlog::error("TestBenchFactory::start: could not create test bench instance!");
     return false;
   }
     
-  return testBench->runModelBenchmark(&m_config);
+  return testBench->runModelBenchmark(&config, dataset);
+}
+
+bool TestBenchFactory::runMatrix(const std::string& baselinePath)
+{
+  // variants always write json so they can be combined, the combined report takes the 
+  // configured results path (and format)
+  const std::string& resultsPath {m_configs.front().m_resultsPath};
+  const bool keepResults {!resultsPath.empty()};
+  const std::string variantBase {keepResults ? 
+    std::filesystem::path(resultsPath).replace_extension(".json").string() :
+    (std::filesystem::temp_directory_path() / 
+     fmt::format("edge_inference_matrix_{}.json", getpid())).string()};
+
+  // variants are grouped by dataset, in the order the datasets first appear
+  std::vector<VariantSummary> summaries;
+  std::vector<std::vector<std::size_t>> groups;
+  std::map<std::string, std::size_t> datasetGroups;
+  for (TestBenchConfig& config : m_configs)
+  {
+    VariantSummary& summary {summaries.emplace_back()};
+    summary.m_name = config.m_variantName;
+    summary.m_resultsPath = MatrixReport::variantPath(variantBase, config.m_variantName);
+    config.m_resultsPath = summary.m_resultsPath;
+    config.m_recordPath = MatrixReport::variantPath(config.m_recordPath, config.m_variantName);
+
+    // a per variant baseline from an earlier matrix run, else the one given
+    const std::string variantBaseline {
+      MatrixReport::variantPath(baselinePath, config.m_variantName)};
+    config.m_baselinePath = !variantBaseline.empty() && 
+      std::filesystem::exists(variantBaseline) ? variantBaseline : baselinePath;
+
+    const auto [group, added] {datasetGroups.emplace(config.m_datasetDir, groups.size())};
+    if (added)
+      groups.emplace_back();
+    groups[group->second].push_back(summaries.size() - 1);
+  }
+
+  // wait status of every variant, written by the dataset children, -1 if it did not run
+  void* shared {mmap(nullptr, summaries.size() * sizeof(int), PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_ANONYMOUS, -1, 0)};
+  if (shared == MAP_FAILED)
+  {
+    spdlog::error("TestBenchFactory::runMatrix: mmap failed: {}", std::strerror(errno));
+    return false;
+  }
+  int* variantStatus {static_cast<int*>(shared)};
+  std::fill_n(variantStatus, summaries.size(), -1);
+
+  for (const std::vector<std::size_t>& group : groups)
+  {
+    // one child per dataset decodes it, its variants are forked from that child and share
+    // the frames copy-on-write, so no run holds the frames of another dataset
+    const std::string& datasetDir {m_configs[group.front()].m_datasetDir};
+    const int datasetStatus {runForked([&] {
+      Dataset dataset;
+      if (!Dataset::load(datasetDir, dataset))
+      {
+        spdlog::error("TestBenchFactory::runMatrix: could not load dataset from path: {}", 
+                      datasetDir);
+        return false;
+      }
+      for (std::size_t variant : group)
+      {
+        TestBenchConfig& config {m_configs[variant]};
+        spdlog::info("TestBenchFactory::runMatrix: running variant {} ({}/{})", 
+                     config.m_variantName, variant + 1, m_configs.size());
+        variantStatus[variant] = runForked([&] { return runConfig(config, dataset); });
+      }
+      return true;
+    })};
+    if (datasetStatus >= 0 && WIFSIGNALED(datasetStatus))
+      spdlog::error("TestBenchFactory::runMatrix: dataset {} killed by signal {}", 
+                    datasetDir, WTERMSIG(datasetStatus));
+
+    for (std::size_t variant : group)
+    {
+      const int status {variantStatus[variant]};
+      VariantSummary& summary {summaries[variant]};
+      summary.m_succeeded = status >= 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+      if (status >= 0 && WIFSIGNALED(status))
+        spdlog::error("TestBenchFactory::runMatrix: variant {} killed by signal {}", 
+                      summary.m_name, WTERMSIG(status));
+      MatrixReport::load(summary);
+    }
+  }
+  munmap(shared, summaries.size() * sizeof(int));
+
+  MatrixReport::printTable(summaries);
+  bool succeeded {!keepResults || MatrixReport::write(resultsPath, summaries)};
+  for (const VariantSummary& summary : summaries)
+  {
+    succeeded = succeeded && summary.m_succeeded;
+    if (!keepResults)
+      std::filesystem::remove(summary.m_resultsPath);
+  }
+  return succeeded;
+}
+
+bool TestBenchFactory::runScheduler(const TestBenchConfig& config)
+{
+  const SchedulerConfig& schedulerConfig {config.m_scheduler};
+
+  // engines keep a pointer to their config, the configs outlive the scheduler's engines
+  std::vector<std::unique_ptr<TestBenchConfig>> modelConfigs;
+  ModelScheduler scheduler {schedulerConfig.m_policy, 
+                            static_cast<std::size_t>(schedulerConfig.m_workers)};
+  for (const SchedulerModelConfig& modelConfig : schedulerConfig.m_models)
+  {
+    TestBenchConfig& model {*modelConfigs.emplace_back(std::make_unique<TestBenchConfig>())};
+    if (!model.parseConfigFile(modelConfig.m_configPath))
+    {
+      spdlog::error("TestBenchFactory::runScheduler: could not parse config file of model "
+                    "{}: {}", modelConfig.m_name, modelConfig.m_configPath);
+      return false;
+    }
+    Dataset dataset;
+    if (!Dataset::load(model.m_datasetDir, dataset) || dataset.m_frames.empty())
+    {
+      spdlog::error("TestBenchFactory::runScheduler: could not load dataset of model {} "
+                    "from path: {}", modelConfig.m_name, model.m_datasetDir);
+      return false;
+    }
+
+    // the core budget is the number of instances, so every instance has to run on one
+    // core: onnxruntime would start a thread per core in each instance by default
+    if (model.m_engineType == EngineType::ONNXRUNTIME)
+    {
+      if (model.m_intraOpThreads > 1 || model.m_interOpThreads > 1)
+        spdlog::warn("TestBenchFactory::runScheduler: model {} runs one thread per instance, "
+                     "its <intraOpThreads> and <interOpThreads> are ignored", modelConfig.m_name);
+      model.m_intraOpThreads = 1;
+      model.m_interOpThreads = 0;
+    }
+    else if (model.m_engineType == EngineType::OPENVINO)
+      spdlog::warn("TestBenchFactory::runScheduler: the OpenVINO CPU plugin picks its own "
+                   "thread count, model {} may use more cores than its budget",
+                   modelConfig.m_name);
+    std::vector<std::unique_ptr<AbsEngine>> engines;
+    for (int i {0}; i < modelConfig.m_cores; ++i)
+    {
+      engines.push_back(AbsTestBench::getEngine(model));
+      if (engines.back() == nullptr || !engines.back()->init(&model))
+      {
+        spdlog::error("TestBenchFactory::runScheduler: could not create engine instance of "
+                      "model {}!", modelConfig.m_name);
+        return false;
+      }
+    }
+    ModelScheduler::Invoke invoke;
+    if (model.m_benchType == TestBenchType::SEMANTIC_SEGMENTATION)
+      invoke = [](AbsEngine* engine, const cv::Mat& frame) {
+        return engine->runSemanticDetection(frame); };
+    else
+      invoke = [](AbsEngine* engine, const cv::Mat& frame) {
+        return engine->runObjectDetection(frame); };
+    if (!scheduler.addModel(modelConfig, std::move(engines), std::move(invoke),
+                            std::move(dataset.m_frames)))
+      return false;
+  }
+
+  scheduler.run(schedulerConfig.m_durationSec);
+  scheduler.printSummary();
+  return true;
+}
+
+bool TestBenchFactory::runHotReload(const TestBenchConfig& config)
+{
+  Dataset dataset;
+  if (!Dataset::load(config.m_datasetDir, dataset) || dataset.m_frames.empty())
+  {
+    spdlog::error("TestBenchFactory::runHotReload: could not load dataset from path: {}",
+                  config.m_datasetDir);
+    return false;
+  }
+  std::shared_ptr<AbsEngine> initial {buildWarmEngine(config, 1)};
+  if (initial == nullptr)
+  {
+    spdlog::error("TestBenchFactory::runHotReload: could not create engine instance!");
+    return false;
+  }
+  HotSwapEngine slot {std::move(initial)};
+  const HotReloadConfig& hotReload {config.m_hotReload};
+  const bool segmentation {config.m_benchType == TestBenchType::SEMANTIC_SEGMENTATION};
+
+  // paced frames like a camera, the latency counts from the scheduled capture so frames
+  // delayed by a slow one are included
+  using SteadyClock = std::chrono::steady_clock;
+  auto toNs = [](SteadyClock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      time.time_since_epoch()).count();
+  };
+  std::vector<std::int64_t> scheduledNs;
+  std::vector<double> latencies;
+  std::size_t failed {0};
+  std::atomic<bool> stopping {false};
+  std::thread serving([&] {
+    const auto period {std::chrono::duration_cast<SteadyClock::duration>(
+      std::chrono::duration<double>(1.0 / hotReload.m_fps))};
+    SteadyClock::time_point next {SteadyClock::now()};
+    for (std::size_t i {0}; !stopping; ++i)
+    {
+      next += period;
+      std::this_thread::sleep_until(next);
+      const std::shared_ptr<AbsEngine> engine {slot.acquire()};
+      const cv::Mat& frame {dataset.m_frames[i % dataset.m_frames.size()]};
+      if (!(segmentation ? engine->runSemanticDetection(frame) :
+                           engine->runObjectDetection(frame)))
+        ++failed;
+      scheduledNs.push_back(toNs(next));
+      latencies.push_back(elapsedMs(toNs(next), toNs(SteadyClock::now())));
+    }
+  });
+
+  // reloads alternate between the configured model and <hotReload><modelPath>
+  const auto interval {std::chrono::duration<double>(hotReload.m_intervalSec)};
+  for (int i {0}; i < hotReload.m_reloads; ++i)
+  {
+    std::this_thread::sleep_for(interval);
+    TestBenchConfig next {config};
+    if (!hotReload.m_modelPath.empty() && i % 2 == 0)
+      next.m_modelPath = hotReload.m_modelPath;
+    slot.reload([next] { return buildWarmEngine(next, 1); });
+    slot.wait();
+  }
+  std::this_thread::sleep_for(interval);
+  stopping = true;
+  serving.join();
+
+  // a reload window runs from the request until the swapped-in engine settled, frames
+  // outside every window are the steady state
+  constexpr std::int64_t kSettleNs {500'000'000};
+  const std::vector<ReloadEvent> events {slot.events()};
+  std::vector<std::vector<double>> windows(events.size());
+  std::vector<double> steady;
+  for (std::size_t i {0}; i < latencies.size(); ++i)
+  {
+    auto inWindow = [&](const ReloadEvent& event) {
+      const std::int64_t end {event.m_succeeded ? event.m_freedNs + kSettleNs :
+        event.m_requestNs + static_cast<std::int64_t>(event.m_buildMs * 1e6)};
+      return scheduledNs[i] >= event.m_requestNs && scheduledNs[i] <= end;
+    };
+    const auto it {std::find_if(events.begin(), events.end(), inWindow)};
+    if (it == events.end())
+      steady.push_back(latencies[i]);
+    else
+      windows[it - events.begin()].push_back(latencies[i]);
+  }
+
+  const double periodMs {1000.0 / hotReload.m_fps};
+  auto late = [periodMs](const std::vector<double>& samples) {
+    return std::count_if(samples.begin(), samples.end(),
+                         [periodMs](double latency) { return latency > periodMs; });
+  };
+  std::cout << "--- Hot Model Reload ---\n";
+  std::cout << fmt::format("{:<8} {:>9} {:>9} {:>7} {:>6} {:>9} {:>9} {:>9}\n", "reload",
+                           "build ms", "free ms", "frames", "late", "p50 ms", "p99 ms",
+                           "max ms");
+  auto printRow = [&](const std::string& name, const std::string& buildMs,
+                      const std::string& freeMs, std::vector<double>& samples) {
+    const std::size_t numLate {static_cast<std::size_t>(late(samples))};
+    const Summary summary {Stats::summarize(samples)};
+    std::cout << fmt::format("{:<8} {:>9} {:>9} {:>7} {:>6} {:>9.2f} {:>9.2f} {:>9.2f}\n",
+                             name, buildMs, freeMs, summary.m_count, numLate, summary.m_p50,
+                             summary.m_p99, summary.m_max);
+  };
+  printRow("steady", "-", "-", steady);
+  for (std::size_t i {0}; i < events.size(); ++i)
+  {
+    const ReloadEvent& event {events[i]};
+    printRow(fmt::format("{}", i + 1), fmt::format("{:.1f}", event.m_buildMs),
+             event.m_succeeded ? fmt::format("{:.2f}",
+               elapsedMs(event.m_swapNs, event.m_freedNs)) : std::string("failed"),
+             windows[i]);
+  }
+  if (failed > 0)
+    spdlog::warn("TestBenchFactory::runHotReload: {} frames failed", failed);
+  return failed == 0 && slot.version() == events.size();
+}
+
+bool TestBenchFactory::serve(const std::string& path, const std::string& socketPath)
+{
+  TestBenchConfig config;
+  if (!config.parseConfigFile(path))
+  {
+    spdlog::error("TestBenchFactory::serve: could not parse config file: {}", path);
+    return false;
+  }
+  if (config.m_benchType != TestBenchType::OBJECT_DETECTION)
+  {
+    spdlog::error("TestBenchFactory::serve: only object detection can be served");
+    return false;
+  }
+
+  // a batched server keeps a batch size 1 engine as well, lone requests run on it
+  const int maxBatch {config.m_serve.m_maxBatch};
+  std::shared_ptr<AbsEngine> engine {buildWarmEngine(config, maxBatch)};
+  std::shared_ptr<AbsEngine> singleEngine {maxBatch > 1 ? buildWarmEngine(config, 1) : nullptr};
+  if (engine == nullptr || (maxBatch > 1 && singleEngine == nullptr))
+  {
+    spdlog::error("TestBenchFactory::serve: could not create engine instance!");
+    return false;
+  }
+
+  const sigset_t stopSignals {blockStopSignals(true)};
+  InferenceServer server {std::move(engine), config.m_serve, std::move(singleEngine)};
+  if (!server.start(socketPath))
+    return false;
+
+  // SIGHUP re-reads the config file and swaps in its model once it is built and warm, the
+  // batching of the running server stays
+  waitForStopSignal(stopSignals, "TestBenchFactory::serve", [&] {
+    TestBenchConfig reloaded;
+    if (!reloaded.parseConfigFile(path) ||
+        reloaded.m_benchType != TestBenchType::OBJECT_DETECTION)
+    {
+      spdlog::error("TestBenchFactory::serve: could not reload object detection config "
+                    "file: {}", path);
+      return;
+    }
+    server.engine().reload([reloaded, maxBatch] {
+      return buildWarmEngine(reloaded, maxBatch); });
+    if (server.singleEngine() != nullptr)
+      server.singleEngine()->reload([reloaded] { return buildWarmEngine(reloaded, 1); });
+  });
+  server.stop();
+  server.printSummary();
+  return true;
+}
+
+bool TestBenchFactory::runClient(const std::string& path, const std::string& socketPath)
+{
+  TestBenchConfig config;
+  if (!config.parseConfigFile(path))
+  {
+    spdlog::error("TestBenchFactory::runClient: could not parse config file: {}", path);
+    return false;
+  }
+  if (!config.m_loadSweep.m_enabled)
+  {
+    spdlog::error("TestBenchFactory::runClient: the client needs a <loadSweep> node");
+    return false;
+  }
+  Dataset dataset;
+  if (!Dataset::load(config.m_datasetDir, dataset))
+  {
+    spdlog::error("TestBenchFactory::runClient: could not load dataset from path: {}", 
+                  config.m_datasetDir);
+    return false;
+  }
+
+  // every instance is a connection with one request in flight, used by one sweep worker
+  const std::size_t numClients {static_cast<std::size_t>(config.m_loadSweep.m_instances)};
+  std::vector<std::unique_ptr<ServeClient>> clients;
+  for (std::size_t i {0}; i < numClients; ++i)
+  {
+    clients.push_back(std::make_unique<ServeClient>());
+    if (!clients.back()->connect(socketPath))
+      return false;
+  }
+  std::vector<std::uint32_t> nextIds(numClients, 0);
+  std::vector<std::vector<ServeDetection>> detections(numClients);
+  std::atomic<std::size_t> overloaded {0};
+  std::atomic<std::size_t> failed {0};
+
+  std::vector<LoadPoint> curve;
+  if (!LoadGenerator::sweep(config.m_loadSweep, dataset.m_frames,
+        [&](std::size_t client, const cv::Mat& frame) {
+          ServeResponseHeader header;
+          if (!clients[client]->request(nextIds[client]++, frame, header, detections[client]) ||
+              header.m_status == ServeStatus::FAILED)
+            ++failed;
+          else if (header.m_status == ServeStatus::OVERLOADED)
+            ++overloaded;
+        }, curve))
+  {
+    spdlog::error("TestBenchFactory::runClient: load sweep failed!");
+    return false;
+  }
+
+  LoadGenerator::printCurve(curve, LoadGenerator::findKnee(curve, 
+                                                           config.m_loadSweep.m_kneeFactor));
+  if (overloaded > 0 || failed > 0)
+    spdlog::warn("TestBenchFactory::runClient: {} requests rejected by a full server queue, "
+                 "{} failed", overloaded.load(), failed.load());
+  return failed == 0;
+}
+
+bool TestBenchFactory::produce(const std::string& path, const std::string& ringName)
+{
+  TestBenchConfig config;
+  if (!config.parseConfigFile(path))
+  {
+    spdlog::error("TestBenchFactory::produce: could not parse config file: {}", path);
+    return false;
+  }
+  const FrameRingConfig& ringConfig {config.m_frameRing};
+
+  // dataset frames are scaled to the ring geometry once, without a dataset frames are flat
+  std::vector<cv::Mat> sources;
+  Dataset dataset;
+  if (!config.m_datasetDir.empty() && Dataset::load(config.m_datasetDir, dataset))
+  {
+    for (const cv::Mat& frame : dataset.m_frames)
+      cv::resize(frame, sources.emplace_back(), cv::Size(ringConfig.m_width, 
+                                                         ringConfig.m_height));
+  }
+
+  const sigset_t stopSignals {blockStopSignals()};
+  FrameRing ring;
+  if (!ring.create(ringName, ringConfig))
+    return false;
+
+  std::atomic<bool> stopping {false};
+  std::size_t published {0};
+  std::size_t stalled {0};
+  std::thread camera([&] {
+    const auto period {std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(1.0 / ringConfig.m_fps))};
+    std::chrono::steady_clock::time_point next {std::chrono::steady_clock::now()};
+    for (std::size_t i {0}; !stopping; ++i)
+    {
+      next += period;
+      std::this_thread::sleep_until(next);
+      const std::int64_t captureNs {FrameRing::nowNs()};
+      cv::Mat slot {ring.beginWrite()};
+      if (slot.empty())
+      {
+        ++stalled;
+        continue;
+      }
+      if (sources.empty())
+        slot.setTo(cv::Scalar(i % 256, 128, 255 - i % 256));
+      else
+        sources[i % sources.size()].copyTo(slot);
+      ring.publish(captureNs);
+      ++published;
+    }
+  });
+
+  // capture to result includes the way back through the results ring
+  std::vector<double> latencies;
+  std::thread results([&] {
+    FrameResult result;
+    while (!stopping)
+    {
+      if (ring.popResult(result, 100))
+        latencies.push_back(elapsedMs(result.m_captureNs, FrameRing::nowNs()));
+    }
+  });
+
+  waitForStopSignal(stopSignals, "TestBenchFactory::produce");
+  stopping = true;
+  camera.join();
+  results.join();
+
+  spdlog::info("TestBenchFactory::produce: {} frames published, {} stalled on pinned slots, "
+               "{} results received, {} dropped on a full results ring", published, stalled,
+               latencies.size(), ring.droppedResults());
+  if (!latencies.empty())
+  {
+    const Summary summary {Stats::summarize(latencies)};
+    spdlog::info("TestBenchFactory::produce: capture to result p50 {:.2f} ms, p99 {:.2f} ms",
+                 summary.m_p50, summary.m_p99);
+  }
+  return true;
+}
+
+bool TestBenchFactory::consume(const std::string& path, const std::string& ringName)
+{
+  TestBenchConfig config;
+  if (!config.parseConfigFile(path))
+  {
+    spdlog::error("TestBenchFactory::consume: could not parse config file: {}", path);
+    return false;
+  }
+  if (config.m_benchType != TestBenchType::OBJECT_DETECTION)
+  {
+    spdlog::error("TestBenchFactory::consume: only object detection results can be sent back");
+    return false;
+  }
+
+  std::unique_ptr<AbsEngine> engine {AbsTestBench::getEngine(config)};
+  if (engine == nullptr || !engine->init(&config))
+  {
+    spdlog::error("TestBenchFactory::consume: could not create engine instance!");
+    return false;
+  }
+  FrameRing ring;
+  if (!ring.open(ringName))
+    return false;
+
+  const sigset_t stopSignals {blockStopSignals()};
+  std::atomic<bool> stopping {false};
+  std::vector<double> inferenceMs;
+  std::vector<double> captureToResultMs;
+  std::thread worker([&] {
+    FrameLease lease;
+    FrameResult result;
+    while (!stopping)
+    {
+      if (!ring.acquire(lease, 100))
+        continue;
+
+      // the engine reads the shared slot in place, the preprocessing is its only copy
+      const std::int64_t startNs {FrameRing::nowNs()};
+      const bool succeeded {engine->runObjectDetection(lease.m_frame)};
+      const std::int64_t endNs {FrameRing::nowNs()};
+      ring.release(lease);
+      if (!succeeded)
+      {
+        spdlog::error("TestBenchFactory::consume: inference of frame {} failed", 
+                      lease.m_sequence);
+        continue;
+      }
+
+      result.m_sequence = lease.m_sequence;
+      result.m_captureNs = lease.m_captureNs;
+      result.m_count = static_cast<std::uint16_t>(ServeProtocol::encodeDetections(
+        engine->getDetections(), result.m_detections, FrameResult::kMaxDetections));
+      ring.pushResult(result);
+      inferenceMs.push_back(elapsedMs(startNs, endNs));
+      captureToResultMs.push_back(elapsedMs(lease.m_captureNs, FrameRing::nowNs()));
+    }
+  });
+
+  waitForStopSignal(stopSignals, "TestBenchFactory::consume");
+  stopping = true;
+  worker.join();
+
+  spdlog::info("TestBenchFactory::consume: consumer {} ran {} frames, skipped {} newer ones",
+               ring.consumer(), inferenceMs.size(), ring.skippedFrames());
+  if (!inferenceMs.empty())
+  {
+    const Summary inference {Stats::summarize(inferenceMs)};
+    const Summary captureToResult {Stats::summarize(captureToResultMs)};
+    spdlog::info("TestBenchFactory::consume: inference p50 {:.2f} ms, p99 {:.2f} ms, "
+                 "capture to result p50 {:.2f} ms, p99 {:.2f} ms", inference.m_p50,
+                 inference.m_p99, captureToResult.m_p50, captureToResult.m_p99);
+  }
+  return true;
 }
 
 std::unique_ptr<AbsTestBench> TestBenchFactory::getTestBench(TestBenchType type)
@@ -34,58 +729,358 @@ std::unique_ptr<AbsTestBench> TestBenchFactory::getTestBench(TestBenchType type)
   }
 }
 
-bool AbsTestBench::runModelBenchmark(TestBenchConfig* config)
+bool AbsTestBench::runModelBenchmark(TestBenchConfig* config, const Dataset& input)
 {
-  std::unique_ptr<AbsEngine> engine {getEngine(config->m_engineType)};
+  std::unique_ptr<AbsEngine> engine {getEngine(*config)};
   if (engine == nullptr) 
   {
     spdlog::error("AbsTestBench::runModelBenchmark: could not create engine instance!");
     return false;
   }
-  const std::vector<cv::Mat>& dataset {loadDataset(config->m_datasetDir)};
-  if (dataset.empty())
+  const std::vector<cv::Mat>& dataset {input.m_frames};
+
+  const AllocCounters initAllocs {MemoryProbe::allocCounters()};
+  if (!engine->init(config))  // initialize the engine parameters
   {
-    spdlog::error("AbsTestBench::runModelBenchmark: could not load dataset from path: {}", 
-                   config->m_datasetDir);
+    spdlog::error("start: Engine initialization failed!");
     return false;
   }
+  m_results.m_memory.m_initAllocs = MemoryProbe::allocCounters() - initAllocs;
 
-  if (!engine->init(config))  // initialize the engine parameters
+  // batching applies to the closed loop, the input is resized once before the warm-up
+  if (config->m_batchSize > 1)
   {
-    spdlog::error("start: Engine initialization failed!");
+    if (config->m_benchType != TestBenchType::OBJECT_DETECTION)
+    {
+      spdlog::error("AbsTestBench::runModelBenchmark: <batchSize> is only supported for "
+                    "object detection");
+      return false;
+    }
+    if (config->m_loadSweep.m_enabled || config->m_realtime.m_enabled)
+    {
+      spdlog::warn("AbsTestBench::runModelBenchmark: paced and load sweep runs are not "
+                   "batched, ignoring <batchSize>");
+    }
+    else
+    {
+      if (!engine->setBatchSize(config->m_batchSize))
+        return false;
+      m_batchSize = config->m_batchSize;
+    }
+  }
+  m_results.m_batchSize = m_batchSize;
+  m_results.m_memory.m_startup = MemoryProbe::takeSnapshot();
+  m_results.m_memory.m_allocHookInstalled = MemoryProbe::m_hookInstalled.load();
+
+  if (!prepareEvaluation(engine.get(), input, config))
+  {
+    spdlog::error("AbsTestBench::runModelBenchmark: could not load annotations from path: {}",
+                  config->m_annotationsPath);
     return false;
   }
 
-  for (const auto& frame : dataset)
-    runInference(engine.get(), frame);
+  // counters are opened per thread, a failed probe only drops them from the summary
+  if (config->m_perfCounters && !PerfCounters::enable())
+    spdlog::warn("AbsTestBench::runModelBenchmark: hardware counters unavailable, "
+                 "reporting wall-clock times only");
+
+  // first invokes pay for weight packing, page faults and cold caches
+  const bool warmedUp {runWarmup(engine.get(), dataset, config)};
+
+  // only the measured frames are recorded, the writer runs on its own thread
+  std::unique_ptr<TensorRecorder> recorder;
+  if (!config->m_recordPath.empty())
+  {
+    // the outputs of concurrent instances would interleave within the frames of one file
+    if (config->m_loadSweep.m_enabled && config->m_loadSweep.m_instances > 1)
+    {
+      spdlog::error("AbsTestBench::runModelBenchmark: <recordPath> needs a load sweep with "
+                    "one instance, got {}", config->m_loadSweep.m_instances);
+      return false;
+    }
+    recorder = std::make_unique<TensorRecorder>();
+    if (!recorder->open(config->m_recordPath, static_cast<std::uint32_t>(config->m_benchType),
+                        static_cast<std::uint32_t>(config->m_arch)))
+      return false;
+    engine->setRecorder(recorder.get());
+  }
+
+  if (config->m_loadSweep.m_enabled)
+  {
+    if (!runLoadSweep(engine.get(), dataset, config))
+      return false;
+  }
+  else if (config->m_realtime.m_enabled)
+  {
+    if (!runPaced(engine.get(), dataset, config))
+      return false;
+  }
+  else
+  {
+    runClosedLoop(engine.get(), dataset, warmedUp);
+  }
+  if (recorder != nullptr)
+  {
+    engine->setRecorder(nullptr);
+    if (!recorder->close())
+    {
+      spdlog::error("AbsTestBench::runModelBenchmark: recording {} is incomplete", 
+                    config->m_recordPath);
+      return false;
+    }
+  }
+  m_results.m_memory.m_steadyState = MemoryProbe::takeSnapshot();
+  engine->collectMemoryStats(m_results.m_memory);
   
   evaluateOutput(engine.get());
+  Storage::printSummary();
+  MemoryProbe::printSummary(m_results.m_memory);
+
+  if (!config->m_resultsPath.empty() && 
+      !ResultsWriter::write(config->m_resultsPath, *config, m_results))
+    return false;
+
+  if (!config->m_baselinePath.empty())
+    return compareWithBaseline(config);
 
   return true;
 }
 
-std::unique_ptr<AbsEngine> AbsTestBench::getEngine(EngineType type)
+void AbsTestBench::runClosedLoop(AbsEngine* engine, const std::vector<cv::Mat>& dataset,
+                                 bool warmedUp)
 {
-  switch (type)
+  // sample buffers are sized up front, nothing is allocated or written while measuring
+  Storage::reset();
+  Storage::reserve(dataset.size());
+  std::chrono::steady_clock::duration evaluationTime {0};
+  const auto start {std::chrono::steady_clock::now()};
+  for (std::size_t i {0}; i < dataset.size();)
+  {
+    const AllocCounters frameAllocs {MemoryProbe::allocCounters()};
+    const std::size_t frames {runStep(engine, dataset, i)};
+
+    // matching against the ground truth is not part of the measured throughput
+    const auto evaluationStart {std::chrono::steady_clock::now()};
+    for (std::size_t slot {0}; slot < frames; ++slot)
+      accumulateOutput(engine, i + slot, slot);
+    evaluationTime += std::chrono::steady_clock::now() - evaluationStart;
+
+    // the first frame pays for lazy allocations, keep it apart from the steady state
+    if (i == 0 && !warmedUp)
+    {
+      m_results.m_memory.m_firstFrameAllocs = MemoryProbe::allocCounters() - frameAllocs;
+    }
+    else
+    {
+      m_results.m_memory.m_steadyAllocs += MemoryProbe::allocCounters() - frameAllocs;
+      m_results.m_memory.m_steadyFrames += frames;
+    }
+    i += frames;
+  }
+  m_results.m_wallTimeSec = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start - evaluationTime).count();
+  m_results.m_numFrames = dataset.size();
+}
+
+bool AbsTestBench::runPaced(AbsEngine* engine, const std::vector<cv::Mat>& dataset,
+                            TestBenchConfig* config)
+{
+  const RealtimeConfig& realtime {config->m_realtime};
+  const std::size_t numFrames {realtime.m_frames > 0 ? 
+                               static_cast<std::size_t>(realtime.m_frames) : dataset.size()};
+
+  Storage::reset();
+  Storage::reserve(numFrames);
+  const AllocCounters allocs {MemoryProbe::allocCounters()};
+  const auto start {std::chrono::steady_clock::now()};
+  if (!PacedRunner::run(realtime, dataset, 
+                        [this, engine](const cv::Mat& frame) { runInference(engine, frame); },
+                        m_results.m_realtime))
+  {
+    spdlog::error("AbsTestBench::runPaced: paced run failed!");
+    return false;
+  }
+  m_results.m_wallTimeSec = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start).count();
+  m_results.m_numFrames = m_results.m_realtime.m_processed;
+  m_results.m_memory.m_steadyAllocs += MemoryProbe::allocCounters() - allocs;
+  m_results.m_memory.m_steadyFrames += m_results.m_realtime.m_processed;
+  return true;
+}
+
+bool AbsTestBench::runLoadSweep(AbsEngine* engine, const std::vector<cv::Mat>& dataset,
+                                TestBenchConfig* config)
+{
+  // every instance owns its interpreter and output buffers, nothing is shared per request
+  std::vector<std::unique_ptr<AbsEngine>> extraInstances;
+  std::vector<AbsEngine*> instances {engine};
+  for (int i {1}; i < config->m_loadSweep.m_instances; ++i)
+  {
+    std::unique_ptr<AbsEngine> instance {getEngine(*config)};
+    if (instance == nullptr || !instance->init(config))
+    {
+      spdlog::error("AbsTestBench::runLoadSweep: could not create engine instance {}", i);
+      return false;
+    }
+    runInference(instance.get(), dataset.front());  // first invoke is not part of the sweep
+    instances.push_back(instance.get());
+    extraInstances.push_back(std::move(instance));
+  }
+
+  // sample buffers are sized for the whole sweep, nothing is reallocated while measuring
+  Storage::reset();
+  Storage::reserve(LoadGenerator::expectedRequests(config->m_loadSweep));
+  const auto start {std::chrono::steady_clock::now()};
+  if (!LoadGenerator::sweep(config->m_loadSweep, dataset,
+        [this, &instances](std::size_t instance, const cv::Mat& frame) { 
+          runInference(instances[instance], frame); 
+        }, m_results.m_loadCurve))
+  {
+    spdlog::error("AbsTestBench::runLoadSweep: load sweep failed!");
+    return false;
+  }
+  m_results.m_wallTimeSec = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start).count();
+  for (const LoadPoint& point : m_results.m_loadCurve)
+    m_results.m_numFrames += point.m_requests;
+
+  m_results.m_kneeIndex = LoadGenerator::findKnee(m_results.m_loadCurve, 
+                                                  config->m_loadSweep.m_kneeFactor);
+  LoadGenerator::printCurve(m_results.m_loadCurve, m_results.m_kneeIndex);
+  return true;
+}
+
+std::size_t AbsTestBench::runStep(AbsEngine* engine, const std::vector<cv::Mat>& dataset,
+                                  std::size_t first)
+{
+  first %= dataset.size();
+  if (m_batchSize <= 1)
+  {
+    runInference(engine, dataset[first]);
+    return 1;
+  }
+
+  const std::size_t frames {std::min(m_batchSize, dataset.size() - first)};
+  runInferenceBatch(engine, std::span<const cv::Mat>(dataset).subspan(first, frames));
+  return frames;
+}
+
+bool AbsTestBench::runWarmup(AbsEngine* engine, const std::vector<cv::Mat>& dataset,
+                             TestBenchConfig* config)
+{
+  const bool untilStable {config->m_warmupCv > 0.0f};
+  if (config->m_warmupFrames <= 0 && !untilStable)
+    return false;
+
+  const std::size_t minFrames {static_cast<std::size_t>(std::max(config->m_warmupFrames, 1))};
+  const std::size_t maxFrames {untilStable ? 
+    std::max(minFrames, static_cast<std::size_t>(config->m_warmupMaxFrames)) : minFrames};
+  const std::size_t window {static_cast<std::size_t>(config->m_warmupWindow)};
+
+  // ring buffer of the latest latencies for the rolling coefficient of variation
+  std::vector<double> latencies(window, 0.0);
+  // with batching a step is one batch, the latencies are per batch
+  std::size_t frames {0};
+  std::size_t steps {0};
+  bool converged {false};
+  while (frames < maxFrames)
+  {
+    const AllocCounters frameAllocs {MemoryProbe::allocCounters()};
+    const auto start {std::chrono::steady_clock::now()};
+    const std::size_t stepFrames {runStep(engine, dataset, frames)};
+    const double latency {std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start).count()};
+
+    if (steps == 0)
+    {
+      m_results.m_coldStartMs = latency;
+      m_results.m_memory.m_firstFrameAllocs = MemoryProbe::allocCounters() - frameAllocs;
+    }
+    latencies[steps % window] = latency;
+    ++steps;
+    frames += stepFrames;
+
+    if (frames < minFrames || !untilStable || steps < window)
+      continue;
+
+    const double mean {std::accumulate(latencies.begin(), latencies.end(), 0.0) / window};
+    double squares {0.0};
+    for (double value : latencies)
+      squares += (value - mean) * (value - mean);
+    const double cv {mean > 0.0 ? std::sqrt(squares / (window - 1)) / mean : 0.0};
+    if (cv <= config->m_warmupCv)
+    {
+      converged = true;
+      break;
+    }
+  }
+
+  m_results.m_warmupFrames = frames;
+  m_results.m_warmupConverged = converged;
+  if (untilStable && !converged)
+    spdlog::warn("AbsTestBench::runWarmup: latency did not stabilise below cv {} within {} "
+                 "frames, measuring anyway", config->m_warmupCv, frames);
+  spdlog::info("AbsTestBench::runWarmup: cold start {:.3f} ms, {} warm-up frames",
+               m_results.m_coldStartMs, frames);
+  return true;
+}
+
+bool AbsTestBench::compareWithBaseline(TestBenchConfig* config)
+{
+  std::vector<StageComparison> comparisons;
+  if (!BaselineComparator::compare(config->m_baselinePath, config->m_compareTolerance,
+                                   config->m_compareAlpha, comparisons))
+  {
+    spdlog::error("AbsTestBench::compareWithBaseline: could not compare against baseline: {}",
+                  config->m_baselinePath);
+    return false;
+  }
+  BaselineComparator::printTable(comparisons, config->m_compareTolerance);
+
+  const auto regressions {std::count_if(comparisons.begin(), comparisons.end(),
+    [](const StageComparison& c) { return c.m_regressed; })};
+  if (regressions > 0)
+  {
+    spdlog::error("AbsTestBench::compareWithBaseline: {} stage(s) regressed against {}",
+                  regressions, config->m_baselinePath);
+    return false;
+  }
+  return true;
+}
+
+std::unique_ptr<AbsEngine> AbsTestBench::getEngine(const TestBenchConfig& config)
+{
+  if (!config.m_enginePluginPath.empty())
+    return EnginePlugin::create(config.m_enginePluginPath, config.m_engineType);
+
+  switch (config.m_engineType)
   {
     case EngineType::TFLITE:
       return std::make_unique<EngineLite>();
+#ifdef EDGE_ENGINE_PLUGINS
+    // the optional engines are separate shared objects, loaded on first use
+    case EngineType::OPENVINO:
+    case EngineType::ONNXRUNTIME:
+      return EnginePlugin::create(EnginePlugin::defaultPath(config.m_engineType), 
+                                  config.m_engineType);
+#else
     case EngineType::OPENVINO:
       return std::make_unique<EngineVino>();
+    case EngineType::ONNXRUNTIME:
+      return std::make_unique<EngineOrt>();
+#endif
     case EngineType::TENSORRT:
       return std::make_unique<EngineRt>();
+    case EngineType::REPLAY:
+      return std::make_unique<EngineReplay>();
+    case EngineType::NULL_ENGINE:
+      return std::make_unique<EngineNull>();
     default:
       spdlog::error("TestBench::getEngine: Unknown engine type!");
       return nullptr;
   }
 }
 
-std::vector<cv::Mat> AbsTestBench::loadDataset(const std::string& path)
-{
-  // TODO
-  return std::vector<cv::Mat>{};
-}
-
 void ObjectDetectionBench::runInference(AbsEngine* engine, const cv::Mat& frame)
 {
   if (!engine->runObjectDetection(frame))
@@ -93,10 +1088,99 @@ void ObjectDetectionBench::runInference(AbsEngine* engine, const cv::Mat& frame)
   
 }
 
+bool ObjectDetectionBench::prepareEvaluation(AbsEngine* engine, const Dataset& dataset,
+                                             TestBenchConfig* config)
+{
+  m_config = config;
+  if (config->m_annotationsPath.empty())
+  {
+    if (config->m_thresholdSweep.m_enabled)
+      spdlog::warn("ObjectDetectionBench::prepareEvaluation: the threshold sweep needs "
+                   "<annotations>, skipping it");
+    return true;
+  }
+
+  std::vector<std::pair<int, int>> frameSizes;
+  frameSizes.reserve(dataset.m_frames.size());
+  for (const cv::Mat& frame : dataset.m_frames)
+    frameSizes.emplace_back(frame.cols, frame.rows);
+
+  if (!AnnotationLoader::load(config->m_annotationsPath, dataset.m_names, frameSizes,
+                              engine->getClassNames(), m_annotations))
+    return false;
+  m_evaluator = std::make_unique<DetectionEvaluator>(engine->getClassNames().size());
+  if (config->m_thresholdSweep.m_enabled)
+    m_candidates.resize(dataset.m_frames.size());
+  return true;
+}
+
+void ObjectDetectionBench::runInferenceBatch(AbsEngine* engine, std::span<const cv::Mat> frames)
+{
+  if (!engine->runObjectDetectionBatch(frames))
+    spdlog::error("ObjectDetectionBench::runInferenceBatch: Inference failed!");
+}
+
+void ObjectDetectionBench::accumulateOutput(AbsEngine* engine, std::size_t frameIdx,
+                                            std::size_t batchSlot)
+{
+  if (m_evaluator == nullptr)
+    return;
+
+  const bool batched {m_batchSize > 1};
+  detectionsToBoxes(batched ? engine->getBatchDetections()[batchSlot] : engine->getDetections(),
+                    m_boxes, m_scores, m_classes);
+  m_evaluator->addFrame(m_boxes, m_scores, m_classes, m_annotations[frameIdx]);
+  ++m_evaluatedFrames;
+
+  // the sweep settings are evaluated on the recorded candidates after the run
+  if (!m_candidates.empty())
+    m_candidates[frameIdx] = batched ? engine->getBatchCandidates()[batchSlot] : 
+                                       engine->getCandidates();
+}
+
 void ObjectDetectionBench::evaluateOutput(AbsEngine* engine)
 {
-  // TODO
-  spdlog::info("ObjectDetectionBench::validateOutput: test!");
+  if (m_evaluator == nullptr)
+  {
+    spdlog::info("ObjectDetectionBench::evaluateOutput: no annotations, accuracy not evaluated");
+    return;
+  }
+  if (m_evaluatedFrames == 0)
+  {
+    spdlog::warn("ObjectDetectionBench::evaluateOutput: only the closed-loop run is evaluated, "
+                 "no frame was accumulated");
+    return;
+  }
+
+  DetectionMetrics metrics;
+  m_evaluator->compute(metrics);
+
+  const std::vector<std::string>& classNames {engine->getClassNames()};
+  for (std::size_t c {0}; c < metrics.m_ap5095.size(); ++c)
+  {
+    if (metrics.m_ap5095[c] < 0.0)
+      continue;
+    spdlog::debug("ObjectDetectionBench::evaluateOutput: AP@0.5:0.95 {:<20} {:.4f}",
+                  classNames[c], metrics.m_ap5095[c]);
+    m_results.m_metrics.emplace_back("AP50_95/" + classNames[c], metrics.m_ap5095[c]);
+  }
+  m_results.m_metrics.emplace_back("mAP50", metrics.m_map50);
+  m_results.m_metrics.emplace_back("mAP75", metrics.m_map75);
+  m_results.m_metrics.emplace_back("mAP50_95", metrics.m_map5095);
+
+  spdlog::info("ObjectDetectionBench::evaluateOutput: {} frames, {} classes, mAP@0.5 {:.4f}, "
+               "mAP@0.75 {:.4f}, mAP@0.5:0.95 {:.4f}", m_evaluatedFrames, 
+               metrics.m_evaluatedClasses, metrics.m_map50, metrics.m_map75, 
+               metrics.m_map5095);
+
+  if (m_candidates.empty() || m_evaluatedFrames != m_candidates.size())
+    return;
+  const double frameMs {m_results.m_numFrames > 0 ?
+    m_results.m_wallTimeSec * 1000.0 / m_results.m_numFrames : 0.0};
+  ThresholdSweep::run(*m_config, m_candidates, m_annotations, classNames.size(), frameMs,
+                      m_results.m_thresholdSweep);
+  ThresholdSweep::printTable(m_results.m_thresholdSweep);
+  m_candidates.clear();
 }
 
 void SemanticSegmentationBench::runInference(AbsEngine* engine, const cv::Mat& frame)
@@ -107,10 +1191,103 @@ void SemanticSegmentationBench::runInference(AbsEngine* engine, const cv::Mat& f
 
 }
 
+bool SemanticSegmentationBench::prepareEvaluation(AbsEngine* engine, const Dataset& dataset,
+                                                  TestBenchConfig* config)
+{
+  if (config->m_annotationsPath.empty())
+    return true;
+
+  // one single channel png of class indices per frame, named after the frame
+  std::size_t missing {0};
+  m_masks.assign(dataset.m_frames.size(), cv::Mat{});
+  for (std::size_t i {0}; i < dataset.m_frames.size(); ++i)
+  {
+    const std::filesystem::path maskPath {std::filesystem::path(config->m_annotationsPath) /
+      std::filesystem::path(dataset.m_names[i]).stem().concat(".png")};
+    cv::Mat mask {cv::imread(maskPath.string(), cv::IMREAD_UNCHANGED)};
+    if (mask.empty())
+    {
+      ++missing;
+      continue;
+    }
+    if (mask.type() != CV_8UC1)
+    {
+      spdlog::error("SemanticSegmentationBench::prepareEvaluation: {} is not a single channel "
+                    "8-bit class index mask", maskPath.string());
+      return false;
+    }
+    m_masks[i] = std::move(mask);
+  }
+  if (missing == dataset.m_frames.size())
+  {
+    spdlog::error("SemanticSegmentationBench::prepareEvaluation: no mask found in {}",
+                  config->m_annotationsPath);
+    return false;
+  }
+  if (missing > 0)
+    spdlog::warn("SemanticSegmentationBench::prepareEvaluation: {} of {} frames have no mask, "
+                 "they are not evaluated", missing, dataset.m_frames.size());
+
+  m_evaluator = std::make_unique<SegmentationEvaluator>(engine->getClassNames().size());
+  return true;
+}
+
+void SemanticSegmentationBench::accumulateOutput(AbsEngine* engine, std::size_t frameIdx,
+                                                 std::size_t batchSlot)
+{
+  if (m_evaluator == nullptr || m_masks[frameIdx].empty())
+    return;
+
+  const cv::Mat& groundTruth {m_masks[frameIdx]};
+  const cv::Mat* prediction {&engine->getSemantics().m_labelMask};
+  if (prediction->empty())
+    return;
+
+  // labels are compared at the annotation resolution
+  if (prediction->rows != groundTruth.rows || prediction->cols != groundTruth.cols)
+  {
+    cv::resize(*prediction, m_resizedMask, groundTruth.size(), 0, 0, cv::INTER_NEAREST);
+    prediction = &m_resizedMask;
+  }
+  m_evaluator->addFrame(prediction->ptr<std::uint8_t>(), prediction->step,
+                        groundTruth.ptr<std::uint8_t>(), groundTruth.step,
+                        groundTruth.cols, groundTruth.rows);
+  ++m_evaluatedFrames;
+}
+
 void SemanticSegmentationBench::evaluateOutput(AbsEngine* engine)
 {
-  // TODO
-  spdlog::info("SemanticSegmentationBench::validateOutput: test!");
+  if (m_evaluator == nullptr)
+  {
+    spdlog::info("SemanticSegmentationBench::evaluateOutput: no annotations, "
+                 "accuracy not evaluated");
+    return;
+  }
+  if (m_evaluatedFrames == 0)
+  {
+    spdlog::warn("SemanticSegmentationBench::evaluateOutput: only the closed-loop run is "
+                 "evaluated, no frame was accumulated");
+    return;
+  }
+
+  SegmentationMetrics metrics;
+  m_evaluator->compute(metrics);
+
+  const std::vector<std::string>& classNames {engine->getClassNames()};
+  for (std::size_t c {0}; c < metrics.m_iou.size(); ++c)
+  {
+    if (metrics.m_iou[c] < 0.0)
+      continue;
+    spdlog::debug("SemanticSegmentationBench::evaluateOutput: IoU {:<20} {:.4f}",
+                  classNames[c], metrics.m_iou[c]);
+    m_results.m_metrics.emplace_back("IoU/" + classNames[c], metrics.m_iou[c]);
+  }
+  m_results.m_metrics.emplace_back("mIoU", metrics.m_meanIou);
+  m_results.m_metrics.emplace_back("pixelAccuracy", metrics.m_pixelAccuracy);
+
+  spdlog::info("SemanticSegmentationBench::evaluateOutput: {} frames, {} pixels, {} classes, "
+               "mIoU {:.4f}, pixel accuracy {:.4f}", m_evaluatedFrames, metrics.m_pixels,
+               metrics.m_evaluatedClasses, metrics.m_meanIou, metrics.m_pixelAccuracy);
 }
 
 
@@ -3,11 +3,30 @@
 #include "../engine/tfLite.h"
 #include "../engine/openVino.h"
 #include "../engine/tensorRt.h"
+#include "../engine/onnxRuntime.h"
+#include "../engine/replay.h"
+#include "../engine/null.h"
+#include "../engine/plugin.h"
 #include "../utils/config/config.h"
+#include "../utils/report/report.h"
+#include "../utils/report/compare.h"
+#include "../utils/eval/annotations.h"
+#include "../utils/eval/segmentation.h"
+#include "realtime.h"
+#include "loadGen.h"
+#include "thresholdSweep.h"
+#include "dataset.h"
+#include "server.h"
+#include "frameRing.h"
+#include "scheduler.h"
+#include "hotSwap.h"
 
 class AbsTestBench
 {
 protected:
+  BenchResults m_results;                        /// \var results of the run (memory, metrics)
+  std::size_t m_batchSize {1};                   /// \var frames per closed-loop step
+
   /**
    * @brief evaluates the inference output with the expected results 
    * @param engine pointer to the inference engine   
@@ -22,55 +41,230 @@ protected:
   virtual void runInference(AbsEngine* engine, const cv::Mat& frame) = 0;
 
   /**
-   * @brief creates and returns an inference engine based on the specified type
-   * @param type type of the inference engine
+   * @brief loads the ground truth of the dataset, called once the engine is initialized
+   * @param engine pointer to the inference engine
+   * @param dataset dataset frames and file names
+   * @param config ptr to testbench config
+   * @return true if successful or nothing to evaluate, false otherwise
+   */
+  virtual bool prepareEvaluation(AbsEngine* engine, const Dataset& dataset,
+                                 TestBenchConfig* config) { return true; }
+
+  /**
+   * @brief runs batched inference on the given frames, only called with a batch size above 1
+   * @param engine pointer to the inference engine
+   * @param frames input frames, up to the batch size
+   */
+  virtual void runInferenceBatch(AbsEngine* engine, std::span<const cv::Mat> frames) {}
+
+  /**
+   * @brief accumulates the output of the last inference into the accuracy metrics
+   * @param engine pointer to the inference engine
+   * @param frameIdx dataset index of the frame
+   * @param batchSlot slot of the frame in the last batch, 0 without batching
+   */
+  virtual void accumulateOutput(AbsEngine* engine, std::size_t frameIdx, 
+                                std::size_t batchSlot) {}
+
+  /**
+   * @brief runs one closed-loop step, a single frame or a batch starting at the given frame
+   * (cut at the end of the dataset)
+   * @param engine pointer to the inference engine
+   * @param dataset dataset frames
+   * @param first index of the first frame, wraps around the dataset
+   * @return number of frames run
+   */
+  std::size_t runStep(AbsEngine* engine, const std::vector<cv::Mat>& dataset, std::size_t first);
+
+  /**
+   * @brief runs warm-up frames, either a fixed number or until the rolling coefficient of
+   * variation of the frame latency drops below the configured threshold
+   * @param engine pointer to the inference engine
+   * @param dataset dataset frames, cycled if the warm-up needs more frames
+   * @param config ptr to testbench config
+   * @return true if any warm-up frame was run, false otherwise
+   */
+  bool runWarmup(AbsEngine* engine, const std::vector<cv::Mat>& dataset,
+                 TestBenchConfig* config);
+
+  /**
+   * @brief runs every dataset frame back to back (closed loop) and measures it
+   * @param engine pointer to the inference engine
+   * @param dataset dataset frames
+   * @param warmedUp a warm-up already ran, so the first frame is not a cold one
+   */
+  void runClosedLoop(AbsEngine* engine, const std::vector<cv::Mat>& dataset, bool warmedUp);
+
+  /**
+   * @brief feeds the dataset through a simulated fixed-fps camera and measures deadline
+   * misses, drops, capture-to-result latency and queue depth
+   * @param engine pointer to the inference engine
+   * @param dataset dataset frames
+   * @param config ptr to testbench config
+   * @return true if successful, false otherwise
    */
-  std::unique_ptr<AbsEngine> getEngine(EngineType type);
+  bool runPaced(AbsEngine* engine, const std::vector<cv::Mat>& dataset,
+                TestBenchConfig* config);
 
   /**
-   * @brief loads the test dataset from the specified directory
-   * @param path path to the dataset directory
-   * @return vector of cv::Mat containing the loaded dataset frames
+   * @brief sweeps open-loop offered loads over the configured number of engine instances 
+   * and reports the throughput vs p99 latency curve with its knee point
+   * @param engine initialized engine, used as the first instance
+   * @param dataset dataset frames
+   * @param config ptr to testbench config
+   * @return true if successful, false otherwise
+   */
+  bool runLoadSweep(AbsEngine* engine, const std::vector<cv::Mat>& dataset,
+                    TestBenchConfig* config);
+
+  /**
+   * @brief compares the profiled stages against the configured baseline results file
+   * @param config ptr to testbench config
+   * @return true if no stage regressed significantly, false otherwise
    */
-  std::vector<cv::Mat> loadDataset(const std::string& path);
+  bool compareWithBaseline(TestBenchConfig* config);
 public:
+  /**
+   * @brief creates and returns an inference engine of the configured type, from the
+   * configured plugin or, for engines built as plugins, from the default plugin file
+   * @param config test bench configuration
+   */
+  static std::unique_ptr<AbsEngine> getEngine(const TestBenchConfig& config);
+
   /**
    * @brief runs the benchmark for the given engine type and dataset
    * @param config ptr to testbench config
+   * @param dataset decoded dataset
    * @return true if successful, false otherwise
    */
-  bool runModelBenchmark(TestBenchConfig* config);
+  bool runModelBenchmark(TestBenchConfig* config, const Dataset& dataset);
 
-  ~AbsTestBench() = default;
+  virtual ~AbsTestBench() = default;
 };
 
 class ObjectDetectionBench : public AbsTestBench
 {
+  std::vector<FrameAnnotations> m_annotations;   /// \var ground truth per dataset frame
+  std::unique_ptr<DetectionEvaluator> m_evaluator; /// \var per class match tables
+  std::size_t m_evaluatedFrames {0};             /// \var frames accumulated so far
+  TestBenchConfig* m_config {nullptr};           /// \var ptr to testbench config
+  std::vector<DetectionCandidates> m_candidates; /// \var pre-nms boxes per frame for the sweep
+  std::vector<Box> m_boxes;                      /// \var scratch: detections of a frame
+  std::vector<float> m_scores;                   /// \var scratch: confidences of a frame
+  std::vector<int> m_classes;                    /// \var scratch: classes of a frame
+
   void evaluateOutput(AbsEngine* engine);
   void runInference(AbsEngine* engine, const cv::Mat& frame);
+  void runInferenceBatch(AbsEngine* engine, std::span<const cv::Mat> frames);
+  bool prepareEvaluation(AbsEngine* engine, const Dataset& dataset, TestBenchConfig* config);
+  void accumulateOutput(AbsEngine* engine, std::size_t frameIdx, std::size_t batchSlot);
 };
 
 class SemanticSegmentationBench : public AbsTestBench
 {
+  std::vector<cv::Mat> m_masks;                  /// \var ground truth mask per dataset frame
+  std::unique_ptr<SegmentationEvaluator> m_evaluator; /// \var confusion matrix
+  std::size_t m_evaluatedFrames {0};             /// \var frames accumulated so far
+  cv::Mat m_resizedMask;                         /// \var scratch: output mask at gt size
+
   void evaluateOutput(AbsEngine* engine);
   void runInference(AbsEngine* engine, const cv::Mat& frame);
+  bool prepareEvaluation(AbsEngine* engine, const Dataset& dataset, TestBenchConfig* config);
+  void accumulateOutput(AbsEngine* engine, std::size_t frameIdx, std::size_t batchSlot);
 };
 
 
 class TestBenchFactory
 {
-  TestBenchConfig m_config;                      /// \var test bench configuration
+  std::vector<TestBenchConfig> m_configs;        /// \var one configuration per matrix variant
 
   /**
    * @brief creates and returns a test bench instance based on the specified type
    * @param type type of the test bench
    */
   std::unique_ptr<AbsTestBench> getTestBench(TestBenchType type);
+
+  /**
+   * @brief runs one configuration in this process
+   * @param config test bench configuration
+   * @param dataset decoded dataset
+   * @return true if successful and no regression was found, false otherwise
+   */
+  bool runConfig(TestBenchConfig& config, const Dataset& dataset);
+
+  /**
+   * @brief runs every matrix variant in a forked process, so the memory statistics and the
+   * profiler of a run are not polluted by the previous ones. Each dataset is decoded once,
+   * in a child its variants are forked from, so they share its frames and their peak memory
+   * does not include the datasets of other variants.
+   * @param baselinePath optional baseline results file, see MatrixReport::variantPath
+   * @return true if every variant succeeded, false otherwise
+   */
+  bool runMatrix(const std::string& baselinePath);
+
+  /**
+   * @brief runs the models of the <scheduler> node on one shared worker pool, each with
+   * its own test bench configuration, dataset and core budget, and prints the per-model
+   * accounting
+   * @param config configuration holding the <scheduler> node
+   * @return true if successful, false otherwise
+   */
+  bool runScheduler(const TestBenchConfig& config);
+
+  /**
+   * @brief serves the dataset frames at <hotReload><fps> while the model is reloaded in the
+   * background and swapped in every <intervalSec>, and prints the frame latency around
+   * each swap against the steady state
+   * @param config configuration holding the <hotReload> node
+   * @return true if every reload succeeded and no frame failed, false otherwise
+   */
+  bool runHotReload(const TestBenchConfig& config);
 public:
   /**
    * @brief starts the test bench with the given configuration file
    * @param path path to the test bench configuration file
+   * @param baselinePath optional baseline results file to compare the run against
+   * @return true if successful and no regression was found, false otherwise
+   */
+  bool start(const std::string& path, const std::string& baselinePath = {});
+
+  /**
+   * @brief serves the configured object detection engine on a Unix domain socket until
+   * SIGINT or SIGTERM, then prints the per-request latencies. SIGHUP reloads the model of
+   * the configuration file without stopping.
+   * @param path path to the test bench configuration file, the <serve> node sets batching
+   * @param socketPath path of the socket file
+   * @return true if successful, false otherwise
+   */
+  bool serve(const std::string& path, const std::string& socketPath);
+
+  /**
+   * @brief sends the dataset frames to a running server with the open-loop arrival process
+   * of the <loadSweep> node, one connection per configured instance
+   * @param path path to the test bench configuration file
+   * @param socketPath path of the socket file
+   * @return true if every request was answered, false otherwise
+   */
+  bool runClient(const std::string& path, const std::string& socketPath);
+
+  /**
+   * @brief creates the shared-memory frame ring of the <frameRing> node and fills it like a
+   * capture process, with the dataset frames scaled to the ring geometry (flat frames
+   * without a dataset), until SIGINT or SIGTERM. Prints the capture to result latency of
+   * the results the consumers send back.
+   * @param path path to the test bench configuration file
+   * @param ringName shm object name of the ring
+   * @return true if successful, false otherwise
+   */
+  bool produce(const std::string& path, const std::string& ringName);
+
+  /**
+   * @brief runs the configured object detection engine on the newest frames of a running
+   * producer's ring, reading them in place, and sends the detections back through the
+   * results ring until SIGINT or SIGTERM
+   * @param path path to the test bench configuration file
+   * @param ringName shm object name of the ring
    * @return true if successful, false otherwise
    */
-  bool start(const std::string& path);
+  bool consume(const std::string& path, const std::string& ringName);
 };
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "thresholdSweep.h"
+
+#include <spdlog/spdlog.h>
+#include <spdlog/fmt/fmt.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+void detectionsToBoxes(const DetectedObjects& detections, std::vector<Box>& boxes,
+                       std::vector<float>& scores, std::vector<int>& classes)
+{
+  boxes.clear();
+  scores.clear();
+  classes.clear();
+  for (std::size_t i {0}; i < detections.m_classProbabilities.size(); ++i)
+  {
+    boxes.push_back({static_cast<float>(detections.m_firstPoints[i].x),
+                     static_cast<float>(detections.m_firstPoints[i].y),
+                     static_cast<float>(detections.m_secondPoints[i].x),
+                     static_cast<float>(detections.m_secondPoints[i].y)});
+    scores.push_back(detections.m_classProbabilities[i]);
+    classes.push_back(static_cast<int>(detections.m_classNameIdxs[i]));
+  }
+}
+
+namespace
+{
+/**
+ * @brief runs one setting over every recorded frame
+ * @param evaluator accumulates the metrics, nullptr to only measure the nms time
+ * @return total nms time in ms
+ */
+double evaluateSetting(const std::vector<DetectionCandidates>& candidates,
+                       const std::vector<FrameAnnotations>& annotations, float confidence,
+                       float iou, DetectionEvaluator* evaluator, std::uint64_t& numDetections)
+{
+  DetectedObjects detections;
+  std::vector<Box> boxes;
+  std::vector<float> scores;
+  std::vector<int> classes;
+  std::chrono::steady_clock::duration nmsTime {0};
+  numDetections = 0;
+  for (std::size_t i {0}; i < candidates.size(); ++i)
+  {
+    const auto start {std::chrono::steady_clock::now()};
+    AbsEngine::applyNms(candidates[i], confidence, iou, detections);
+    nmsTime += std::chrono::steady_clock::now() - start;
+
+    numDetections += detections.m_classProbabilities.size();
+    if (evaluator == nullptr)
+      continue;
+    detectionsToBoxes(detections, boxes, scores, classes);
+    evaluator->addFrame(boxes, scores, classes, annotations[i]);
+  }
+  return std::chrono::duration<double, std::milli>(nmsTime).count();
+}
+}
+
+void ThresholdSweep::run(const TestBenchConfig& config,
+                         const std::vector<DetectionCandidates>& candidates,
+                         const std::vector<FrameAnnotations>& annotations, std::size_t numClasses,
+                         double frameMs, std::vector<ThresholdPoint>& points)
+{
+  const ThresholdSweepConfig& sweep {config.m_thresholdSweep};
+  points.clear();
+  for (float confidence : sweep.m_confidences)
+    for (float iou : sweep.m_ious)
+      points.push_back({confidence, iou});
+  if (candidates.empty() || points.empty())
+    return;
+
+  // the measured frame latency already contains the nms of the configured thresholds
+  std::uint64_t numDetections {0};
+  const double frames {static_cast<double>(candidates.size())};
+  const double configuredNmsMs {evaluateSetting(candidates, annotations,
+    config.m_confidenceThreshold, config.m_iouThreshold, nullptr, numDetections) / frames};
+  const double baseFrameMs {std::max(frameMs - configuredNmsMs, 0.0)};
+
+  std::atomic<std::size_t> next {0};
+  auto worker = [&] {
+    for (std::size_t p {next++}; p < points.size(); p = next++)
+    {
+      ThresholdPoint& point {points[p]};
+      DetectionEvaluator evaluator {numClasses};
+      std::uint64_t detections {0};
+      point.m_nmsMs = evaluateSetting(candidates, annotations, point.m_confidence, point.m_iou,
+                                      &evaluator, detections) / frames;
+      point.m_frameMs = baseFrameMs + point.m_nmsMs;
+      point.m_detectionsPerFrame = static_cast<double>(detections) / frames;
+
+      DetectionMetrics metrics;
+      evaluator.compute(metrics);
+      point.m_map50 = metrics.m_map50;
+      point.m_map5095 = metrics.m_map5095;
+    }
+  };
+  const std::size_t numThreads {std::clamp<std::size_t>(
+    std::thread::hardware_concurrency(), 1, points.size())};
+  std::vector<std::thread> threads;
+  for (std::size_t i {1}; i < numThreads; ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (std::thread& thread : threads)
+    thread.join();
+
+  spdlog::info("ThresholdSweep::run: {} settings on {} frames, candidates kept above {:.3f}",
+               points.size(), candidates.size(),
+               std::min(config.m_confidenceThreshold, sweep.m_confidences.front()));
+}
+
+void ThresholdSweep::printTable(const std::vector<ThresholdPoint>& points)
+{
+  std::cout << "--- Threshold Sweep ---\n";
+  std::cout << fmt::format("{:>6} {:>6} {:>8} {:>10} {:>10} {:>8} {:>10}\n", "conf", "iou",
+                           "mAP50", "mAP50:95", "dets/frame", "nms ms", "frame ms");
+  for (const ThresholdPoint& point : points)
+  {
+    std::cout << fmt::format("{:>6.2f} {:>6.2f} {:>8.4f} {:>10.4f} {:>10.1f} {:>8.3f} {:>10.2f}\n",
+                             point.m_confidence, point.m_iou, point.m_map50, point.m_map5095,
+                             point.m_detectionsPerFrame, point.m_nmsMs, point.m_frameMs);
+  }
+}
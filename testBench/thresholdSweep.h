@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../engine/base.h"
+#include "../utils/config/config.h"
+#include "../utils/eval/detection.h"
+#include "../utils/report/report.h"
+
+#include <vector>
+
+/**
+ * @brief converts engine detections into the evaluator input
+ * @param detections engine detections
+ * @param boxes output boxes
+ * @param scores output confidences
+ * @param classes output class indices
+ */
+void detectionsToBoxes(const DetectedObjects& detections, std::vector<Box>& boxes,
+                       std::vector<float>& scores, std::vector<int>& classes);
+
+/**
+ * @brief ThresholdSweep evaluates every confidence/IoU setting on the pre-NMS candidates
+ * recorded during one inference pass, instead of rerunning inference per setting
+ */
+struct ThresholdSweep
+{
+  /**
+   * @brief evaluates the configured grid, settings are evaluated in parallel. The frame
+   * latency of a setting is estimated as the measured frame latency with the NMS time of
+   * the configured thresholds replaced by the NMS time of the setting.
+   * @param config test bench configuration
+   * @param candidates recorded candidates per frame, decoded at the lowest confidence
+   * @param annotations ground truth per frame
+   * @param numClasses number of classes
+   * @param frameMs measured mean frame latency with the configured thresholds
+   * @param points output sweep table, confidence major
+   */
+  static void run(const TestBenchConfig& config,
+                  const std::vector<DetectionCandidates>& candidates,
+                  const std::vector<FrameAnnotations>& annotations, std::size_t numClasses,
+                  double frameMs, std::vector<ThresholdPoint>& points);
+
+  /**
+   * @brief prints the latency vs accuracy table
+   * @param points sweep table
+   */
+  static void printTable(const std::vector<ThresholdPoint>& points);
+};
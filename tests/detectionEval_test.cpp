@@ -0,0 +1,84 @@
+#include "../utils/eval/detection.h"
+#include "gtest/gtest.h"
+
+/* unit testing for the COCO-style detection metrics */
+
+namespace
+{
+FrameAnnotations makeGroundTruth(const std::vector<Box>& boxes, const std::vector<int>& classes,
+                                 const std::vector<bool>& crowd)
+{
+  FrameAnnotations groundTruth;
+  groundTruth.m_boxes = boxes;
+  groundTruth.m_classes = classes;
+  groundTruth.m_crowd = crowd;
+  return groundTruth;
+}
+}
+
+TEST(DetectionEvalTest, PerfectDetectionsScoreOne)
+{
+  DetectionEvaluator evaluator {2};
+  const FrameAnnotations groundTruth {makeGroundTruth(
+    {{0, 0, 100, 100}, {200, 200, 250, 260}}, {0, 1}, {false, false})};
+  evaluator.addFrame(groundTruth.m_boxes, {0.9f, 0.8f}, {0, 1}, groundTruth);
+
+  DetectionMetrics metrics;
+  evaluator.compute(metrics);
+  EXPECT_EQ(metrics.m_evaluatedClasses, 2);
+  EXPECT_DOUBLE_EQ(metrics.m_map50, 1.0);
+  EXPECT_DOUBLE_EQ(metrics.m_map5095, 1.0);
+}
+
+TEST(DetectionEvalTest, HigherScoredFalsePositiveHalvesPrecision)
+{
+  DetectionEvaluator evaluator {1};
+  const FrameAnnotations groundTruth {makeGroundTruth({{0, 0, 100, 100}}, {0}, {false})};
+  evaluator.addFrame({{300, 300, 400, 400}, {0, 0, 100, 100}}, {0.9f, 0.5f}, {0, 0},
+                     groundTruth);
+
+  DetectionMetrics metrics;
+  evaluator.compute(metrics);
+  EXPECT_NEAR(metrics.m_map50, 0.5, 1e-9);
+}
+
+TEST(DetectionEvalTest, LooseBoxOnlyCountsAtLowIouThresholds)
+{
+  DetectionEvaluator evaluator {1};
+  const FrameAnnotations groundTruth {makeGroundTruth({{0, 0, 100, 100}}, {0}, {false})};
+  evaluator.addFrame({{0, 0, 100, 62}}, {0.9f}, {0}, groundTruth);
+
+  // iou 0.62 passes 0.50, 0.55 and 0.60
+  DetectionMetrics metrics;
+  evaluator.compute(metrics);
+  EXPECT_DOUBLE_EQ(metrics.m_map50, 1.0);
+  EXPECT_DOUBLE_EQ(metrics.m_map75, 0.0);
+  EXPECT_NEAR(metrics.m_map5095, 0.3, 1e-9);
+}
+
+TEST(DetectionEvalTest, CrowdRegionsAndEmptyClassesAreIgnored)
+{
+  DetectionEvaluator evaluator {2};
+  const FrameAnnotations groundTruth {makeGroundTruth(
+    {{0, 0, 100, 100}, {200, 200, 400, 400}}, {0, 0}, {false, true})};
+  evaluator.addFrame({{250, 250, 300, 300}, {0, 0, 100, 100}}, {0.9f, 0.5f}, {0, 0},
+                     groundTruth);
+
+  DetectionMetrics metrics;
+  evaluator.compute(metrics);
+  EXPECT_EQ(metrics.m_evaluatedClasses, 1);
+  EXPECT_DOUBLE_EQ(metrics.m_ap5095[1], -1.0);
+  EXPECT_DOUBLE_EQ(metrics.m_map5095, 1.0);
+}
+
+TEST(DetectionEvalTest, AccumulatesAcrossFrames)
+{
+  DetectionEvaluator evaluator {1};
+  const FrameAnnotations groundTruth {makeGroundTruth({{0, 0, 100, 100}}, {0}, {false})};
+  evaluator.addFrame({{0, 0, 100, 100}}, {0.9f}, {0}, groundTruth);
+  evaluator.addFrame({}, {}, {}, groundTruth);  // missed object
+
+  DetectionMetrics metrics;
+  evaluator.compute(metrics);
+  EXPECT_NEAR(metrics.m_map50, 51.0 / 101.0, 1e-9);
+}
@@ -0,0 +1,24 @@
+#include "../engine/plugin.h"
+#include "gtest/gtest.h"
+
+/* unit testing for loading engines from plugins */
+
+TEST(EnginePluginTest, CreatesEnginesOfTheServedType)
+{
+  std::unique_ptr<AbsEngine> first {EnginePlugin::create(TEST_ENGINE_PLUGIN, 
+                                                         EngineType::NULL_ENGINE)};
+  ASSERT_NE(first, nullptr);
+  EXPECT_TRUE(first->runObjectDetection(cv::Mat{}));
+
+  // the plugin is loaded once, every further engine comes from the same mapping
+  std::unique_ptr<AbsEngine> second {EnginePlugin::create(TEST_ENGINE_PLUGIN, 
+                                                          EngineType::NULL_ENGINE)};
+  EXPECT_NE(second, nullptr);
+}
+
+TEST(EnginePluginTest, RejectsOtherTypesAndMissingFiles)
+{
+  EXPECT_EQ(EnginePlugin::create(TEST_ENGINE_PLUGIN, EngineType::TFLITE), nullptr);
+  EXPECT_EQ(EnginePlugin::create("/nonexistent/libedge_engine_null.so", 
+                                 EngineType::NULL_ENGINE), nullptr);
+}
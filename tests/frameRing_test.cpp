@@ -0,0 +1,119 @@
+#include "../testBench/frameRing.h"
+#include "gtest/gtest.h"
+
+#include <unistd.h>
+
+/* unit testing for the shared-memory frame ring, producer and consumers map it separately */
+
+namespace
+{
+std::string ringName(const char* name)
+{
+  return "/" + std::string(name) + "_" + std::to_string(getpid());
+}
+
+FrameRingConfig ringConfig(int slots)
+{
+  FrameRingConfig config;
+  config.m_width = 32;
+  config.m_height = 16;
+  config.m_slots = slots;
+  config.m_resultSlots = 2;
+  return config;
+}
+
+void publishFrame(FrameRing& ring, int value)
+{
+  cv::Mat slot {ring.beginWrite()};
+  ASSERT_FALSE(slot.empty());
+  slot.setTo(cv::Scalar(value, value, value));
+  ring.publish(FrameRing::nowNs());
+}
+}
+
+TEST(FrameRingTest, DeliversTheNewestFrameInPlace)
+{
+  const std::string name {ringName("frame_ring_newest")};
+  FrameRing producer;
+  ASSERT_TRUE(producer.create(name, ringConfig(4)));
+  FrameRing consumer;
+  ASSERT_TRUE(consumer.open(name));
+
+  FrameLease lease;
+  EXPECT_FALSE(consumer.acquire(lease, 0));
+  for (int value : {1, 2, 3})
+    publishFrame(producer, value);
+  ASSERT_TRUE(consumer.acquire(lease, 0));
+  EXPECT_EQ(lease.m_sequence, 3u);
+  EXPECT_EQ(lease.m_frame.size(), cv::Size(32, 16));
+  EXPECT_EQ(lease.m_frame.at<cv::Vec3b>(15, 31), cv::Vec3b(3, 3, 3));
+  consumer.release(lease);
+
+  // a frame is only delivered once, slower consumers skip to the newest one
+  EXPECT_FALSE(consumer.acquire(lease, 0));
+  publishFrame(producer, 4);
+  publishFrame(producer, 5);
+  ASSERT_TRUE(consumer.acquire(lease, 10));
+  EXPECT_EQ(lease.m_sequence, 5u);
+  EXPECT_EQ(consumer.skippedFrames(), 1u);
+  consumer.release(lease);
+}
+
+TEST(FrameRingTest, NeverOverwritesPinnedSlots)
+{
+  const std::string name {ringName("frame_ring_pinned")};
+  FrameRing producer;
+  ASSERT_TRUE(producer.create(name, ringConfig(2)));
+  FrameRing first;
+  FrameRing second;
+  ASSERT_TRUE(first.open(name));
+  ASSERT_TRUE(second.open(name));
+
+  FrameLease firstLease;
+  FrameLease secondLease;
+  publishFrame(producer, 1);
+  ASSERT_TRUE(first.acquire(firstLease, 0));
+  publishFrame(producer, 2);
+  ASSERT_TRUE(second.acquire(secondLease, 0));
+
+  // both slots are pinned, the producer has to wait instead of tearing a frame
+  EXPECT_TRUE(producer.beginWrite().empty());
+  EXPECT_EQ(firstLease.m_frame.at<cv::Vec3b>(0, 0), cv::Vec3b(1, 1, 1));
+  first.release(firstLease);
+  publishFrame(producer, 3);
+  EXPECT_EQ(secondLease.m_frame.at<cv::Vec3b>(0, 0), cv::Vec3b(2, 2, 2));
+  second.release(secondLease);
+}
+
+TEST(FrameRingTest, ReturnsResultsInOrderAndDropsOnAFullRing)
+{
+  const std::string name {ringName("frame_ring_results")};
+  FrameRing producer;
+  ASSERT_TRUE(producer.create(name, ringConfig(2)));
+  FrameRing consumer;
+  ASSERT_TRUE(consumer.open(name));
+
+  FrameResult result;
+  for (std::uint64_t sequence : {1, 2})
+  {
+    result.m_sequence = sequence;
+    EXPECT_TRUE(consumer.pushResult(result));
+  }
+  result.m_sequence = 3;
+  EXPECT_FALSE(consumer.pushResult(result));
+  EXPECT_EQ(producer.droppedResults(), 1u);
+
+  for (std::uint64_t sequence : {1, 2})
+  {
+    ASSERT_TRUE(producer.popResult(result, 0));
+    EXPECT_EQ(result.m_sequence, sequence);
+    EXPECT_EQ(result.m_consumer, consumer.consumer());
+  }
+  EXPECT_FALSE(producer.popResult(result, 1));
+}
+
+TEST(FrameRingTest, RejectsMissingRings)
+{
+  FrameRing consumer;
+  EXPECT_FALSE(consumer.open(ringName("frame_ring_missing")));
+}
@@ -0,0 +1,76 @@
+#include "../engine/null.h"
+#include "../testBench/hotSwap.h"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <future>
+#include <thread>
+
+/* unit testing for the hot swap engine slot, the engines are only compared, never run */
+
+namespace
+{
+void waitForVersion(const HotSwapEngine& slot, std::uint64_t version)
+{
+  const auto deadline {std::chrono::steady_clock::now() + std::chrono::seconds(5)};
+  while (slot.version() < version && std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+}
+
+TEST(HotSwapTest, FreesTheOldEngineAfterItsLastFrame)
+{
+  HotSwapEngine slot {std::make_shared<EngineNull>()};
+  std::shared_ptr<AbsEngine> inFlight {slot.acquire()};
+  std::weak_ptr<AbsEngine> old {inFlight};
+  const std::shared_ptr<AbsEngine> next {std::make_shared<EngineNull>()};
+  AbsEngine* nextEngine {next.get()};
+
+  ASSERT_TRUE(slot.reload([next] { return next; }));
+  waitForVersion(slot, 1);
+  ASSERT_EQ(slot.version(), 1u);
+  EXPECT_EQ(slot.acquire().get(), nextEngine);
+
+  // the frame started before the swap still runs on the old engine
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  EXPECT_FALSE(old.expired());
+  EXPECT_TRUE(slot.events().empty());
+  inFlight.reset();
+  slot.wait();
+  EXPECT_TRUE(old.expired());
+
+  const std::vector<ReloadEvent> events {slot.events()};
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_TRUE(events.front().m_succeeded);
+  EXPECT_LE(events.front().m_requestNs, events.front().m_swapNs);
+  EXPECT_LE(events.front().m_swapNs, events.front().m_freedNs);
+}
+
+TEST(HotSwapTest, KeepsServingWhenTheBuildFails)
+{
+  HotSwapEngine slot {std::make_shared<EngineNull>()};
+  AbsEngine* serving {slot.acquire().get()};
+
+  ASSERT_TRUE(slot.reload([] { return std::shared_ptr<AbsEngine>(); }));
+  slot.wait();
+  EXPECT_EQ(slot.version(), 0u);
+  EXPECT_EQ(slot.acquire().get(), serving);
+  ASSERT_EQ(slot.events().size(), 1u);
+  EXPECT_FALSE(slot.events().front().m_succeeded);
+}
+
+TEST(HotSwapTest, RejectsAReloadWhileOneIsRunning)
+{
+  HotSwapEngine slot {std::make_shared<EngineNull>()};
+  std::promise<void> built;
+  std::shared_future<void> release {built.get_future().share()};
+
+  ASSERT_TRUE(slot.reload([release] {
+    release.wait();
+    return std::shared_ptr<AbsEngine>(std::make_shared<EngineNull>()); }));
+  EXPECT_FALSE(slot.reload([] { return std::shared_ptr<AbsEngine>(); }));
+  built.set_value();
+  slot.wait();
+  EXPECT_EQ(slot.version(), 1u);
+  EXPECT_TRUE(slot.reload([] { return std::shared_ptr<AbsEngine>(); }));
+}
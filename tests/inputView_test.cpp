@@ -0,0 +1,132 @@
+#include "../engine/null.h"
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+/* unit testing for the preprocessing into the input views engines read from */
+
+namespace
+{
+constexpr int kWidth {4};
+constexpr int kHeight {3};
+constexpr std::uint8_t kPadding {0xab};
+
+// uniform frame, resizing keeps every pixel at (10, 20, 30)
+cv::Mat bgrFrame()
+{
+  return cv::Mat(12, 16, CV_8UC3, cv::Scalar(10, 20, 30));
+}
+
+float expected(int depth, int channel)
+{
+  const float value {10.0f * static_cast<float>(channel + 1)};
+  return depth == CV_8U ? value : value / 255.0f;
+}
+
+float element(const std::uint8_t* data, int depth)
+{
+  if (depth == CV_8U)
+    return *data;
+  float value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+/**
+ * @brief preprocesses the frame into a view with padded rows (and planes), checks every
+ * element and that the padding is left alone
+ */
+void checkView(int depth, bool planar)
+{
+  const std::size_t elementSize {depth == CV_8U ? sizeof(std::uint8_t) : sizeof(float)};
+  const std::size_t rowBytes {kWidth * elementSize * (planar ? 1 : 3)};
+  const std::size_t rowStep {rowBytes + 8};
+  const std::size_t planeStep {planar ? rowStep * kHeight + 16 : 0};
+  std::vector<std::uint8_t> buffer(planar ? planeStep * 3 : rowStep * kHeight, kPadding);
+
+  const InputView view {buffer.data(), kWidth, kHeight, 3, depth, rowStep, planeStep};
+  cv::Mat resized;
+  cv::Mat plane;
+  AbsEngine::preprocess(bgrFrame(), view, resized, plane);
+
+  for (int c {0}; c < 3; ++c)
+  {
+    for (int y {0}; y < kHeight; ++y)
+    {
+      const std::uint8_t* row {buffer.data() + (planar ? c * planeStep : 0) + y * rowStep};
+      for (int x {0}; x < kWidth; ++x)
+      {
+        const std::size_t offset {(planar ? x : x * 3 + c) * elementSize};
+        EXPECT_FLOAT_EQ(element(row + offset, depth), expected(depth, c))
+          << "channel " << c << " at " << x << "," << y;
+      }
+      EXPECT_EQ(row[rowBytes], kPadding);
+    }
+    if (planar)
+    {
+      EXPECT_EQ(buffer[c * planeStep + rowStep * kHeight], kPadding);
+    }
+  }
+}
+
+TestBenchConfig nullConfig()
+{
+  const std::string classesPath {
+    (std::filesystem::temp_directory_path() / "input_view_classes.txt").string()};
+  std::ofstream classes(classesPath);
+  for (int i {0}; i < 80; ++i)
+    classes << "class" << i << '\n';
+
+  TestBenchConfig config;
+  config.m_benchType = TestBenchType::OBJECT_DETECTION;
+  config.m_engineType = EngineType::NULL_ENGINE;
+  config.m_classNamesPath = classesPath;
+  config.m_arch = ModelArch::YOLO10;
+  config.m_nullEngine.m_width = kWidth;
+  config.m_nullEngine.m_height = kHeight;
+  return config;
+}
+}
+
+TEST(InputViewTest, FillsInterleavedPixels)
+{
+  checkView(CV_8U, false);
+}
+
+TEST(InputViewTest, FillsInterleavedFloats)
+{
+  checkView(CV_32F, false);
+}
+
+TEST(InputViewTest, FillsPlanarPixels)
+{
+  checkView(CV_8U, true);
+}
+
+TEST(InputViewTest, FillsPlanarFloats)
+{
+  checkView(CV_32F, true);
+}
+
+TEST(InputViewTest, ReadsFromABoundBuffer)
+{
+  TestBenchConfig config {nullConfig()};
+  EngineNull engine;
+  ASSERT_TRUE(engine.init(&config));
+
+  std::vector<float> input(kWidth * kHeight * 3, -1.0f);
+  const std::size_t bytes {input.size() * sizeof(float)};
+  EXPECT_FALSE(engine.bindInputBuffer(input.data(), bytes - 1));
+  ASSERT_TRUE(engine.bindInputBuffer(input.data(), bytes));
+  ASSERT_TRUE(engine.runObjectDetection(bgrFrame()));
+  for (std::size_t i {0}; i < input.size(); ++i)
+    EXPECT_FLOAT_EQ(input[i], expected(CV_32F, static_cast<int>(i % 3)));
+
+  // back on the engine owned buffer the caller's one is no longer written
+  ASSERT_TRUE(engine.bindInputBuffer(nullptr, 0));
+  std::fill(input.begin(), input.end(), -1.0f);
+  ASSERT_TRUE(engine.runObjectDetection(bgrFrame()));
+  EXPECT_EQ(input.front(), -1.0f);
+}
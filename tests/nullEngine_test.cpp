@@ -0,0 +1,70 @@
+#include "../engine/null.h"
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <fstream>
+
+/* unit testing for the synthetic outputs of the null engine */
+
+namespace
+{
+TestBenchConfig nullConfig(ModelArch arch, int candidates)
+{
+  const std::string classesPath {
+    (std::filesystem::temp_directory_path() / "null_engine_classes.txt").string()};
+  std::ofstream classes(classesPath);
+  for (int i {0}; i < 80; ++i)
+    classes << "class" << i << '\n';
+
+  TestBenchConfig config;
+  config.m_benchType = TestBenchType::OBJECT_DETECTION;
+  config.m_engineType = EngineType::NULL_ENGINE;
+  config.m_classNamesPath = classesPath;
+  config.m_confidenceThreshold = 0.5f;
+  config.m_iouThreshold = 0.5f;
+  config.m_arch = arch;
+  config.m_nullEngine.m_width = 320;
+  config.m_nullEngine.m_height = 320;
+  config.m_nullEngine.m_candidates = candidates;
+  return config;
+}
+}
+
+TEST(EngineNullTest, DecodesTheConfiguredCandidates)
+{
+  const cv::Mat frame(480, 640, CV_8UC3, cv::Scalar(0, 0, 0));
+  for (const ModelArch arch : {ModelArch::YOLO5, ModelArch::YOLOV8, ModelArch::YOLO10,
+                               ModelArch::SSD})
+  {
+    TestBenchConfig config {nullConfig(arch, 25)};
+    EngineNull engine;
+    ASSERT_TRUE(engine.init(&config));
+    ASSERT_TRUE(engine.runObjectDetection(frame));
+    EXPECT_EQ(engine.getCandidates().m_boxes.size(), 25u) << modelArchToString(arch);
+    EXPECT_GT(engine.getDetections().m_classNameIdxs.size(), 0u);
+    EXPECT_LE(engine.getDetections().m_classNameIdxs.size(), 25u);
+  }
+}
+
+TEST(EngineNullTest, NmsFreeOutputsKeepEveryCandidate)
+{
+  TestBenchConfig config {nullConfig(ModelArch::YOLO10, 40)};
+  config.m_nullEngine.m_boxes = 100;
+  EngineNull engine;
+  ASSERT_TRUE(engine.init(&config));
+  ASSERT_TRUE(engine.runObjectDetection(cv::Mat(240, 320, CV_8UC3, cv::Scalar(0, 0, 0))));
+  EXPECT_EQ(engine.getDetections().m_classNameIdxs.size(), 40u);
+}
+
+TEST(EngineNullTest, RejectsDenseOutputsWithFewerBoxesThanRowValues)
+{
+  // 50 boxes of 84 values would be decoded as 84 boxes of 50 values
+  TestBenchConfig config {nullConfig(ModelArch::YOLOV8, 10)};
+  config.m_nullEngine.m_boxes = 50;
+  EngineNull engine;
+  EXPECT_FALSE(engine.init(&config));
+
+  config.m_nullEngine.m_boxes = 85;
+  EngineNull larger;
+  EXPECT_TRUE(larger.init(&config));
+}
@@ -0,0 +1,90 @@
+#include "../utils/recorder/recorder.h"
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <numeric>
+
+/* unit testing for the raw output tensor recording */
+
+namespace
+{
+std::string recordingPath(const char* name)
+{
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+}
+
+TEST(RecorderTest, ReplaysRecordedTensors)
+{
+  const std::string path {recordingPath("recorder_test.eirt")};
+  std::vector<float> tensor(1 * 7 * 85);
+  {
+    TensorRecorder recorder;
+    ASSERT_TRUE(recorder.open(path, 0, 1, 2));
+    for (int frame {0}; frame < 5; ++frame)
+    {
+      std::iota(tensor.begin(), tensor.end(), static_cast<float>(frame));
+      TensorRecordHeader header;
+      header.m_payloadBytes = tensor.size() * sizeof(float);
+      header.m_frameWidth = 640 + frame;
+      header.m_frameHeight = 480;
+      header.m_rank = 3;
+      header.m_dims[0] = 1;
+      header.m_dims[1] = 7;
+      header.m_dims[2] = 85;
+      recorder.record(header, tensor.data());
+    }
+    EXPECT_TRUE(recorder.close());
+    EXPECT_EQ(recorder.numFrames(), 5u);
+  }
+
+  TensorRecording recording;
+  ASSERT_TRUE(recording.open(path));
+  EXPECT_EQ(recording.fileHeader().m_arch, 1u);
+  ASSERT_EQ(recording.numFrames(), 5u);
+  for (std::size_t frame {0}; frame < recording.numFrames(); ++frame)
+  {
+    const TensorRecordHeader& header {recording.header(frame)};
+    EXPECT_EQ(header.m_sequence, frame);
+    EXPECT_EQ(header.m_frameWidth, 640 + static_cast<int>(frame));
+    EXPECT_EQ(header.m_dims[2], 85);
+
+    const float* data {static_cast<const float*>(recording.payload(frame))};
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(data) % kRecordAlignment, 0u);
+    EXPECT_FLOAT_EQ(data[0], static_cast<float>(frame));
+    EXPECT_FLOAT_EQ(data[tensor.size() - 1], static_cast<float>(frame + tensor.size() - 1));
+  }
+  std::filesystem::remove(path);
+}
+
+TEST(RecorderTest, GroupsOutputsAndDropsTruncatedFrames)
+{
+  const std::string path {recordingPath("recorder_outputs_test.eirt")};
+  const std::vector<float> tensor(16, 1.0f);
+  {
+    TensorRecorder recorder;
+    ASSERT_TRUE(recorder.open(path, 0, 0));
+    for (int frame {0}; frame < 2; ++frame)
+    {
+      for (std::uint8_t output {0}; output < 3; ++output)
+      {
+        TensorRecordHeader header;
+        header.m_payloadBytes = (output + 1) * 4 * sizeof(float);
+        header.m_outputIdx = output;
+        header.m_numOutputs = 3;
+        recorder.record(header, tensor.data());
+      }
+    }
+    EXPECT_EQ(recorder.numFrames(), 2u);
+  }
+
+  // cut into the last record, as an interrupted run would
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+  TensorRecording recording;
+  ASSERT_TRUE(recording.open(path));
+  ASSERT_EQ(recording.numFrames(), 1u);
+  EXPECT_EQ(recording.numOutputs(0), 3u);
+  EXPECT_EQ(recording.header(0, 2).m_payloadBytes, 12 * sizeof(float));
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,199 @@
+#include "../engine/null.h"
+#include "../testBench/scheduler.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+
+/* unit testing for the multi-model scheduler, the invokes record the order they ran in */
+
+namespace
+{
+TestBenchConfig nullConfig()
+{
+  const std::string classesPath {
+    (std::filesystem::temp_directory_path() / "scheduler_classes.txt").string()};
+  std::ofstream classes(classesPath);
+  for (int i {0}; i < 80; ++i)
+    classes << "class" << i << '\n';
+  classes.close();
+
+  TestBenchConfig config;
+  config.m_benchType = TestBenchType::OBJECT_DETECTION;
+  config.m_engineType = EngineType::NULL_ENGINE;
+  config.m_classNamesPath = classesPath;
+  config.m_arch = ModelArch::YOLO10;
+  config.m_nullEngine.m_width = 64;
+  config.m_nullEngine.m_height = 64;
+  return config;
+}
+
+// engines keep a pointer to their config, it has to outlive every scheduler of the tests
+std::vector<std::unique_ptr<AbsEngine>> nullEngines(int count)
+{
+  static TestBenchConfig config {nullConfig()};
+  std::vector<std::unique_ptr<AbsEngine>> engines;
+  for (int i {0}; i < count; ++i)
+  {
+    engines.push_back(std::make_unique<EngineNull>());
+    EXPECT_TRUE(engines.back()->init(&config));
+  }
+  return engines;
+}
+
+SchedulerModelConfig modelConfig(const char* name, float priority, float deadlineMs)
+{
+  SchedulerModelConfig config;
+  config.m_name = name;
+  config.m_priority = priority;
+  config.m_deadlineMs = deadlineMs;
+  config.m_queueSize = 8;
+  return config;
+}
+
+std::vector<cv::Mat> frames()
+{
+  return {cv::Mat(48, 64, CV_8UC3, cv::Scalar(0, 0, 0))};
+}
+}
+
+TEST(SchedulerTest, SharesTheWorkersByPriority)
+{
+  std::vector<int> order;
+  bool warmedUp {false};
+  auto invoke = [&order, &warmedUp](int model) {
+    return [&order, &warmedUp, model](AbsEngine* engine, const cv::Mat& frame) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      if (warmedUp)
+        order.push_back(model);
+      return engine->runObjectDetection(frame);
+    };
+  };
+
+  ModelScheduler scheduler {SchedulingPolicy::WFQ, 1};
+  ASSERT_TRUE(scheduler.addModel(modelConfig("detector", 2.0f, 0.0f), nullEngines(1),
+                                 invoke(0), frames()));
+  ASSERT_TRUE(scheduler.addModel(modelConfig("segmenter", 1.0f, 0.0f), nullEngines(1),
+                                 invoke(1), frames()));
+  warmedUp = true;
+  for (int i {0}; i < 6; ++i)
+  {
+    EXPECT_TRUE(scheduler.submit(0, frames().front()));
+    EXPECT_TRUE(scheduler.submit(1, frames().front()));
+  }
+  scheduler.start();
+  scheduler.stop();
+
+  // twice the priority gets twice the invokes while both models are backlogged
+  ASSERT_EQ(order.size(), 12u);
+  EXPECT_EQ(std::count(order.begin(), order.begin() + 6, 0), 4);
+  EXPECT_EQ(scheduler.metrics(0).m_completed, 6u);
+  EXPECT_EQ(scheduler.metrics(1).m_completed, 6u);
+}
+
+TEST(SchedulerTest, DroppedRequestsCostNoShare)
+{
+  std::vector<int> order;
+  bool warmedUp {false};
+  auto invoke = [&order, &warmedUp](int model) {
+    return [&order, &warmedUp, model](AbsEngine* engine, const cv::Mat& frame) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      if (warmedUp)
+        order.push_back(model);
+      return engine->runObjectDetection(frame);
+    };
+  };
+
+  SchedulerModelConfig flooding {modelConfig("flooding", 1.0f, 0.0f)};
+  SchedulerModelConfig paced {modelConfig("paced", 1.0f, 0.0f)};
+  flooding.m_queueSize = 4;
+  paced.m_queueSize = 4;
+  ModelScheduler scheduler {SchedulingPolicy::WFQ, 1};
+  ASSERT_TRUE(scheduler.addModel(flooding, nullEngines(1), invoke(0), frames()));
+  ASSERT_TRUE(scheduler.addModel(paced, nullEngines(1), invoke(1), frames()));
+  warmedUp = true;
+  for (int i {0}; i < 20; ++i)
+    scheduler.submit(0, frames().front());
+  for (int i {0}; i < 4; ++i)
+    EXPECT_TRUE(scheduler.submit(1, frames().front()));
+  scheduler.start();
+  scheduler.stop();
+
+  // the 16 requests the full queue dropped must not push the flooding model back
+  ASSERT_EQ(order.size(), 8u);
+  EXPECT_EQ(std::count(order.begin(), order.begin() + 4, 0), 2);
+  EXPECT_EQ(scheduler.metrics(0).m_dropped, 16u);
+}
+
+TEST(SchedulerTest, RunsTheEarliestDeadlineFirst)
+{
+  std::vector<int> order;
+  auto invoke = [&order](int model) {
+    return [&order, model](AbsEngine* engine, const cv::Mat& frame) {
+      order.push_back(model);
+      return engine->runObjectDetection(frame);
+    };
+  };
+
+  ModelScheduler scheduler {SchedulingPolicy::EDF, 1};
+  ASSERT_TRUE(scheduler.addModel(modelConfig("relaxed", 1.0f, 1000.0f), nullEngines(1),
+                                 invoke(0), frames()));
+  ASSERT_TRUE(scheduler.addModel(modelConfig("urgent", 1.0f, 10.0f), nullEngines(1),
+                                 invoke(1), frames()));
+  order.clear();
+  EXPECT_TRUE(scheduler.submit(0, frames().front()));
+  EXPECT_TRUE(scheduler.submit(1, frames().front()));
+  scheduler.start();
+  scheduler.stop();
+  EXPECT_EQ(order, (std::vector<int> {1, 0}));
+}
+
+TEST(SchedulerTest, KeepsEveryModelWithinItsCoreBudget)
+{
+  std::atomic<int> running {0};
+  std::atomic<int> peak {0};
+  auto invoke = [&running, &peak](AbsEngine* engine, const cv::Mat& frame) {
+    const int now {++running};
+    int previous {peak.load()};
+    while (previous < now && !peak.compare_exchange_weak(previous, now)) {}
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    --running;
+    return engine->runObjectDetection(frame);
+  };
+
+  SchedulerModelConfig config {modelConfig("detector", 1.0f, 0.0f)};
+  config.m_queueSize = 16;
+  ModelScheduler scheduler {SchedulingPolicy::WFQ, 4};
+  ASSERT_TRUE(scheduler.addModel(config, nullEngines(2), invoke, frames()));
+  for (int i {0}; i < 16; ++i)
+    EXPECT_TRUE(scheduler.submit(0, frames().front()));
+  scheduler.start();
+  scheduler.stop();
+
+  EXPECT_LE(peak.load(), 2);
+  EXPECT_EQ(scheduler.metrics(0).m_completed, 16u);
+  EXPECT_EQ(scheduler.metrics(0).m_latencyMs.size(), 16u);
+}
+
+TEST(SchedulerTest, DropsTheOldestRequestOnAFullQueue)
+{
+  SchedulerModelConfig config {modelConfig("detector", 1.0f, 0.0f)};
+  config.m_queueSize = 2;
+  ModelScheduler scheduler {SchedulingPolicy::WFQ, 1};
+  ASSERT_TRUE(scheduler.addModel(config, nullEngines(1),
+    [](AbsEngine* engine, const cv::Mat& frame) {
+      return engine->runObjectDetection(frame); }, frames()));
+  EXPECT_TRUE(scheduler.submit(0, frames().front()));
+  EXPECT_TRUE(scheduler.submit(0, frames().front()));
+  EXPECT_FALSE(scheduler.submit(0, frames().front()));
+  scheduler.start();
+  scheduler.stop();
+
+  const ModelMetrics& metrics {scheduler.metrics(0)};
+  EXPECT_EQ(metrics.m_submitted, 3u);
+  EXPECT_EQ(metrics.m_dropped, 1u);
+  EXPECT_EQ(metrics.m_completed + metrics.m_failed, 2u);
+  EXPECT_FALSE(scheduler.submit(0, frames().front()));
+}
@@ -0,0 +1,56 @@
+#include "../utils/eval/segmentation.h"
+#include "gtest/gtest.h"
+
+/* unit testing for the confusion matrix based segmentation metrics */
+
+TEST(SegmentationEvalTest, ComputesIouAndPixelAccuracy)
+{
+  // 2x4 masks, the last gt pixel is ignored
+  const std::vector<std::uint8_t> groundTruth {0, 0, 1, 1,
+                                               0, 1, 1, SegmentationEvaluator::kIgnoreLabel};
+  const std::vector<std::uint8_t> prediction  {0, 1, 1, 1,
+                                               0, 1, 1, 0};
+  SegmentationEvaluator evaluator {3, 1};
+  evaluator.addFrame(prediction.data(), 4, groundTruth.data(), 4, 4, 2);
+
+  SegmentationMetrics metrics;
+  evaluator.compute(metrics);
+  EXPECT_EQ(metrics.m_pixels, 7u);
+  EXPECT_DOUBLE_EQ(metrics.m_pixelAccuracy, 6.0 / 7.0);
+  EXPECT_DOUBLE_EQ(metrics.m_iou[0], 2.0 / 3.0);
+  EXPECT_DOUBLE_EQ(metrics.m_iou[1], 4.0 / 5.0);
+  EXPECT_DOUBLE_EQ(metrics.m_iou[2], -1.0);
+  EXPECT_EQ(metrics.m_evaluatedClasses, 2);
+  EXPECT_DOUBLE_EQ(metrics.m_meanIou, (2.0 / 3.0 + 4.0 / 5.0) / 2.0);
+}
+
+TEST(SegmentationEvalTest, BandThreadsMatchSingleThread)
+{
+  const int width {1000};
+  const int height {700};
+  const std::size_t step {1024};  // padded rows
+  std::vector<std::uint8_t> groundTruth(step * height, 0);
+  std::vector<std::uint8_t> prediction(step * height, 0);
+  for (int y {0}; y < height; ++y)
+  {
+    for (int x {0}; x < width; ++x)
+    {
+      groundTruth[y * step + x] = static_cast<std::uint8_t>((x / 100 + y / 70) % 5);
+      prediction[y * step + x] = static_cast<std::uint8_t>((x / 90 + y / 70) % 5);
+    }
+  }
+
+  SegmentationEvaluator single {5, 1};
+  SegmentationEvaluator banded {5, 4};
+  single.addFrame(prediction.data(), step, groundTruth.data(), step, width, height);
+  banded.addFrame(prediction.data(), step, groundTruth.data(), step, width, height);
+
+  SegmentationMetrics singleMetrics;
+  SegmentationMetrics bandedMetrics;
+  single.compute(singleMetrics);
+  banded.compute(bandedMetrics);
+  EXPECT_EQ(bandedMetrics.m_pixels, static_cast<std::uint64_t>(width) * height);
+  EXPECT_EQ(bandedMetrics.m_pixels, singleMetrics.m_pixels);
+  EXPECT_DOUBLE_EQ(bandedMetrics.m_meanIou, singleMetrics.m_meanIou);
+  EXPECT_DOUBLE_EQ(bandedMetrics.m_pixelAccuracy, singleMetrics.m_pixelAccuracy);
+}
@@ -0,0 +1,236 @@
+#include "../engine/null.h"
+#include "../testBench/server.h"
+#include "gtest/gtest.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+/* unit testing for the inference server protocol and its dynamic batcher */
+
+namespace
+{
+constexpr int kCandidates {12};
+
+std::string tempPath(const char* name)
+{
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// yolov10 outputs skip nms, every candidate comes back as a detection
+TestBenchConfig serveConfig()
+{
+  const std::string classesPath {tempPath("server_classes.txt")};
+  std::ofstream classes(classesPath);
+  for (int i {0}; i < 80; ++i)
+    classes << "class" << i << '\n';
+
+  TestBenchConfig config;
+  config.m_benchType = TestBenchType::OBJECT_DETECTION;
+  config.m_engineType = EngineType::NULL_ENGINE;
+  config.m_classNamesPath = classesPath;
+  config.m_confidenceThreshold = 0.5f;
+  config.m_iouThreshold = 0.5f;
+  config.m_arch = ModelArch::YOLO10;
+  config.m_nullEngine.m_width = 160;
+  config.m_nullEngine.m_height = 160;
+  config.m_nullEngine.m_candidates = kCandidates;
+  return config;
+}
+
+// remembers the channels of the frames it runs and counts its batched invokes
+class ChannelsEngine : public EngineNull
+{
+public:
+  std::vector<int> m_channels;
+  int m_batches {0};
+
+  bool runObjectDetection(const cv::Mat& frame)
+  {
+    m_channels.push_back(frame.channels());
+    return EngineNull::runObjectDetection(frame);
+  }
+
+  bool runObjectDetectionBatch(std::span<const cv::Mat> frames)
+  {
+    ++m_batches;
+    return EngineNull::runObjectDetectionBatch(frames);
+  }
+};
+}
+
+TEST(ServerTest, EncodesCompactResponses)
+{
+  DetectedObjects detections;
+  detections.m_firstPoints = {cv::Point(-40000, 10)};
+  detections.m_secondPoints = {cv::Point(50, 40000)};
+  detections.m_classNameIdxs = {7};
+  detections.m_classProbabilities = {0.5f};
+
+  std::vector<std::uint8_t> message;
+  ServeProtocol::encodeResponse(3, ServeStatus::OK, 250, detections, message);
+  ASSERT_EQ(message.size(), sizeof(ServeResponseHeader) + sizeof(ServeDetection));
+
+  ServeResponseHeader header;
+  std::memcpy(&header, message.data(), sizeof(header));
+  EXPECT_EQ(header.m_length, message.size() - sizeof(std::uint32_t));
+  EXPECT_EQ(header.m_id, 3u);
+  EXPECT_EQ(header.m_count, 1u);
+  EXPECT_EQ(header.m_serverUs, 250u);
+
+  ServeDetection detection;
+  std::memcpy(&detection, message.data() + sizeof(header), sizeof(detection));
+  EXPECT_EQ(detection.m_x1, -32768);
+  EXPECT_EQ(detection.m_y2, 32767);
+  EXPECT_EQ(detection.m_classIdx, 7u);
+  EXPECT_EQ(detection.m_score, 32768u);
+
+  // rejected requests carry no detections
+  ServeProtocol::encodeResponse(4, ServeStatus::OVERLOADED, 0, detections, message);
+  EXPECT_EQ(message.size(), sizeof(ServeResponseHeader));
+}
+
+TEST(ServerTest, ValidatesRequestSizes)
+{
+  ServeRequestHeader header;
+  header.m_width = 4;
+  header.m_height = 2;
+  header.m_channels = 3;
+  header.m_length = sizeof(header) - sizeof(std::uint32_t) + 24;
+  EXPECT_TRUE(ServeProtocol::validRequest(header));
+
+  header.m_length -= 1;
+  EXPECT_FALSE(ServeProtocol::validRequest(header));
+  header.m_length += 1;
+  header.m_channels = 4;
+  EXPECT_FALSE(ServeProtocol::validRequest(header));
+}
+
+TEST(ServerTest, BatchesConcurrentRequests)
+{
+  constexpr int kClients {4};
+  constexpr int kRequests {8};
+  TestBenchConfig config {serveConfig()};
+  config.m_serve.m_maxBatch = kClients;
+  config.m_serve.m_maxDelayUs = 20000;
+  EngineNull engine;
+  ASSERT_TRUE(engine.init(&config));
+  ASSERT_TRUE(engine.setBatchSize(config.m_serve.m_maxBatch));
+
+  const std::string socketPath {tempPath("edge_inference_test.sock")};
+  InferenceServer server {&engine, config.m_serve};
+  ASSERT_TRUE(server.start(socketPath));
+
+  auto client = [&socketPath](int clientIdx) {
+    ServeClient client;
+    ASSERT_TRUE(client.connect(socketPath));
+    const cv::Mat frame(120, 160, CV_8UC3, cv::Scalar(0, 0, 0));
+    ServeResponseHeader header;
+    std::vector<ServeDetection> detections;
+    for (int i {0}; i < kRequests; ++i)
+    {
+      const std::uint32_t id {static_cast<std::uint32_t>(clientIdx * kRequests + i)};
+      ASSERT_TRUE(client.request(id, frame, header, detections));
+      EXPECT_EQ(header.m_id, id);
+      EXPECT_EQ(header.m_status, ServeStatus::OK);
+      EXPECT_EQ(detections.size(), static_cast<std::size_t>(kCandidates));
+    }
+  };
+  std::vector<std::thread> clients;
+  for (int i {0}; i < kClients; ++i)
+    clients.emplace_back(client, i);
+  for (std::thread& thread : clients)
+    thread.join();
+  server.stop();
+
+  const ServeMetrics& metrics {server.metrics()};
+  EXPECT_EQ(metrics.m_endToEndMs.size(), static_cast<std::size_t>(kClients * kRequests));
+  EXPECT_EQ(metrics.m_failed, 0u);
+  EXPECT_LT(metrics.m_batchSizes.size(), static_cast<std::size_t>(kClients * kRequests));
+  EXPECT_FALSE(std::filesystem::exists(socketPath));
+}
+
+TEST(ServerTest, RunsALoneRequestOnTheSingleEngine)
+{
+  TestBenchConfig config {serveConfig()};
+  config.m_serve.m_maxBatch = 4;
+  config.m_serve.m_maxDelayUs = 100;
+  auto batchEngine {std::make_shared<ChannelsEngine>()};
+  auto singleEngine {std::make_shared<ChannelsEngine>()};
+  ASSERT_TRUE(batchEngine->init(&config));
+  ASSERT_TRUE(batchEngine->setBatchSize(config.m_serve.m_maxBatch));
+  ASSERT_TRUE(singleEngine->init(&config));
+
+  const std::string socketPath {tempPath("edge_inference_single.sock")};
+  InferenceServer server {batchEngine, config.m_serve, singleEngine};
+  ASSERT_TRUE(server.start(socketPath));
+  ServeClient client;
+  ASSERT_TRUE(client.connect(socketPath));
+  ServeResponseHeader header;
+  std::vector<ServeDetection> detections;
+  ASSERT_TRUE(client.request(3, cv::Mat(120, 160, CV_8UC3, cv::Scalar(0, 0, 0)), header,
+                             detections));
+  EXPECT_EQ(header.m_status, ServeStatus::OK);
+  EXPECT_EQ(detections.size(), static_cast<std::size_t>(kCandidates));
+  server.stop();
+
+  EXPECT_EQ(batchEngine->m_batches, 0);
+  EXPECT_EQ(singleEngine->m_channels.size(), 1u);
+}
+
+TEST(ServerTest, ConvertsGrayFramesToBgr)
+{
+  TestBenchConfig config {serveConfig()};
+  ChannelsEngine engine;
+  ASSERT_TRUE(engine.init(&config));
+  const std::string socketPath {tempPath("edge_inference_gray.sock")};
+  InferenceServer server {&engine, config.m_serve};
+  ASSERT_TRUE(server.start(socketPath));
+
+  ServeClient client;
+  ASSERT_TRUE(client.connect(socketPath));
+  ServeResponseHeader header;
+  std::vector<ServeDetection> detections;
+  ASSERT_TRUE(client.request(7, cv::Mat(120, 160, CV_8UC1, cv::Scalar(0)), header, detections));
+  EXPECT_EQ(header.m_status, ServeStatus::OK);
+  EXPECT_EQ(detections.size(), static_cast<std::size_t>(kCandidates));
+  server.stop();
+  EXPECT_EQ(engine.m_channels, (std::vector<int> {3}));
+}
+
+TEST(ServerTest, ClosesConnectionsSendingInvalidFrames)
+{
+  TestBenchConfig config {serveConfig()};
+  EngineNull engine;
+  ASSERT_TRUE(engine.init(&config));
+  const std::string socketPath {tempPath("edge_inference_invalid.sock")};
+  InferenceServer server {&engine, config.m_serve};
+  ASSERT_TRUE(server.start(socketPath));
+
+  // the client refuses frames the protocol can not carry
+  ServeClient client;
+  ASSERT_TRUE(client.connect(socketPath));
+  ServeResponseHeader header;
+  std::vector<ServeDetection> detections;
+  EXPECT_FALSE(client.request(0, cv::Mat(8, 8, CV_32FC1, cv::Scalar(0, 0, 0)), header,
+                              detections));
+
+  // a header announcing more pixels than the frame holds ends the stream
+  sockaddr_un address {};
+  address.sun_family = AF_UNIX;
+  std::strcpy(address.sun_path, socketPath.c_str());
+  const int fd {socket(AF_UNIX, SOCK_STREAM, 0)};
+  ASSERT_EQ(connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)), 0);
+  ServeRequestHeader request;
+  request.m_width = 8;
+  request.m_height = 8;
+  request.m_channels = 1;
+  request.m_length = 1024;
+  ASSERT_TRUE(ServeProtocol::writeAll(fd, &request, sizeof(request)));
+  EXPECT_FALSE(ServeProtocol::readAll(fd, &header, sizeof(header)));
+  close(fd);
+  server.stop();
+}
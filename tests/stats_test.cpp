@@ -0,0 +1,50 @@
+#include "../utils/stats/stats.h"
+#include "../utils/report/json.h"
+#include "gtest/gtest.h"
+
+/* unit testing for the statistics used by the reports and the regression gate */
+
+TEST(StatsTest, PercentileInterpolatesBetweenSamples)
+{
+  const std::vector<double> sorted {1.0, 2.0, 3.0, 4.0, 5.0};
+  EXPECT_DOUBLE_EQ(Stats::percentile(sorted, 0.0), 1.0);
+  EXPECT_DOUBLE_EQ(Stats::percentile(sorted, 50.0), 3.0);
+  EXPECT_DOUBLE_EQ(Stats::percentile(sorted, 100.0), 5.0);
+  EXPECT_DOUBLE_EQ(Stats::percentile(sorted, 62.5), 3.5);
+}
+
+TEST(StatsTest, MannWhitneyDetectsShiftedSamples)
+{
+  std::vector<double> baseline;
+  std::vector<double> slower;
+  for (int i {0}; i < 50; ++i)
+  {
+    baseline.push_back(10.0 + (i % 7) * 0.1);
+    slower.push_back(11.0 + (i % 7) * 0.1);
+  }
+
+  EXPECT_LT(Stats::mannWhitneyGreater(baseline, slower), 0.001);
+  EXPECT_GT(Stats::mannWhitneyGreater(slower, baseline), 0.999);
+  EXPECT_GT(Stats::mannWhitneyGreater(baseline, baseline), 0.4);
+}
+
+TEST(JsonTest, ParsesWrittenDocument)
+{
+  JsonWriter writer;
+  writer.beginObject();
+  writer.beginObject("stage \"a\"");
+  writer.field("p50", 1.5);
+  writer.beginArray("samples");
+  writer.value(1.0);
+  writer.value(2.0);
+  writer.endArray();
+  writer.endObject();
+  writer.endObject();
+
+  JsonValue document;
+  ASSERT_TRUE(JsonValue::parse(writer.str(), document));
+  const JsonValue* stage {document.find("stage \"a\"")};
+  ASSERT_NE(stage, nullptr);
+  EXPECT_DOUBLE_EQ(stage->find("p50")->asNumber(), 1.5);
+  EXPECT_EQ(stage->find("samples")->m_array.size(), 2u);
+}
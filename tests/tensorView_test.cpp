@@ -0,0 +1,149 @@
+#include "../engine/replay.h"
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+
+/* unit testing for the output tensor views and the decoders bound to them */
+
+namespace
+{
+constexpr int kBoxes {8};
+constexpr int kValues {6};                      // yolov8 with 2 classes
+
+std::string tempPath(const char* name)
+{
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// one box in row 3: center (0.5, 0.5), size 0.2 x 0.2, class 1 scoring 0.9
+float yoloEightValue(int box, int value)
+{
+  constexpr float kBox[kValues] {0.5f, 0.5f, 0.2f, 0.2f, 0.0f, 0.9f};
+  return box == 3 ? kBox[value] : 0.0f;
+}
+
+std::string record(const char* name, ModelArch arch, TensorDtype dtype,
+                   const std::vector<int>& dims, const void* data, std::size_t bytes,
+                   float scale = 0.0f)
+{
+  const std::string path {tempPath(name)};
+  TensorRecorder recorder;
+  EXPECT_TRUE(recorder.open(path, static_cast<std::uint32_t>(TestBenchType::OBJECT_DETECTION),
+                            static_cast<std::uint32_t>(arch), 2));
+  TensorRecordHeader header;
+  header.m_payloadBytes = bytes;
+  header.m_frameWidth = 640;
+  header.m_frameHeight = 480;
+  header.m_rank = static_cast<std::uint8_t>(dims.size());
+  for (std::size_t d {0}; d < dims.size(); ++d)
+    header.m_dims[d] = dims[d];
+  header.m_dtype = dtype;
+  header.m_scale = scale;
+  recorder.record(header, data);
+  EXPECT_TRUE(recorder.close());
+  return path;
+}
+
+TestBenchConfig replayConfig(const std::string& recordingPath)
+{
+  const std::string classesPath {tempPath("tensor_view_classes.txt")};
+  std::ofstream classes(classesPath);
+  classes << "first\nsecond\n";
+
+  TestBenchConfig config;
+  config.m_benchType = TestBenchType::OBJECT_DETECTION;
+  config.m_engineType = EngineType::REPLAY;
+  config.m_modelPath = recordingPath;
+  config.m_classNamesPath = classesPath;
+  config.m_confidenceThreshold = 0.5f;
+  config.m_iouThreshold = 0.5f;
+  return config;
+}
+}
+
+TEST(TensorViewTest, PermutesAndSlicesWithoutMovingData)
+{
+  const int dims[] {2, 3, 4};
+  const std::vector<float> data(24, 0.0f);
+  const TensorView view {TensorView::dense(data.data(), TensorDtype::FLOAT32, dims)};
+  EXPECT_EQ(view.stride(0), 12);
+  EXPECT_EQ(view.stride(1), 4);
+  EXPECT_EQ(view.stride(-1), 1);
+  EXPECT_FLOAT_EQ(view.m_scale, 1.0f);
+
+  const int order[] {0, 2, 1};
+  const TensorView transposed {view.permuted(order)};
+  EXPECT_EQ(transposed.shape(), (std::vector<int>{2, 4, 3}));
+  EXPECT_EQ(transposed.stride(1), 1);
+  EXPECT_EQ(transposed.stride(2), 4);
+  EXPECT_EQ(transposed.m_data, view.m_data);
+
+  const TensorView slot {view.slice(1)};
+  EXPECT_EQ(slot.dim(0), 1);
+  EXPECT_EQ(slot.m_data, static_cast<const void*>(data.data() + 12));
+}
+
+TEST(TensorViewTest, ReadsQuantizedElements)
+{
+  const std::int8_t data[] {-128, 0, 127};
+  const int dims[] {3};
+  const TensorView view {TensorView::dense(data, TensorDtype::INT8, dims, 0.5f, -128)};
+  const TensorReader<TensorDtype::INT8> reader {view};
+  EXPECT_FLOAT_EQ(reader[0], 0.0f);
+  EXPECT_FLOAT_EQ(reader[1], 64.0f);
+  EXPECT_FLOAT_EQ(reader[2], 127.5f);
+}
+
+TEST(TensorViewTest, DecodesEveryLayoutAndTypeInPlace)
+{
+  // [1, 4 + C, N] as exported, [1, N, 4 + C] transposed and a uint8 quantized export
+  std::vector<float> channelsFirst(kValues * kBoxes);
+  std::vector<float> boxesFirst(kValues * kBoxes);
+  std::vector<std::uint8_t> quantized(kValues * kBoxes);
+  for (int box {0}; box < kBoxes; ++box)
+  {
+    for (int value {0}; value < kValues; ++value)
+    {
+      channelsFirst[value * kBoxes + box] = yoloEightValue(box, value);
+      boxesFirst[box * kValues + value] = yoloEightValue(box, value);
+      quantized[value * kBoxes + box] =
+        static_cast<std::uint8_t>(std::lround(yoloEightValue(box, value) * 255.0f));
+    }
+  }
+  const std::vector<std::string> paths {
+    record("tensor_view_f32.eirt", ModelArch::YOLOV8, TensorDtype::FLOAT32,
+           {1, kValues, kBoxes}, channelsFirst.data(), channelsFirst.size() * sizeof(float)),
+    record("tensor_view_f32_t.eirt", ModelArch::YOLOV8, TensorDtype::FLOAT32,
+           {1, kBoxes, kValues}, boxesFirst.data(), boxesFirst.size() * sizeof(float)),
+    record("tensor_view_u8.eirt", ModelArch::YOLOV8, TensorDtype::UINT8, {1, kValues, kBoxes},
+           quantized.data(), quantized.size(), 1.0f / 255.0f)};
+
+  for (const std::string& path : paths)
+  {
+    TestBenchConfig config {replayConfig(path)};
+    EngineReplay engine;
+    ASSERT_TRUE(engine.init(&config)) << path;
+    ASSERT_TRUE(engine.runObjectDetection(cv::Mat()));
+    const DetectedObjects& detections {engine.getDetections()};
+    ASSERT_EQ(detections.m_classNameIdxs.size(), 1u) << path;
+    EXPECT_EQ(detections.m_classNameIdxs.front(), 1u);
+    EXPECT_NEAR(detections.m_classProbabilities.front(), 0.9f, 0.01f);
+    EXPECT_NEAR(detections.m_firstPoints.front().x, 256, 1);
+    EXPECT_NEAR(detections.m_firstPoints.front().y, 192, 1);
+    std::filesystem::remove(path);
+  }
+}
+
+TEST(TensorViewTest, RejectsLayoutMismatchesAtLoad)
+{
+  // yolov10 rows hold 6 values
+  const std::vector<float> data(kBoxes * 5, 0.0f);
+  const std::string path {record("tensor_view_bad.eirt", ModelArch::YOLO10,
+    TensorDtype::FLOAT32, {1, kBoxes, 5}, data.data(), data.size() * sizeof(float))};
+  TestBenchConfig config {replayConfig(path)};
+  EngineReplay engine;
+  EXPECT_FALSE(engine.init(&config));
+  std::filesystem::remove(path);
+}
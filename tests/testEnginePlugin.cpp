@@ -0,0 +1,16 @@
+#include "../engine/plugin.h"
+
+/* engine plugin loaded by enginePlugin_test */
+
+namespace
+{
+class TestEngine : public AbsEngine
+{
+public:
+  bool runObjectDetection(const cv::Mat& frame) { return true; }
+  bool runSemanticDetection(const cv::Mat& frame) { return true; }
+  bool loadModel(const std::string& path) { return true; }
+};
+}
+
+EDGE_INFERENCE_ENGINE_PLUGIN(TestEngine, "null")
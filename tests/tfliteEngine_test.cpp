@@ -2,3 +2,16 @@
 #include "gtest/gtest.h"
 
 /* unit testing for tflite framework */
+
+TEST(EngineLiteTest, DetectsArchitectureFromOutputShapes)
+{
+  EXPECT_EQ(EngineLite::detectArch({{1, 84, 8400}}), ModelArch::YOLOV8);
+  EXPECT_EQ(EngineLite::detectArch({{1, 25200, 85}}), ModelArch::YOLO5);
+  EXPECT_EQ(EngineLite::detectArch({{1, 25200, 6}}), ModelArch::YOLO5);
+  EXPECT_EQ(EngineLite::detectArch({{1, 300, 6}}), ModelArch::YOLO10);
+  EXPECT_EQ(EngineLite::detectArch({{1, 100, 7}}), ModelArch::SSD);
+  EXPECT_EQ(EngineLite::detectArch({{1, 1, 100, 7}}), ModelArch::SSD);
+  EXPECT_EQ(EngineLite::detectArch({{1, 10, 4}, {1, 10}, {1, 10}, {1}}), ModelArch::SSD);
+  EXPECT_EQ(EngineLite::detectArch({{1, 1000}}), ModelArch::UNKNOWN);
+  EXPECT_EQ(EngineLite::detectArch({{1, 84, 8400}, {1, 32, 160, 160}}), ModelArch::UNKNOWN);
+}
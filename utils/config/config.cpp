@@ -1,8 +1,11 @@
 #include "config.h"
 
 #include <spdlog/spdlog.h>
+#include <spdlog/fmt/fmt.h>
 #include <algorithm> 
 #include <cctype> 
+#include <cstdlib>
+#include <sstream>
 
 // helper function to convert string to EngineType enum
 static EngineType stringToEngineType(const std::string& type_str) {
@@ -13,6 +16,9 @@ static EngineType stringToEngineType(const std::string& type_str) {
     if (lower_type_str == "tflite") return EngineType::TFLITE;
     if (lower_type_str == "openvino") return EngineType::OPENVINO;
     if (lower_type_str == "tensorrt") return EngineType::TENSORRT;
+    if (lower_type_str == "onnxruntime") return EngineType::ONNXRUNTIME;
+    if (lower_type_str == "replay") return EngineType::REPLAY;
+    if (lower_type_str == "null") return EngineType::NULL_ENGINE;
     return EngineType::UNKNOWN;
 }
 
@@ -27,6 +33,181 @@ static TestBenchType stringToTestBenchType(const std::string& type_str) {
     return TestBenchType::UNKNOWN;
 }
 
+// helper function to parse a comma separated list of numbers, e.g. '5,10,20,40'
+static bool parseFloatList(const std::string& list, std::vector<float>& values) {
+    std::stringstream stream {list};
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+      char* end {nullptr};
+      const float value {std::strtof(item.c_str(), &end)};
+      if (end == item.c_str())
+        return false;
+      values.push_back(value);
+    }
+    return !values.empty();
+}
+
+const char* engineTypeToString(EngineType type)
+{
+  switch (type)
+  {
+    case EngineType::TFLITE: return "tflite";
+    case EngineType::OPENVINO: return "openvino";
+    case EngineType::TENSORRT: return "tensorrt";
+    case EngineType::ONNXRUNTIME: return "onnxruntime";
+    case EngineType::REPLAY: return "replay";
+    case EngineType::NULL_ENGINE: return "null";
+    default: return "unknown";
+  }
+}
+
+const char* benchTypeToString(TestBenchType type)
+{
+  switch (type)
+  {
+    case TestBenchType::OBJECT_DETECTION: return "object_detection";
+    case TestBenchType::SEMANTIC_SEGMENTATION: return "semantic_segmentation";
+    default: return "unknown";
+  }
+}
+
+const char* modelArchToString(ModelArch arch)
+{
+  switch (arch)
+  {
+    case ModelArch::SSD: return "ssd";
+    case ModelArch::YOLO5: return "yolov5";
+    case ModelArch::YOLOV8: return "yolov8";
+    case ModelArch::YOLO10: return "yolov10";
+    default: return "unknown";
+  }
+}
+
+// helper function to convert string to ModelArch enum, "auto" is left to the engine
+static ModelArch stringToModelArch(const std::string& arch_str) {
+    std::string lower_arch_str {arch_str};
+    std::transform(lower_arch_str.begin(), lower_arch_str.end(), lower_arch_str.begin(), 
+      ::tolower);
+
+    if (lower_arch_str == "ssd") return ModelArch::SSD;
+    if (lower_arch_str == "yolov5") return ModelArch::YOLO5;
+    if (lower_arch_str == "yolov8") return ModelArch::YOLOV8;
+    if (lower_arch_str == "yolov10") return ModelArch::YOLO10;
+    return ModelArch::UNKNOWN;
+}
+
+// helper function to convert string to PerformanceHint enum
+static PerformanceHint stringToPerformanceHint(const std::string& hint_str) {
+    std::string lower_hint_str {hint_str};
+    std::transform(lower_hint_str.begin(), lower_hint_str.end(), lower_hint_str.begin(), 
+      ::tolower);
+
+    if (lower_hint_str == "latency") return PerformanceHint::LATENCY;
+    if (lower_hint_str == "throughput") return PerformanceHint::THROUGHPUT;
+    return PerformanceHint::UNKNOWN;
+}
+
+const char* performanceHintToString(PerformanceHint hint)
+{
+  switch (hint)
+  {
+    case PerformanceHint::LATENCY: return "latency";
+    case PerformanceHint::THROUGHPUT: return "throughput";
+    default: return "unknown";
+  }
+}
+
+// helper function to convert string to GraphOptimization enum
+static GraphOptimization stringToGraphOptimization(const std::string& level_str) {
+    std::string lower_level_str {level_str};
+    std::transform(lower_level_str.begin(), lower_level_str.end(), lower_level_str.begin(), 
+      ::tolower);
+
+    if (lower_level_str == "disabled") return GraphOptimization::DISABLED;
+    if (lower_level_str == "basic") return GraphOptimization::BASIC;
+    if (lower_level_str == "extended") return GraphOptimization::EXTENDED;
+    if (lower_level_str == "all") return GraphOptimization::ALL;
+    return GraphOptimization::UNKNOWN;
+}
+
+const char* graphOptimizationToString(GraphOptimization level)
+{
+  switch (level)
+  {
+    case GraphOptimization::DISABLED: return "disabled";
+    case GraphOptimization::BASIC: return "basic";
+    case GraphOptimization::EXTENDED: return "extended";
+    case GraphOptimization::ALL: return "all";
+    default: return "unknown";
+  }
+}
+
+// helper function to convert string to DropPolicy enum
+static DropPolicy stringToDropPolicy(const std::string& policy_str) {
+    std::string lower_policy_str {policy_str};
+    std::transform(lower_policy_str.begin(), lower_policy_str.end(), lower_policy_str.begin(), 
+      ::tolower);
+
+    if (lower_policy_str == "drop_oldest") return DropPolicy::DROP_OLDEST;
+    if (lower_policy_str == "drop_newest") return DropPolicy::DROP_NEWEST;
+    if (lower_policy_str == "block") return DropPolicy::BLOCK;
+    return DropPolicy::UNKNOWN;
+}
+
+const char* dropPolicyToString(DropPolicy policy)
+{
+  switch (policy)
+  {
+    case DropPolicy::DROP_OLDEST: return "drop_oldest";
+    case DropPolicy::DROP_NEWEST: return "drop_newest";
+    case DropPolicy::BLOCK: return "block";
+    default: return "unknown";
+  }
+}
+
+// helper function to convert string to ArrivalProcess enum
+static ArrivalProcess stringToArrivalProcess(const std::string& process_str) {
+    std::string lower_process_str {process_str};
+    std::transform(lower_process_str.begin(), lower_process_str.end(), 
+      lower_process_str.begin(), ::tolower);
+
+    if (lower_process_str == "constant") return ArrivalProcess::CONSTANT;
+    if (lower_process_str == "poisson") return ArrivalProcess::POISSON;
+    return ArrivalProcess::UNKNOWN;
+}
+
+const char* arrivalProcessToString(ArrivalProcess process)
+{
+  switch (process)
+  {
+    case ArrivalProcess::CONSTANT: return "constant";
+    case ArrivalProcess::POISSON: return "poisson";
+    default: return "unknown";
+  }
+}
+
+// helper function to convert string to SchedulingPolicy enum
+static SchedulingPolicy stringToSchedulingPolicy(const std::string& policy_str) {
+    std::string lower_policy_str {policy_str};
+    std::transform(lower_policy_str.begin(), lower_policy_str.end(), 
+      lower_policy_str.begin(), ::tolower);
+
+    if (lower_policy_str == "wfq") return SchedulingPolicy::WFQ;
+    if (lower_policy_str == "edf") return SchedulingPolicy::EDF;
+    return SchedulingPolicy::UNKNOWN;
+}
+
+const char* schedulingPolicyToString(SchedulingPolicy policy)
+{
+  switch (policy)
+  {
+    case SchedulingPolicy::WFQ: return "wfq";
+    case SchedulingPolicy::EDF: return "edf";
+    default: return "unknown";
+  }
+}
+
 bool TestBenchConfig::parseEngineNode(const pugi::xml_node& engineNode)
 {
   if (!engineNode)
@@ -66,6 +247,79 @@ bool TestBenchConfig::parseEngineNode(const pugi::xml_node& engineNode)
     return false;
   }
   m_confidenceThreshold = confidenceNode.attribute("value").as_float();
+
+  // optional, detected from the output shapes when missing or "auto"
+  m_arch = ModelArch::UNKNOWN;
+  const std::string arch {engineNode.child("arch").attribute("value").as_string()};
+  if (!arch.empty() && arch != "auto")
+  {
+    m_arch = stringToModelArch(arch);
+    if (m_arch == ModelArch::UNKNOWN)
+    {
+      spdlog::error("TestBenchConfig::parseEngineNode: Unknown model architecture: {}", arch);
+      return false;
+    }
+  }
+
+  // optional, only used by the openvino engine
+  m_performanceHint = PerformanceHint::LATENCY;
+  pugi::xml_node hintNode {engineNode.child("performanceHint")};
+  if (hintNode)
+  {
+    m_performanceHint = stringToPerformanceHint(hintNode.attribute("value").as_string());
+    if (m_performanceHint == PerformanceHint::UNKNOWN)
+    {
+      spdlog::error("TestBenchConfig::parseEngineNode: Unknown performance hint: {}", 
+        hintNode.attribute("value").as_string());
+      return false;
+    }
+  }
+  m_inferRequests = engineNode.child("inferRequests").attribute("value").as_int(0);
+  if (m_inferRequests < 0)
+  {
+    spdlog::error("TestBenchConfig::parseEngineNode: <inferRequests> can not be negative");
+    return false;
+  }
+
+  // optional, only used by the onnxruntime engine
+  m_intraOpThreads = engineNode.child("intraOpThreads").attribute("value").as_int(0);
+  m_interOpThreads = engineNode.child("interOpThreads").attribute("value").as_int(0);
+  if (m_intraOpThreads < 0 || m_interOpThreads < 0)
+  {
+    spdlog::error("TestBenchConfig::parseEngineNode: thread counts can not be negative");
+    return false;
+  }
+  m_graphOptimization = GraphOptimization::ALL;
+  pugi::xml_node graphOptimizationNode {engineNode.child("graphOptimization")};
+  if (graphOptimizationNode)
+  {
+    m_graphOptimization = 
+      stringToGraphOptimization(graphOptimizationNode.attribute("value").as_string());
+    if (m_graphOptimization == GraphOptimization::UNKNOWN)
+    {
+      spdlog::error("TestBenchConfig::parseEngineNode: Unknown graph optimization level: {}", 
+        graphOptimizationNode.attribute("value").as_string());
+      return false;
+    }
+  }
+  m_optimizedModelPath = 
+    engineNode.child("optimizedModelPath").attribute("value").as_string();
+
+  // optional, only used by the null engine
+  const pugi::xml_node nullNode {engineNode.child("null")};
+  m_nullEngine = NullEngineConfig{};
+  m_nullEngine.m_width = nullNode.child("width").attribute("value").as_int(m_nullEngine.m_width);
+  m_nullEngine.m_height = 
+    nullNode.child("height").attribute("value").as_int(m_nullEngine.m_height);
+  m_nullEngine.m_boxes = nullNode.child("boxes").attribute("value").as_int(m_nullEngine.m_boxes);
+  m_nullEngine.m_candidates = 
+    nullNode.child("candidates").attribute("value").as_int(m_nullEngine.m_candidates);
+  if (m_nullEngine.m_width <= 0 || m_nullEngine.m_height <= 0 || m_nullEngine.m_boxes < 0 ||
+      m_nullEngine.m_candidates < 0)
+  {
+    spdlog::error("TestBenchConfig::parseEngineNode: <null> sizes have to be positive");
+    return false;
+  }
   return true;
 }
 
@@ -103,6 +357,11 @@ bool TestBenchConfig::parseTestBenchConfigsNode(const pugi::xml_node root)
       return false;
   }
 
+  // optional: load the engine from a plugin instead of the built in one
+  pugi::xml_node enginePluginNode {root.child("enginePlugin")};
+  if (enginePluginNode)
+    m_enginePluginPath = enginePluginNode.attribute("value").as_string();
+
   pugi::xml_node datasetDirNode = root.child("datasetDir");
   if (!datasetDirNode)
   {
@@ -110,27 +369,511 @@ bool TestBenchConfig::parseTestBenchConfigsNode(const pugi::xml_node root)
     return false;  
   }
   m_datasetDir = datasetDirNode.attribute("value").as_string();
+
+  // optional: ground truth for the accuracy metrics
+  pugi::xml_node annotationsNode {root.child("annotations")};
+  if (annotationsNode)
+    m_annotationsPath = annotationsNode.attribute("value").as_string();
+
+  // optional: hardware performance counters around each profiled zone
+  pugi::xml_node perfCountersNode {root.child("perfCounters")};
+  if (perfCountersNode)
+    m_perfCounters = perfCountersNode.attribute("value").as_bool();
+
+  // optional: write a machine readable results file at the end of the run
+  pugi::xml_node resultsPathNode {root.child("resultsPath")};
+  if (resultsPathNode)
+    m_resultsPath = resultsPathNode.attribute("value").as_string();
+
+  // optional: stream the raw output tensors of the measured frames to a file for replay
+  pugi::xml_node recordPathNode {root.child("recordPath")};
+  if (recordPathNode)
+    m_recordPath = recordPathNode.attribute("value").as_string();
+
+  // optional: frames per invoke of the closed-loop object detection run
+  pugi::xml_node batchSizeNode {root.child("batchSize")};
+  if (batchSizeNode)
+  {
+    m_batchSize = batchSizeNode.attribute("value").as_int();
+    if (m_batchSize < 1)
+    {
+      spdlog::error("TestBenchConfig::parseTestBenchConfigsNode: <batchSize> has to be "
+                    "positive");
+      return false;
+    }
+  }
+
   return true;
 }
 
 
-bool TestBenchConfig::parseConfigFile(const std::string& path)
+void TestBenchConfig::parseCompareNode(const pugi::xml_node& compareNode)
 {
-  pugi::xml_document doc;
-  pugi::xml_parse_result result {doc.load_file(path.c_str())};
-  if (!result)
+  if (!compareNode)
+    return;
+
+  pugi::xml_node toleranceNode {compareNode.child("tolerance")};
+  if (toleranceNode)
+    m_compareTolerance = toleranceNode.attribute("value").as_float(m_compareTolerance);
+
+  pugi::xml_node alphaNode {compareNode.child("alpha")};
+  if (alphaNode)
+    m_compareAlpha = alphaNode.attribute("value").as_float(m_compareAlpha);
+}
+
+void TestBenchConfig::parseWarmupNode(const pugi::xml_node& warmupNode)
+{
+  if (!warmupNode)
+    return;
+
+  pugi::xml_node framesNode {warmupNode.child("frames")};
+  if (framesNode)
+    m_warmupFrames = framesNode.attribute("value").as_int(m_warmupFrames);
+
+  pugi::xml_node maxFramesNode {warmupNode.child("maxFrames")};
+  if (maxFramesNode)
+    m_warmupMaxFrames = maxFramesNode.attribute("value").as_int(m_warmupMaxFrames);
+
+  pugi::xml_node windowNode {warmupNode.child("window")};
+  if (windowNode)
+    m_warmupWindow = std::max(2, windowNode.attribute("value").as_int(m_warmupWindow));
+
+  pugi::xml_node cvNode {warmupNode.child("cv")};
+  if (cvNode)
+    m_warmupCv = cvNode.attribute("value").as_float(m_warmupCv);
+}
+
+bool TestBenchConfig::parseRealtimeNode(const pugi::xml_node& realtimeNode)
+{
+  if (!realtimeNode)
+    return true;
+
+  m_realtime.m_enabled = true;
+
+  pugi::xml_node fpsNode {realtimeNode.child("fps")};
+  if (fpsNode)
+    m_realtime.m_fps = fpsNode.attribute("value").as_float(m_realtime.m_fps);
+  if (m_realtime.m_fps <= 0.0f)
   {
-    spdlog::error("TestBenchConfig::parseConfigFile: XML [{}] parsed with errors, "
-                  "description: {}, offset: {}", path, result.description(), result.offset);
+    spdlog::error("TestBenchConfig::parseRealtimeNode: <fps> must be positive!");
     return false;
   }
-  pugi::xml_node root {doc.child("testBenchConfigs")};
-  
+
+  pugi::xml_node jitterNode {realtimeNode.child("jitterMs")};
+  if (jitterNode)
+    m_realtime.m_jitterMs = jitterNode.attribute("value").as_float(m_realtime.m_jitterMs);
+
+  pugi::xml_node deadlineNode {realtimeNode.child("deadlineMs")};
+  if (deadlineNode)
+    m_realtime.m_deadlineMs = deadlineNode.attribute("value").as_float(m_realtime.m_deadlineMs);
+
+  pugi::xml_node queueSizeNode {realtimeNode.child("queueSize")};
+  if (queueSizeNode)
+    m_realtime.m_queueSize = std::max(1, 
+      queueSizeNode.attribute("value").as_int(m_realtime.m_queueSize));
+
+  pugi::xml_node framesNode {realtimeNode.child("frames")};
+  if (framesNode)
+    m_realtime.m_frames = framesNode.attribute("value").as_int(m_realtime.m_frames);
+
+  pugi::xml_node dropPolicyNode {realtimeNode.child("dropPolicy")};
+  if (dropPolicyNode)
+  {
+    m_realtime.m_dropPolicy = stringToDropPolicy(dropPolicyNode.attribute("value").as_string());
+    if (m_realtime.m_dropPolicy == DropPolicy::UNKNOWN)
+    {
+      spdlog::error("TestBenchConfig::parseRealtimeNode: Unknown drop policy: {}", 
+        dropPolicyNode.attribute("value").as_string());
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TestBenchConfig::parseLoadSweepNode(const pugi::xml_node& loadSweepNode)
+{
+  if (!loadSweepNode)
+    return true;
+
+  m_loadSweep.m_enabled = true;
+
+  pugi::xml_node ratesNode {loadSweepNode.child("rates")};
+  if (!ratesNode)
+  {
+    spdlog::error("TestBenchConfig::parseLoadSweepNode: Missing <rates> node!");
+    return false;
+  }
+
+  // comma separated list of offered loads, e.g. '5,10,20,40'
+  const std::string rates {ratesNode.attribute("value").as_string()};
+  if (!parseFloatList(rates, m_loadSweep.m_rates) ||
+      *std::min_element(m_loadSweep.m_rates.begin(), m_loadSweep.m_rates.end()) <= 0.0f)
+  {
+    spdlog::error("TestBenchConfig::parseLoadSweepNode: invalid <rates>: '{}'", rates);
+    return false;
+  }
+  std::sort(m_loadSweep.m_rates.begin(), m_loadSweep.m_rates.end());
+
+  pugi::xml_node arrivalNode {loadSweepNode.child("arrival")};
+  if (arrivalNode)
+  {
+    m_loadSweep.m_arrival = stringToArrivalProcess(arrivalNode.attribute("value").as_string());
+    if (m_loadSweep.m_arrival == ArrivalProcess::UNKNOWN)
+    {
+      spdlog::error("TestBenchConfig::parseLoadSweepNode: Unknown arrival process: {}", 
+        arrivalNode.attribute("value").as_string());
+      return false;
+    }
+  }
+
+  pugi::xml_node instancesNode {loadSweepNode.child("instances")};
+  if (instancesNode)
+    m_loadSweep.m_instances = std::max(1, 
+      instancesNode.attribute("value").as_int(m_loadSweep.m_instances));
+
+  pugi::xml_node durationNode {loadSweepNode.child("durationSec")};
+  if (durationNode)
+    m_loadSweep.m_durationSec = durationNode.attribute("value").as_float(
+      m_loadSweep.m_durationSec);
+
+  pugi::xml_node kneeFactorNode {loadSweepNode.child("kneeFactor")};
+  if (kneeFactorNode)
+    m_loadSweep.m_kneeFactor = kneeFactorNode.attribute("value").as_float(
+      m_loadSweep.m_kneeFactor);
+
+  return true;
+}
+
+bool TestBenchConfig::parseServeNode(const pugi::xml_node& serveNode)
+{
+  if (!serveNode)
+    return true;
+
+  pugi::xml_node maxBatchNode {serveNode.child("maxBatch")};
+  if (maxBatchNode)
+    m_serve.m_maxBatch = maxBatchNode.attribute("value").as_int(m_serve.m_maxBatch);
+
+  pugi::xml_node maxDelayNode {serveNode.child("maxDelayUs")};
+  if (maxDelayNode)
+    m_serve.m_maxDelayUs = maxDelayNode.attribute("value").as_int(m_serve.m_maxDelayUs);
+
+  pugi::xml_node queueSizeNode {serveNode.child("queueSize")};
+  if (queueSizeNode)
+    m_serve.m_queueSize = queueSizeNode.attribute("value").as_int(m_serve.m_queueSize);
+
+  if (m_serve.m_maxBatch < 1 || m_serve.m_maxDelayUs < 0 || m_serve.m_queueSize < 1)
+  {
+    spdlog::error("TestBenchConfig::parseServeNode: <maxBatch> and <queueSize> have to be "
+                  "positive, <maxDelayUs> can not be negative");
+    return false;
+  }
+  return true;
+}
+
+bool TestBenchConfig::parseFrameRingNode(const pugi::xml_node& frameRingNode)
+{
+  if (!frameRingNode)
+    return true;
+
+  pugi::xml_node widthNode {frameRingNode.child("width")};
+  if (widthNode)
+    m_frameRing.m_width = widthNode.attribute("value").as_int(m_frameRing.m_width);
+
+  pugi::xml_node heightNode {frameRingNode.child("height")};
+  if (heightNode)
+    m_frameRing.m_height = heightNode.attribute("value").as_int(m_frameRing.m_height);
+
+  pugi::xml_node slotsNode {frameRingNode.child("slots")};
+  if (slotsNode)
+    m_frameRing.m_slots = slotsNode.attribute("value").as_int(m_frameRing.m_slots);
+
+  pugi::xml_node resultSlotsNode {frameRingNode.child("resultSlots")};
+  if (resultSlotsNode)
+    m_frameRing.m_resultSlots = resultSlotsNode.attribute("value").as_int(
+      m_frameRing.m_resultSlots);
+
+  pugi::xml_node fpsNode {frameRingNode.child("fps")};
+  if (fpsNode)
+    m_frameRing.m_fps = fpsNode.attribute("value").as_float(m_frameRing.m_fps);
+
+  if (m_frameRing.m_width <= 0 || m_frameRing.m_height <= 0 || m_frameRing.m_fps <= 0.0f ||
+      m_frameRing.m_slots < 2 || m_frameRing.m_slots > 256 || m_frameRing.m_resultSlots < 1)
+  {
+    spdlog::error("TestBenchConfig::parseFrameRingNode: sizes and <fps> have to be positive, "
+                  "<slots> between 2 and 256");
+    return false;
+  }
+  return true;
+}
+
+bool TestBenchConfig::parseSchedulerNode(const pugi::xml_node& schedulerNode)
+{
+  if (!schedulerNode)
+    return true;
+
+  m_scheduler.m_enabled = true;
+
+  pugi::xml_node policyNode {schedulerNode.child("policy")};
+  if (policyNode)
+  {
+    m_scheduler.m_policy = stringToSchedulingPolicy(policyNode.attribute("value").as_string());
+    if (m_scheduler.m_policy == SchedulingPolicy::UNKNOWN)
+    {
+      spdlog::error("TestBenchConfig::parseSchedulerNode: Unknown scheduling policy: {}", 
+        policyNode.attribute("value").as_string());
+      return false;
+    }
+  }
+
+  pugi::xml_node workersNode {schedulerNode.child("workers")};
+  if (workersNode)
+    m_scheduler.m_workers = std::max(0, 
+      workersNode.attribute("value").as_int(m_scheduler.m_workers));
+
+  pugi::xml_node durationNode {schedulerNode.child("durationSec")};
+  if (durationNode)
+    m_scheduler.m_durationSec = durationNode.attribute("value").as_float(
+      m_scheduler.m_durationSec);
+
+  m_scheduler.m_models.clear();
+  for (const pugi::xml_node& modelNode : schedulerNode.children("model"))
+  {
+    SchedulerModelConfig& model {m_scheduler.m_models.emplace_back()};
+    model.m_name = modelNode.attribute("name").as_string();
+    model.m_configPath = modelNode.child("config").attribute("value").as_string();
+    model.m_priority = modelNode.child("priority").attribute("value").as_float(model.m_priority);
+    model.m_cores = modelNode.child("cores").attribute("value").as_int(model.m_cores);
+    model.m_fps = modelNode.child("fps").attribute("value").as_float(model.m_fps);
+    model.m_deadlineMs = modelNode.child("deadlineMs").attribute("value").as_float(
+      model.m_deadlineMs);
+    model.m_queueSize = modelNode.child("queueSize").attribute("value").as_int(
+      model.m_queueSize);
+    if (model.m_name.empty())
+      model.m_name = fmt::format("model{}", m_scheduler.m_models.size() - 1);
+
+    if (model.m_configPath.empty() || model.m_priority <= 0.0f || model.m_cores < 1 ||
+        model.m_fps <= 0.0f || model.m_deadlineMs < 0.0f || model.m_queueSize < 1)
+    {
+      spdlog::error("TestBenchConfig::parseSchedulerNode: model {} needs a <config>, a "
+                    "positive <priority>, <cores>, <fps> and <queueSize>", model.m_name);
+      return false;
+    }
+  }
+  if (m_scheduler.m_models.empty() || m_scheduler.m_durationSec <= 0.0f)
+  {
+    spdlog::error("TestBenchConfig::parseSchedulerNode: needs at least one <model> and a "
+                  "positive <durationSec>");
+    return false;
+  }
+  return true;
+}
+
+bool TestBenchConfig::parseHotReloadNode(const pugi::xml_node& hotReloadNode)
+{
+  if (!hotReloadNode)
+    return true;
+
+  m_hotReload.m_enabled = true;
+  m_hotReload.m_modelPath = hotReloadNode.child("modelPath").attribute("value").as_string();
+
+  pugi::xml_node intervalNode {hotReloadNode.child("intervalSec")};
+  if (intervalNode)
+    m_hotReload.m_intervalSec = intervalNode.attribute("value").as_float(
+      m_hotReload.m_intervalSec);
+
+  pugi::xml_node reloadsNode {hotReloadNode.child("reloads")};
+  if (reloadsNode)
+    m_hotReload.m_reloads = reloadsNode.attribute("value").as_int(m_hotReload.m_reloads);
+
+  pugi::xml_node fpsNode {hotReloadNode.child("fps")};
+  if (fpsNode)
+    m_hotReload.m_fps = fpsNode.attribute("value").as_float(m_hotReload.m_fps);
+
+  if (m_hotReload.m_intervalSec <= 0.0f || m_hotReload.m_reloads < 1 ||
+      m_hotReload.m_fps <= 0.0f)
+  {
+    spdlog::error("TestBenchConfig::parseHotReloadNode: <intervalSec>, <reloads> and <fps> "
+                  "have to be positive");
+    return false;
+  }
+  return true;
+}
+
+bool TestBenchConfig::parseThresholdSweepNode(const pugi::xml_node& thresholdSweepNode)
+{
+  if (!thresholdSweepNode)
+    return true;
+
+  m_thresholdSweep.m_enabled = true;
+
+  // comma separated lists, every confidence is combined with every iou
+  const std::string confidences {thresholdSweepNode.child("confidences").attribute("value")
+                                   .as_string()};
+  const std::string ious {thresholdSweepNode.child("ious").attribute("value").as_string()};
+  auto inUnitRange = [](const std::vector<float>& values) {
+    return std::all_of(values.begin(), values.end(), 
+                       [](float value) { return value >= 0.0f && value <= 1.0f; });
+  };
+  if (!parseFloatList(confidences, m_thresholdSweep.m_confidences) || 
+      !inUnitRange(m_thresholdSweep.m_confidences))
+  {
+    spdlog::error("TestBenchConfig::parseThresholdSweepNode: invalid <confidences>: '{}'",
+                  confidences);
+    return false;
+  }
+  if (!parseFloatList(ious, m_thresholdSweep.m_ious) || !inUnitRange(m_thresholdSweep.m_ious))
+  {
+    spdlog::error("TestBenchConfig::parseThresholdSweepNode: invalid <ious>: '{}'", ious);
+    return false;
+  }
+  std::sort(m_thresholdSweep.m_confidences.begin(), m_thresholdSweep.m_confidences.end());
+  std::sort(m_thresholdSweep.m_ious.begin(), m_thresholdSweep.m_ious.end());
+  return true;
+}
+
+bool TestBenchConfig::parseRootNode(const pugi::xml_node& root)
+{
   // parse the test bench configs node
   if (!parseTestBenchConfigsNode(root))
     return false;
+
+  parseCompareNode(root.child("compare"));
+  parseWarmupNode(root.child("warmup"));
+  if (!parseRealtimeNode(root.child("realtime")))
+    return false;
+
+  if (!parseLoadSweepNode(root.child("loadSweep")))
+    return false;
+
+  if (!parseServeNode(root.child("serve")))
+    return false;
+
+  if (!parseFrameRingNode(root.child("frameRing")))
+    return false;
+
+  if (!parseSchedulerNode(root.child("scheduler")))
+    return false;
+
+  if (!parseHotReloadNode(root.child("hotReload")))
+    return false;
+
+  if (!parseThresholdSweepNode(root.child("thresholdSweep")))
+    return false;
   
   // parse engine node
   return parseEngineNode(root.child("engine"));
 }
 
+bool TestBenchConfig::parseConfigFile(const std::string& path)
+{
+  pugi::xml_document doc;
+  pugi::xml_parse_result result {doc.load_file(path.c_str())};
+  if (!result)
+  {
+    spdlog::error("TestBenchConfig::parseConfigFile: XML [{}] parsed with errors, "
+                  "description: {}, offset: {}", path, result.description(), result.offset);
+    return false;
+  }
+  m_configPath = path;
+  return parseRootNode(doc.child("testBenchConfigs"));
+}
+
+namespace
+{
+/**
+ * @brief merges an override node into a base node. Nodes with element children are merged
+ * child by child, leaf nodes replace the base node.
+ * @param base node of the base configuration
+ * @param override node of a matrix variant
+ */
+void mergeNode(pugi::xml_node base, const pugi::xml_node& override)
+{
+  for (const pugi::xml_node& child : override.children())
+  {
+    if (child.type() != pugi::node_element)
+      continue;
+    pugi::xml_node target {base.child(child.name())};
+    if (target && child.find_child([](const pugi::xml_node& node) {
+                    return node.type() == pugi::node_element; }))
+    {
+      for (const pugi::xml_attribute& attribute : child.attributes())
+      {
+        if (!target.attribute(attribute.name()))
+          target.append_attribute(attribute.name());
+        target.attribute(attribute.name()).set_value(attribute.value());
+      }
+      mergeNode(target, child);
+      continue;
+    }
+    if (target)
+      base.remove_child(target);
+    base.append_copy(child);
+  }
+}
+}
+
+bool TestBenchConfig::parseMatrixFile(const std::string& path,
+                                      std::vector<TestBenchConfig>& configs)
+{
+  configs.clear();
+  pugi::xml_document doc;
+  pugi::xml_parse_result result {doc.load_file(path.c_str())};
+  if (!result)
+  {
+    spdlog::error("TestBenchConfig::parseMatrixFile: XML [{}] parsed with errors, "
+                  "description: {}, offset: {}", path, result.description(), result.offset);
+    return false;
+  }
+
+  const pugi::xml_node matrix {doc.child("testBenchConfigs").child("matrix")};
+  if (!matrix)
+  {
+    configs.emplace_back();
+    configs.back().m_configPath = path;
+    return configs.back().parseRootNode(doc.child("testBenchConfigs"));
+  }
+
+  for (const pugi::xml_node& variant : matrix.children("variant"))
+  {
+    pugi::xml_document variantDoc;
+    variantDoc.reset(doc);
+    pugi::xml_node root {variantDoc.child("testBenchConfigs")};
+    root.remove_child("matrix");
+    mergeNode(root, variant);
+
+    TestBenchConfig config;
+    config.m_configPath = path;
+    config.m_variantName = variant.attribute("name").as_string();
+    if (config.m_variantName.empty())
+      config.m_variantName = fmt::format("variant{}", configs.size());
+    if (config.m_variantName.find_first_of("/\\") != std::string::npos)
+    {
+      spdlog::error("TestBenchConfig::parseMatrixFile: variant name {} is used in file names, "
+                    "it cannot contain path separators", config.m_variantName);
+      return false;
+    }
+    if (!config.parseRootNode(root))
+    {
+      spdlog::error("TestBenchConfig::parseMatrixFile: variant {} is invalid",
+                    config.m_variantName);
+      return false;
+    }
+    for (const TestBenchConfig& other : configs)
+    {
+      if (other.m_variantName == config.m_variantName)
+      {
+        spdlog::error("TestBenchConfig::parseMatrixFile: duplicate variant name {}",
+                      config.m_variantName);
+        return false;
+      }
+    }
+    configs.push_back(std::move(config));
+  }
+
+  if (configs.empty())
+  {
+    spdlog::error("TestBenchConfig::parseMatrixFile: <matrix> has no <variant> nodes");
+    return false;
+  }
+  return true;
+}
@@ -1,12 +1,13 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <pugi/pugixml.hpp>
 
 /**
  * @brief EngineType defines the type of inference engine to be used
  */
-enum class EngineType {TFLITE, OPENVINO, TENSORRT, UNKNOWN};
+enum class EngineType {TFLITE, OPENVINO, TENSORRT, ONNXRUNTIME, REPLAY, NULL_ENGINE, UNKNOWN};
 
 /**
  * @brief TestBenchType defines the type of test bench to be used
@@ -19,6 +20,181 @@ enum class TestBenchType {OBJECT_DETECTION, SEMANTIC_SEGMENTATION, UNKNOWN};
  */
 enum class ModelArch {SSD, YOLO5, YOLOV8, YOLO10, UNKNOWN};
 
+/**
+ * @brief PerformanceHint selects what the OpenVINO CPU plugin optimizes the compiled model for
+ */
+enum class PerformanceHint {LATENCY, THROUGHPUT, UNKNOWN};
+
+/**
+ * @brief GraphOptimization is the ONNX Runtime graph optimization level of the session
+ */
+enum class GraphOptimization {DISABLED, BASIC, EXTENDED, ALL, UNKNOWN};
+
+/**
+ * @brief DropPolicy defines what a paced frame source does when the engine falls behind
+ */
+enum class DropPolicy {DROP_OLDEST, DROP_NEWEST, BLOCK, UNKNOWN};
+
+/**
+ * @brief RealtimeConfig holds the parameters of the fixed-fps camera simulation
+ */
+struct RealtimeConfig
+{
+  bool m_enabled {false};                 /// \var run paced instead of a tight loop
+  float m_fps {30.0f};                    /// \var camera frame rate
+  float m_jitterMs {0.0f};                /// \var uniform capture jitter (+/-)
+  float m_deadlineMs {0.0f};              /// \var capture-to-result deadline, 0 = 1 / fps
+  int m_queueSize {4};                    /// \var frames buffered between camera and engine
+  int m_frames {0};                       /// \var frames to emit, 0 = dataset size
+  DropPolicy m_dropPolicy {DropPolicy::DROP_OLDEST};  /// \var policy on a full queue
+};
+
+/**
+ * @brief NullEngineConfig holds the geometry of the synthetic outputs of the null engine
+ */
+struct NullEngineConfig
+{
+  int m_width {640};                      /// \var model input width
+  int m_height {640};                     /// \var model input height
+  int m_boxes {0};                        /// \var candidate rows, 0 = architecture default
+  int m_candidates {16};                  /// \var rows above the confidence threshold
+};
+
+/**
+ * @brief ArrivalProcess defines how the open-loop load generator spaces requests
+ */
+enum class ArrivalProcess {CONSTANT, POISSON, UNKNOWN};
+
+/**
+ * @brief SchedulingPolicy defines how the multi-model scheduler orders pending invocations
+ */
+enum class SchedulingPolicy {WFQ, EDF, UNKNOWN};
+
+/**
+ * @brief LoadSweepConfig holds the parameters of the open-loop throughput/latency sweep
+ */
+struct LoadSweepConfig
+{
+  bool m_enabled {false};                 /// \var run the sweep instead of a tight loop
+  ArrivalProcess m_arrival {ArrivalProcess::POISSON};  /// \var inter-arrival distribution
+  std::vector<float> m_rates;             /// \var offered loads in requests per second
+  int m_instances {1};                    /// \var concurrent engine instances
+  float m_durationSec {10.0f};            /// \var duration of every load level
+  float m_kneeFactor {2.0f};              /// \var allowed p99 growth over the lowest load
+};
+
+/**
+ * @brief ServeConfig holds the dynamic batching parameters of the inference server
+ */
+struct ServeConfig
+{
+  int m_maxBatch {1};                     /// \var requests run together at most
+  int m_maxDelayUs {2000};                /// \var wait of the oldest request for a full batch
+  int m_queueSize {64};                   /// \var queued requests before rejecting new ones
+};
+
+/**
+ * @brief FrameRingConfig holds the geometry of the shared-memory frame ring and the pace of
+ * its synthetic producer
+ */
+struct FrameRingConfig
+{
+  int m_width {1920};                     /// \var frame width
+  int m_height {1080};                    /// \var frame height
+  int m_slots {8};                        /// \var frame slots, more than the consumers
+  int m_resultSlots {64};                 /// \var results queued for the producer
+  float m_fps {30.0f};                    /// \var frame rate of the synthetic producer
+};
+
+/**
+ * @brief HotReloadConfig holds the parameters of the hot model reload benchmark
+ */
+struct HotReloadConfig
+{
+  bool m_enabled {false};                 /// \var run the reload benchmark
+  std::string m_modelPath;                /// \var alternates with <modelPath>, empty = same
+  float m_intervalSec {2.0f};             /// \var time between reloads
+  int m_reloads {3};                      /// \var reloads of the run
+  float m_fps {30.0f};                    /// \var frame rate served during the run
+};
+
+/**
+ * @brief SchedulerModelConfig holds one model hosted by the multi-model scheduler
+ */
+struct SchedulerModelConfig
+{
+  std::string m_name;                     /// \var name in the report
+  std::string m_configPath;               /// \var test bench config of the model
+  float m_priority {1.0f};                /// \var share of the pool (wfq), tie-break (edf)
+  int m_cores {1};                        /// \var engine instances, i.e. workers it may hold
+  float m_fps {30.0f};                    /// \var request rate
+  float m_deadlineMs {0.0f};              /// \var arrival-to-result deadline, 0 = 1 / fps
+  int m_queueSize {4};                    /// \var pending requests, the oldest is dropped
+};
+
+/**
+ * @brief SchedulerConfig holds the parameters of the multi-model scheduler run
+ */
+struct SchedulerConfig
+{
+  bool m_enabled {false};                 /// \var run the models instead of a single bench
+  SchedulingPolicy m_policy {SchedulingPolicy::WFQ};  /// \var order of pending invocations
+  int m_workers {0};                      /// \var shared worker pool, 0 = hardware threads
+  float m_durationSec {10.0f};            /// \var duration of the run
+  std::vector<SchedulerModelConfig> m_models; /// \var hosted models
+};
+
+/**
+ * @brief ThresholdSweepConfig holds the confidence/NMS IoU grid evaluated from one
+ * inference pass
+ */
+struct ThresholdSweepConfig
+{
+  bool m_enabled {false};                 /// \var evaluate the grid after the closed loop
+  std::vector<float> m_confidences;       /// \var confidence thresholds
+  std::vector<float> m_ious;              /// \var NMS IoU thresholds
+};
+
+/**
+ * @brief returns the config string of the given engine type
+ */
+const char* engineTypeToString(EngineType type);
+
+/**
+ * @brief returns the config string of the given test bench type
+ */
+const char* benchTypeToString(TestBenchType type);
+
+/**
+ * @brief returns a printable name of the given model architecture
+ */
+const char* modelArchToString(ModelArch arch);
+
+/**
+ * @brief returns the config string of the given performance hint
+ */
+const char* performanceHintToString(PerformanceHint hint);
+
+/**
+ * @brief returns the config string of the given graph optimization level
+ */
+const char* graphOptimizationToString(GraphOptimization level);
+
+/**
+ * @brief returns the config string of the given drop policy
+ */
+const char* dropPolicyToString(DropPolicy policy);
+
+/**
+ * @brief returns the config string of the given arrival process
+ */
+const char* arrivalProcessToString(ArrivalProcess process);
+
+/**
+ * @brief returns the config string of the given scheduling policy
+ */
+const char* schedulingPolicyToString(SchedulingPolicy policy);
+
 
 /**
  * @brief TestBenchConfig holds the configuration parameters for the test bench
@@ -40,15 +216,112 @@ class TestBenchConfig
    */
   bool parseTestBenchConfigsNode(const pugi::xml_node root);
 
+  /**
+   * @brief parse the optional baseline comparison node
+   * @param compareNode xml node
+   */
+  void parseCompareNode(const pugi::xml_node& compareNode);
+
+  /**
+   * @brief parse the optional warm-up node
+   * @param warmupNode xml node
+   */
+  void parseWarmupNode(const pugi::xml_node& warmupNode);
+
+  /**
+   * @brief parse the optional realtime (paced camera) node
+   * @param realtimeNode xml node
+   * @return true / false
+   */
+  bool parseRealtimeNode(const pugi::xml_node& realtimeNode);
+
+  /**
+   * @brief parse the optional open-loop load sweep node
+   * @param loadSweepNode xml node
+   * @return true / false
+   */
+  bool parseLoadSweepNode(const pugi::xml_node& loadSweepNode);
+
+  /**
+   * @brief parse the optional inference server node
+   * @param serveNode xml node
+   * @return true / false
+   */
+  bool parseServeNode(const pugi::xml_node& serveNode);
+
+  /**
+   * @brief parse the optional shared-memory frame ring node
+   * @param frameRingNode xml node
+   * @return true / false
+   */
+  bool parseFrameRingNode(const pugi::xml_node& frameRingNode);
+
+  /**
+   * @brief parse the optional multi-model scheduler node
+   * @param schedulerNode xml node
+   * @return true / false
+   */
+  bool parseSchedulerNode(const pugi::xml_node& schedulerNode);
+
+  /**
+   * @brief parse the optional hot model reload node
+   * @param hotReloadNode xml node
+   * @return true / false
+   */
+  bool parseHotReloadNode(const pugi::xml_node& hotReloadNode);
+
+  /**
+   * @brief parse the optional confidence/IoU threshold sweep node
+   * @param thresholdSweepNode xml node
+   * @return true / false
+   */
+  bool parseThresholdSweepNode(const pugi::xml_node& thresholdSweepNode);
+
+  /**
+   * @brief parse the root node of a configuration document
+   * @param root root xml node
+   * @return true / false
+   */
+  bool parseRootNode(const pugi::xml_node& root);
+
 public:
   std::string m_modelPath;                /// \var path to the model file
   std::string m_classNamesPath;           /// \var path to the class names file
   std::string m_datasetDir;               /// \var path to the dataset directory
+  std::string m_annotationsPath;          /// \var ground truth (coco json / yolo txt dir)
   float m_iouThreshold;                   /// \var IOU threshold for non-max suppression
   float m_confidenceThreshold;            /// \var confidence threshold for detections
   EngineType m_engineType;                /// \var type of the inference engine
+  std::string m_enginePluginPath;         /// \var shared object serving the engine type
   TestBenchType m_benchType;              /// \var type of the test bench
-  ModelArch m_arch;
+  ModelArch m_arch {ModelArch::UNKNOWN};  /// \var model architecture, UNKNOWN = detect at load
+  PerformanceHint m_performanceHint {PerformanceHint::LATENCY}; /// \var openvino compile hint
+  int m_inferRequests {0};                /// \var openvino request pool, 0 = plugin optimum
+  int m_intraOpThreads {0};               /// \var onnxruntime threads per op, 0 = default
+  int m_interOpThreads {0};               /// \var onnxruntime parallel ops, 0 = sequential
+  GraphOptimization m_graphOptimization {GraphOptimization::ALL}; /// \var onnxruntime level
+  std::string m_optimizedModelPath;       /// \var onnxruntime optimized model cache
+  NullEngineConfig m_nullEngine;          /// \var synthetic outputs of the null engine
+  bool m_perfCounters {false};            /// \var sample hardware counters per profiled zone
+  int m_batchSize {1};                    /// \var frames per invoke of the closed loop
+  std::string m_configPath;               /// \var path of the parsed config file
+  std::string m_variantName;              /// \var matrix variant name, empty for single runs
+  std::string m_resultsPath;              /// \var machine readable results file (json/csv)
+  std::string m_recordPath;               /// \var raw output tensor recording file
+  std::string m_baselinePath;             /// \var baseline results to compare against
+  float m_compareTolerance {0.05f};       /// \var allowed relative latency increase
+  float m_compareAlpha {0.01f};           /// \var significance level of the comparison
+  int m_warmupFrames {0};                 /// \var fixed (or minimum) number of warm-up frames
+  int m_warmupMaxFrames {500};            /// \var upper bound when waiting for stability
+  int m_warmupWindow {20};                /// \var rolling window of the stability check
+  float m_warmupCv {0.0f};                /// \var coefficient of variation to reach, 0 = off
+  RealtimeConfig m_realtime;              /// \var paced camera simulation
+  LoadSweepConfig m_loadSweep;            /// \var open-loop load sweep
+  ServeConfig m_serve;                    /// \var dynamic batching of the server mode
+  FrameRingConfig m_frameRing;            /// \var shared-memory frame ring
+  SchedulerConfig m_scheduler;            /// \var models sharing one worker pool
+  HotReloadConfig m_hotReload;            /// \var model swaps while serving
+  ThresholdSweepConfig m_thresholdSweep;  /// \var confidence/IoU sweep on recorded candidates
 
   /**
    * @brief parses the xml configuration file at the given path
@@ -56,5 +329,15 @@ public:
    * @return true if parsing was successful, false otherwise
    */
   bool parseConfigFile(const std::string& path);
+
+  /**
+   * @brief parses a configuration file with an optional <matrix> of variants. Every 
+   * <variant name='...'> overrides nodes of the base configuration, nested nodes such as
+   * <engine> are merged child by child.
+   * @param path path to the xml configuration file
+   * @param configs output configurations, the base one if the file has no matrix
+   * @return true if parsing was successful, false otherwise
+   */
+  static bool parseMatrixFile(const std::string& path, std::vector<TestBenchConfig>& configs);
 };
 
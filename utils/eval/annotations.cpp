@@ -0,0 +1,195 @@
+#include "annotations.h"
+#include "../report/json.h"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <unordered_map>
+
+bool AnnotationLoader::load(const std::string& path, const std::vector<std::string>& frameNames,
+                            const std::vector<std::pair<int, int>>& frameSizes,
+                            const std::vector<std::string>& classNames,
+                            std::vector<FrameAnnotations>& annotations)
+{
+  std::error_code error;
+  if (std::filesystem::is_directory(path, error))
+    return loadYolo(path, frameNames, frameSizes, annotations);
+  return loadCoco(path, frameNames, classNames, annotations);
+}
+
+bool AnnotationLoader::loadCoco(const std::string& path,
+                                const std::vector<std::string>& frameNames,
+                                const std::vector<std::string>& classNames,
+                                std::vector<FrameAnnotations>& annotations)
+{
+  JsonValue document;
+  if (!JsonValue::parseFile(path, document))
+  {
+    spdlog::error("AnnotationLoader::loadCoco: could not parse annotation file: {}", path);
+    return false;
+  }
+  const JsonValue* images {document.find("images")};
+  const JsonValue* objects {document.find("annotations")};
+  const JsonValue* categories {document.find("categories")};
+  if (images == nullptr || objects == nullptr || categories == nullptr)
+  {
+    spdlog::error("AnnotationLoader::loadCoco: {} is not a COCO annotation file", path);
+    return false;
+  }
+
+  // category id -> class index, by name first, in id order as a fallback
+  std::map<long long, int> categoryToClass;
+  std::vector<long long> categoryIds;
+  for (const JsonValue& category : categories->m_array)
+  {
+    const JsonValue* id {category.find("id")};
+    const JsonValue* name {category.find("name")};
+    if (id == nullptr)
+      continue;
+    categoryIds.push_back(static_cast<long long>(id->asNumber()));
+    if (name == nullptr)
+      continue;
+    const auto it {std::find(classNames.begin(), classNames.end(), name->m_string)};
+    if (it != classNames.end())
+      categoryToClass[categoryIds.back()] = static_cast<int>(it - classNames.begin());
+  }
+  if (categoryToClass.empty())
+  {
+    spdlog::warn("AnnotationLoader::loadCoco: no category name matches the class names, "
+                 "mapping categories in id order");
+    std::sort(categoryIds.begin(), categoryIds.end());
+    for (std::size_t i {0}; i < categoryIds.size(); ++i)
+      categoryToClass[categoryIds[i]] = static_cast<int>(i);
+  }
+
+  std::unordered_map<std::string, std::size_t> frameIdx;
+  for (std::size_t i {0}; i < frameNames.size(); ++i)
+    frameIdx.emplace(frameNames[i], i);
+
+  // image id -> frame index, images that are not in the dataset are skipped
+  std::unordered_map<long long, std::size_t> imageToFrame;
+  for (const JsonValue& image : images->m_array)
+  {
+    const JsonValue* id {image.find("id")};
+    const JsonValue* fileName {image.find("file_name")};
+    if (id == nullptr || fileName == nullptr)
+      continue;
+    const auto it {frameIdx.find(std::filesystem::path(fileName->m_string).filename().string())};
+    if (it != frameIdx.end())
+      imageToFrame.emplace(static_cast<long long>(id->asNumber()), it->second);
+  }
+  if (imageToFrame.size() < frameNames.size())
+    spdlog::warn("AnnotationLoader::loadCoco: {} of {} frames have no image entry in {}",
+                 frameNames.size() - imageToFrame.size(), frameNames.size(), path);
+
+  annotations.assign(frameNames.size(), FrameAnnotations{});
+  std::size_t numBoxes {0};
+  for (const JsonValue& object : objects->m_array)
+  {
+    const JsonValue* imageId {object.find("image_id")};
+    const JsonValue* categoryId {object.find("category_id")};
+    const JsonValue* bbox {object.find("bbox")};
+    if (imageId == nullptr || categoryId == nullptr || bbox == nullptr ||
+        bbox->m_array.size() != 4)
+      continue;
+
+    const auto frame {imageToFrame.find(static_cast<long long>(imageId->asNumber()))};
+    const auto classIdx {categoryToClass.find(static_cast<long long>(categoryId->asNumber()))};
+    if (frame == imageToFrame.end() || classIdx == categoryToClass.end())
+      continue;
+
+    // coco boxes are [x, y, width, height] in pixels
+    const float x {static_cast<float>(bbox->m_array[0].asNumber())};
+    const float y {static_cast<float>(bbox->m_array[1].asNumber())};
+    const float w {static_cast<float>(bbox->m_array[2].asNumber())};
+    const float h {static_cast<float>(bbox->m_array[3].asNumber())};
+    const JsonValue* crowd {object.find("iscrowd")};
+
+    FrameAnnotations& gt {annotations[frame->second]};
+    gt.m_boxes.push_back({x, y, x + w, y + h});
+    gt.m_classes.push_back(classIdx->second);
+    gt.m_crowd.push_back(crowd != nullptr && crowd->asNumber() != 0.0);
+    ++numBoxes;
+  }
+
+  spdlog::info("AnnotationLoader::loadCoco: {} boxes for {} frames from {}", numBoxes,
+               imageToFrame.size(), path);
+  return true;
+}
+
+bool AnnotationLoader::loadYolo(const std::string& dir, const std::vector<std::string>& frameNames,
+                                const std::vector<std::pair<int, int>>& frameSizes,
+                                std::vector<FrameAnnotations>& annotations)
+{
+  annotations.assign(frameNames.size(), FrameAnnotations{});
+  std::size_t numBoxes {0};
+  std::size_t missing {0};
+  std::string text;
+  for (std::size_t i {0}; i < frameNames.size(); ++i)
+  {
+    const std::filesystem::path labelPath {std::filesystem::path(dir) /
+      std::filesystem::path(frameNames[i]).stem().concat(".txt")};
+    std::ifstream file {labelPath, std::ios::binary};
+    if (!file)
+    {
+      ++missing;  // no label file means no objects
+      continue;
+    }
+    text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    const float width {static_cast<float>(frameSizes[i].first)};
+    const float height {static_cast<float>(frameSizes[i].second)};
+    FrameAnnotations& gt {annotations[i]};
+    const char* cursor {text.c_str()};
+    while (*cursor != '\0')
+    {
+      char* end {nullptr};
+      const long classIdx {std::strtol(cursor, &end, 10)};
+      if (end == cursor)
+        break;
+
+      float values[4] {};
+      bool complete {true};
+      for (float& value : values)
+      {
+        cursor = end;
+        value = std::strtof(cursor, &end);
+        if (end == cursor)
+        {
+          complete = false;
+          break;
+        }
+      }
+      if (!complete)
+      {
+        spdlog::error("AnnotationLoader::loadYolo: malformed line in {}", labelPath.string());
+        return false;
+      }
+
+      // skip anything else on the line (e.g. segmentation points)
+      cursor = end;
+      while (*cursor != '\0' && *cursor != '\n')
+        ++cursor;
+
+      const float cx {values[0] * width};
+      const float cy {values[1] * height};
+      const float w {values[2] * width};
+      const float h {values[3] * height};
+      gt.m_boxes.push_back({cx - w / 2.0f, cy - h / 2.0f, cx + w / 2.0f, cy + h / 2.0f});
+      gt.m_classes.push_back(static_cast<int>(classIdx));
+      gt.m_crowd.push_back(false);
+      ++numBoxes;
+    }
+  }
+
+  if (missing > 0)
+    spdlog::warn("AnnotationLoader::loadYolo: {} of {} frames have no label file in {}",
+                 missing, frameNames.size(), dir);
+  spdlog::info("AnnotationLoader::loadYolo: {} boxes for {} frames from {}", numBoxes,
+               frameNames.size() - missing, dir);
+  return true;
+}
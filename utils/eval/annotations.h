@@ -0,0 +1,53 @@
+#pragma once
+
+#include "detection.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief AnnotationLoader reads object detection ground truth and lines it up with the
+ * dataset frames, frames without annotations get an empty entry
+ */
+struct AnnotationLoader
+{
+  /**
+   * @brief loads a COCO json file, or a directory of YOLO txt files
+   * @param path annotation file or directory
+   * @param frameNames dataset file names, in dataset order
+   * @param frameSizes dataset frame (width, height), in dataset order
+   * @param classNames model class names
+   * @param annotations output ground truth, one entry per frame
+   * @return true if successful, false otherwise
+   */
+  static bool load(const std::string& path, const std::vector<std::string>& frameNames,
+                   const std::vector<std::pair<int, int>>& frameSizes,
+                   const std::vector<std::string>& classNames,
+                   std::vector<FrameAnnotations>& annotations);
+
+  /**
+   * @brief loads a COCO json file. Images are matched by file name, categories are mapped
+   * to the class names by name, or in category id order if no name matches.
+   * @param path json file path
+   * @param frameNames dataset file names, in dataset order
+   * @param classNames model class names
+   * @param annotations output ground truth, one entry per frame
+   * @return true if successful, false otherwise
+   */
+  static bool loadCoco(const std::string& path, const std::vector<std::string>& frameNames,
+                       const std::vector<std::string>& classNames,
+                       std::vector<FrameAnnotations>& annotations);
+
+  /**
+   * @brief loads YOLO txt files (class cx cy w h, normalized) named after the frames
+   * @param dir label directory
+   * @param frameNames dataset file names, in dataset order
+   * @param frameSizes dataset frame (width, height), in dataset order
+   * @param annotations output ground truth, one entry per frame
+   * @return true if successful, false otherwise
+   */
+  static bool loadYolo(const std::string& dir, const std::vector<std::string>& frameNames,
+                       const std::vector<std::pair<int, int>>& frameSizes,
+                       std::vector<FrameAnnotations>& annotations);
+};
@@ -0,0 +1,233 @@
+#include "detection.h"
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <thread>
+
+namespace
+{
+/// \var IoU threshold t is 0.5 + 0.05 * t
+constexpr float iouThreshold(int t)
+{
+  return 0.5f + 0.05f * static_cast<float>(t);
+}
+
+/// \var number of recall points of COCO's interpolated precision
+constexpr int kNumRecallPoints {101};
+}
+
+DetectionEvaluator::DetectionEvaluator(std::size_t numClasses)
+  : m_matches(numClasses), m_numGroundTruth(numClasses, 0)
+{}
+
+float DetectionEvaluator::iou(const Box& a, const Box& b)
+{
+  const float width {std::min(a.m_x2, b.m_x2) - std::max(a.m_x1, b.m_x1)};
+  const float height {std::min(a.m_y2, b.m_y2) - std::max(a.m_y1, b.m_y1)};
+  if (width <= 0.0f || height <= 0.0f)
+    return 0.0f;
+
+  const float intersection {width * height};
+  return intersection / (a.area() + b.area() - intersection);
+}
+
+float DetectionEvaluator::iof(const Box& detection, const Box& crowd)
+{
+  const float width {std::min(detection.m_x2, crowd.m_x2) - std::max(detection.m_x1, crowd.m_x1)};
+  const float height {std::min(detection.m_y2, crowd.m_y2) - std::max(detection.m_y1, crowd.m_y1)};
+  if (width <= 0.0f || height <= 0.0f || detection.area() <= 0.0f)
+    return 0.0f;
+  return width * height / detection.area();
+}
+
+void DetectionEvaluator::addFrame(const std::vector<Box>& boxes, const std::vector<float>& scores,
+                                  const std::vector<int>& classes,
+                                  const FrameAnnotations& groundTruth)
+{
+  const int numClasses {static_cast<int>(m_matches.size())};
+  auto validClass = [numClasses](int classIdx) { return classIdx >= 0 && classIdx < numClasses; };
+
+  m_order.clear();
+  for (int i {0}; i < static_cast<int>(boxes.size()); ++i)
+    if (validClass(classes[i]))
+      m_order.push_back(i);
+  std::sort(m_order.begin(), m_order.end(), [&](int a, int b) {
+    return classes[a] != classes[b] ? classes[a] < classes[b] : scores[a] > scores[b];
+  });
+
+  m_gtOrder.clear();
+  for (int i {0}; i < static_cast<int>(groundTruth.m_boxes.size()); ++i)
+  {
+    if (!validClass(groundTruth.m_classes[i]))
+      continue;
+    m_gtOrder.push_back(i);
+    if (!groundTruth.m_crowd[i])
+      ++m_numGroundTruth[groundTruth.m_classes[i]];
+  }
+  std::sort(m_gtOrder.begin(), m_gtOrder.end(), [&](int a, int b) {
+    if (groundTruth.m_classes[a] != groundTruth.m_classes[b])
+      return groundTruth.m_classes[a] < groundTruth.m_classes[b];
+    return groundTruth.m_crowd[a] < groundTruth.m_crowd[b];
+  });
+
+  // walk the class runs of both sorted lists side by side
+  std::size_t gtBegin {0};
+  for (std::size_t detBegin {0}; detBegin < m_order.size();)
+  {
+    const int classIdx {classes[m_order[detBegin]]};
+    std::size_t detEnd {detBegin};
+    while (detEnd < m_order.size() && classes[m_order[detEnd]] == classIdx)
+      ++detEnd;
+    while (gtBegin < m_gtOrder.size() && groundTruth.m_classes[m_gtOrder[gtBegin]] < classIdx)
+      ++gtBegin;
+    std::size_t gtEnd {gtBegin};
+    while (gtEnd < m_gtOrder.size() && groundTruth.m_classes[m_gtOrder[gtEnd]] == classIdx)
+      ++gtEnd;
+
+    const std::size_t numGt {gtEnd - gtBegin};
+    std::vector<MatchEntry>& table {m_matches[classIdx]};
+    const std::size_t tableBegin {table.size()};
+    for (std::size_t d {detBegin}; d < detEnd; ++d)
+      table.push_back({scores[m_order[d]], 0, 0});
+
+    for (int t {0}; t < kNumIouThresholds; ++t)
+    {
+      m_gtMatched.assign(numGt, false);
+      for (std::size_t d {detBegin}; d < detEnd; ++d)
+      {
+        const Box& box {boxes[m_order[d]]};
+        MatchEntry& entry {table[tableBegin + d - detBegin]};
+
+        // greedy COCO matching: highest scoring detection takes the best unmatched gt
+        float bestIou {std::min(iouThreshold(t), 1.0f - 1e-10f)};
+        int best {-1};
+        bool crowd {false};
+        for (std::size_t g {0}; g < numGt; ++g)
+        {
+          const int gtIdx {m_gtOrder[gtBegin + g]};
+          if (groundTruth.m_crowd[gtIdx])
+          {
+            // crowd regions come last, stop once a real match was found
+            if (best >= 0)
+              break;
+            if (iof(box, groundTruth.m_boxes[gtIdx]) >= iouThreshold(t))
+            {
+              crowd = true;
+              break;
+            }
+            continue;
+          }
+          if (m_gtMatched[g])
+            continue;
+
+          const float overlap {iou(box, groundTruth.m_boxes[gtIdx])};
+          if (overlap >= bestIou)
+          {
+            bestIou = overlap;
+            best = static_cast<int>(g);
+          }
+        }
+
+        if (best >= 0)
+        {
+          m_gtMatched[best] = true;
+          entry.m_tpMask |= static_cast<std::uint16_t>(1u << t);
+        }
+        else if (crowd)
+          entry.m_ignoreMask |= static_cast<std::uint16_t>(1u << t);
+      }
+    }
+    detBegin = detEnd;
+  }
+}
+
+void DetectionEvaluator::computeClass(std::size_t classIdx,
+                                      std::array<double, kNumIouThresholds>& ap) const
+{
+  ap.fill(-1.0);
+  const std::uint64_t numGt {m_numGroundTruth[classIdx]};
+  if (numGt == 0)
+    return;
+
+  std::vector<MatchEntry> entries {m_matches[classIdx]};
+  std::stable_sort(entries.begin(), entries.end(),
+    [](const MatchEntry& a, const MatchEntry& b) { return a.m_score > b.m_score; });
+
+  std::vector<double> precision;
+  std::vector<double> recall;
+  precision.reserve(entries.size());
+  recall.reserve(entries.size());
+  for (int t {0}; t < kNumIouThresholds; ++t)
+  {
+    precision.clear();
+    recall.clear();
+    std::uint64_t tp {0};
+    std::uint64_t fp {0};
+    for (const MatchEntry& entry : entries)
+    {
+      if (entry.m_ignoreMask & (1u << t))
+        continue;
+      if (entry.m_tpMask & (1u << t))
+        ++tp;
+      else
+        ++fp;
+      precision.push_back(static_cast<double>(tp) / static_cast<double>(tp + fp));
+      recall.push_back(static_cast<double>(tp) / static_cast<double>(numGt));
+    }
+
+    // precision envelope, then sample it at the recall points
+    for (std::size_t i {precision.size()}; i-- > 1;)
+      precision[i - 1] = std::max(precision[i - 1], precision[i]);
+
+    double sum {0.0};
+    for (int r {0}; r < kNumRecallPoints; ++r)
+    {
+      const double target {static_cast<double>(r) / (kNumRecallPoints - 1)};
+      const auto it {std::lower_bound(recall.begin(), recall.end(), target)};
+      if (it != recall.end())
+        sum += precision[static_cast<std::size_t>(it - recall.begin())];
+    }
+    ap[t] = sum / kNumRecallPoints;
+  }
+}
+
+void DetectionEvaluator::compute(DetectionMetrics& metrics) const
+{
+  const std::size_t numClasses {m_matches.size()};
+  std::vector<std::array<double, kNumIouThresholds>> ap(numClasses);
+
+  std::atomic<std::size_t> next {0};
+  auto worker = [&] {
+    for (std::size_t c {next++}; c < numClasses; c = next++)
+      computeClass(c, ap[c]);
+  };
+  const std::size_t numThreads {std::clamp<std::size_t>(
+    std::thread::hardware_concurrency(), 1, std::max<std::size_t>(numClasses, 1))};
+  std::vector<std::thread> threads;
+  for (std::size_t i {1}; i < numThreads; ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (std::thread& thread : threads)
+    thread.join();
+
+  metrics = DetectionMetrics{};
+  metrics.m_ap5095.assign(numClasses, -1.0);
+  std::array<double, kNumIouThresholds> sums {};
+  for (std::size_t c {0}; c < numClasses; ++c)
+  {
+    if (ap[c][0] < 0.0)
+      continue;
+    ++metrics.m_evaluatedClasses;
+    for (int t {0}; t < kNumIouThresholds; ++t)
+      sums[t] += ap[c][t];
+    metrics.m_ap5095[c] = std::accumulate(ap[c].begin(), ap[c].end(), 0.0) / kNumIouThresholds;
+  }
+  if (metrics.m_evaluatedClasses == 0)
+    return;
+
+  const double classes {static_cast<double>(metrics.m_evaluatedClasses)};
+  metrics.m_map50 = sums[0] / classes;
+  metrics.m_map75 = sums[5] / classes;
+  metrics.m_map5095 = std::accumulate(sums.begin(), sums.end(), 0.0) / classes / kNumIouThresholds;
+}
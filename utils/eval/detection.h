@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Box is an axis aligned box in pixel coordinates
+ */
+struct Box
+{
+  float m_x1 {0.0f};                      /// \var left
+  float m_y1 {0.0f};                      /// \var top
+  float m_x2 {0.0f};                      /// \var right
+  float m_y2 {0.0f};                      /// \var bottom
+
+  float area() const
+  {
+    return (m_x2 > m_x1 && m_y2 > m_y1) ? (m_x2 - m_x1) * (m_y2 - m_y1) : 0.0f;
+  }
+};
+
+/**
+ * @brief FrameAnnotations holds the ground truth boxes of one frame
+ */
+struct FrameAnnotations
+{
+  std::vector<Box> m_boxes;               /// \var ground truth boxes
+  std::vector<int> m_classes;             /// \var class index per box
+  std::vector<bool> m_crowd;              /// \var crowd regions are ignored, not matched
+};
+
+/**
+ * @brief DetectionMetrics holds the COCO-style average precision results
+ */
+struct DetectionMetrics
+{
+  double m_map50 {0.0};                   /// \var mAP at IoU 0.5
+  double m_map75 {0.0};                   /// \var mAP at IoU 0.75
+  double m_map5095 {0.0};                 /// \var mAP averaged over IoU 0.5:0.05:0.95
+  std::vector<double> m_ap5095;           /// \var per class AP@0.5:0.95, -1 without gt
+  int m_evaluatedClasses {0};             /// \var classes with at least one gt box
+};
+
+/**
+ * @brief DetectionEvaluator accumulates detections frame by frame into a compact per class
+ * match table (score + tp/ignore bits for the ten COCO IoU thresholds), so no detection
+ * has to be kept for the whole dataset. AP is computed with COCO's 101-point interpolation.
+ */
+class DetectionEvaluator
+{
+public:
+  static constexpr int kNumIouThresholds {10};  /// \var 0.50, 0.55, ..., 0.95
+
+private:
+  /**
+   * @brief one detection of the match table
+   */
+  struct MatchEntry
+  {
+    float m_score;                        /// \var detection confidence
+    std::uint16_t m_tpMask;               /// \var bit t set: true positive at threshold t
+    std::uint16_t m_ignoreMask;           /// \var bit t set: matched a crowd region
+  };
+
+  std::vector<std::vector<MatchEntry>> m_matches;   /// \var per class match table
+  std::vector<std::uint64_t> m_numGroundTruth;      /// \var per class non-crowd gt count
+
+  std::vector<int> m_order;               /// \var scratch: detections by class, then score
+  std::vector<int> m_gtOrder;             /// \var scratch: gt by class, crowd regions last
+  std::vector<bool> m_gtMatched;          /// \var scratch: gt already matched at a threshold
+
+  /**
+   * @brief computes AP@0.5:0.95 components of one class
+   * @param classIdx class index
+   * @param ap output ap per IoU threshold
+   */
+  void computeClass(std::size_t classIdx, std::array<double, kNumIouThresholds>& ap) const;
+
+public:
+  /**
+   * @param numClasses number of classes
+   */
+  explicit DetectionEvaluator(std::size_t numClasses);
+
+  /**
+   * @brief matches the detections of one frame against its ground truth
+   * @param boxes detected boxes
+   * @param scores detection confidences
+   * @param classes detected class indices
+   * @param groundTruth ground truth of the frame
+   */
+  void addFrame(const std::vector<Box>& boxes, const std::vector<float>& scores,
+                const std::vector<int>& classes, const FrameAnnotations& groundTruth);
+
+  /**
+   * @brief computes the metrics, classes are evaluated in parallel
+   * @param metrics output metrics
+   */
+  void compute(DetectionMetrics& metrics) const;
+
+  /**
+   * @brief intersection over union of two boxes
+   */
+  static float iou(const Box& a, const Box& b);
+
+  /**
+   * @brief intersection over the detection area, used against crowd regions
+   */
+  static float iof(const Box& detection, const Box& crowd);
+};
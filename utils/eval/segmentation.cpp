@@ -0,0 +1,125 @@
+#include "segmentation.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace
+{
+/// \var pixels per index block, small enough to stay in L1
+constexpr int kBlockSize {256};
+
+/// \var frames below this size are not worth splitting into bands
+constexpr std::size_t kMinParallelPixels {1u << 18};
+}
+
+SegmentationEvaluator::SegmentationEvaluator(std::size_t numClasses, unsigned int numThreads)
+  : m_numClasses(std::min<std::size_t>(numClasses, kIgnoreLabel))
+{
+  if (numThreads == 0)
+    numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  m_partials.assign(numThreads, std::vector<std::uint64_t>(m_numClasses * m_numClasses + 1, 0));
+}
+
+void SegmentationEvaluator::addRows(std::vector<std::uint64_t>& counts,
+                                    const std::uint8_t* prediction, std::size_t predictionStep,
+                                    const std::uint8_t* groundTruth, std::size_t groundTruthStep,
+                                    int width, int firstRow, int lastRow) const
+{
+  const std::uint32_t numClasses {static_cast<std::uint32_t>(m_numClasses)};
+  const std::uint32_t ignoreBin {numClasses * numClasses};
+  std::uint32_t bins[kBlockSize];
+  for (int y {firstRow}; y < lastRow; ++y)
+  {
+    const std::uint8_t* predictionRow {prediction + y * predictionStep};
+    const std::uint8_t* groundTruthRow {groundTruth + y * groundTruthStep};
+    for (int x {0}; x < width; x += kBlockSize)
+    {
+      const int block {std::min(kBlockSize, width - x)};
+
+      // branchless bin computation, vectorized by the compiler; ignored pixels share a bin
+      for (int i {0}; i < block; ++i)
+      {
+        const std::uint32_t gt {groundTruthRow[x + i]};
+        const std::uint32_t pred {predictionRow[x + i]};
+        bins[i] = (gt < numClasses && pred < numClasses) ? gt * numClasses + pred : ignoreBin;
+      }
+      for (int i {0}; i < block; ++i)
+        ++counts[bins[i]];
+    }
+  }
+}
+
+void SegmentationEvaluator::addFrame(const std::uint8_t* prediction, std::size_t predictionStep,
+                                     const std::uint8_t* groundTruth,
+                                     std::size_t groundTruthStep, int width, int height)
+{
+  const std::size_t pixels {static_cast<std::size_t>(width) * static_cast<std::size_t>(height)};
+  const int numBands {pixels < kMinParallelPixels ? 1 :
+                      std::min(static_cast<int>(m_partials.size()), height)};
+  if (numBands <= 1)
+  {
+    addRows(m_partials[0], prediction, predictionStep, groundTruth, groundTruthStep, width, 0,
+            height);
+    return;
+  }
+
+  std::vector<std::thread> threads;
+  threads.reserve(numBands - 1);
+  const int rowsPerBand {(height + numBands - 1) / numBands};
+  for (int band {1}; band < numBands; ++band)
+  {
+    const int firstRow {band * rowsPerBand};
+    const int lastRow {std::min(height, firstRow + rowsPerBand)};
+    threads.emplace_back([&, band, firstRow, lastRow] {
+      addRows(m_partials[band], prediction, predictionStep, groundTruth, groundTruthStep, width,
+              firstRow, lastRow);
+    });
+  }
+  addRows(m_partials[0], prediction, predictionStep, groundTruth, groundTruthStep, width, 0,
+          std::min(height, rowsPerBand));
+  for (std::thread& thread : threads)
+    thread.join();
+}
+
+void SegmentationEvaluator::compute(SegmentationMetrics& metrics) const
+{
+  const std::size_t numClasses {m_numClasses};
+  std::vector<std::uint64_t> counts(numClasses * numClasses, 0);
+  for (const std::vector<std::uint64_t>& partial : m_partials)
+    for (std::size_t i {0}; i < counts.size(); ++i)
+      counts[i] += partial[i];
+
+  // rows are ground truth, columns are predictions
+  std::vector<std::uint64_t> groundTruthTotal(numClasses, 0);
+  std::vector<std::uint64_t> predictionTotal(numClasses, 0);
+  std::uint64_t correct {0};
+  for (std::size_t gt {0}; gt < numClasses; ++gt)
+  {
+    for (std::size_t pred {0}; pred < numClasses; ++pred)
+    {
+      const std::uint64_t count {counts[gt * numClasses + pred]};
+      groundTruthTotal[gt] += count;
+      predictionTotal[pred] += count;
+    }
+    correct += counts[gt * numClasses + gt];
+  }
+
+  metrics = SegmentationMetrics{};
+  metrics.m_iou.assign(numClasses, -1.0);
+  double iouSum {0.0};
+  for (std::size_t c {0}; c < numClasses; ++c)
+  {
+    metrics.m_pixels += groundTruthTotal[c];
+    const std::uint64_t intersection {counts[c * numClasses + c]};
+    const std::uint64_t unite {groundTruthTotal[c] + predictionTotal[c] - intersection};
+    if (unite == 0)
+      continue;
+    metrics.m_iou[c] = static_cast<double>(intersection) / static_cast<double>(unite);
+    iouSum += metrics.m_iou[c];
+    ++metrics.m_evaluatedClasses;
+  }
+  if (metrics.m_pixels > 0)
+    metrics.m_pixelAccuracy = static_cast<double>(correct) / static_cast<double>(metrics.m_pixels);
+  if (metrics.m_evaluatedClasses > 0)
+    metrics.m_meanIou = iouSum / metrics.m_evaluatedClasses;
+}
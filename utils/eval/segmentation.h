@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief SegmentationMetrics holds the semantic segmentation accuracy results
+ */
+struct SegmentationMetrics
+{
+  double m_pixelAccuracy {0.0};           /// \var correctly labelled / evaluated pixels
+  double m_meanIou {0.0};                 /// \var mean IoU over classes present in gt or output
+  std::vector<double> m_iou;              /// \var per class IoU, -1 if the class never appeared
+  std::uint64_t m_pixels {0};             /// \var evaluated (non-ignored) pixels
+  int m_evaluatedClasses {0};             /// \var classes contributing to the mean IoU
+};
+
+/**
+ * @brief SegmentationEvaluator accumulates label masks into a classes x classes confusion
+ * matrix, so evaluation is O(pixels) and no per-frame output is retained. Large frames are
+ * split into row bands, every band thread owns a partial matrix that is merged at the end.
+ */
+class SegmentationEvaluator
+{
+public:
+  static constexpr std::uint8_t kIgnoreLabel {255};  /// \var gt label excluded from metrics
+
+private:
+  std::size_t m_numClasses;                           /// \var number of classes
+  std::vector<std::vector<std::uint64_t>> m_partials; /// \var per thread (gt x pred) counters
+
+  /**
+   * @brief accumulates a band of rows into one partial matrix
+   * @param counts partial matrix, with one extra bin for ignored pixels
+   */
+  void addRows(std::vector<std::uint64_t>& counts, const std::uint8_t* prediction,
+               std::size_t predictionStep, const std::uint8_t* groundTruth,
+               std::size_t groundTruthStep, int width, int firstRow, int lastRow) const;
+
+public:
+  /**
+   * @param numClasses number of classes, at most 255
+   * @param numThreads band threads for large frames, 0 = hardware concurrency
+   */
+  explicit SegmentationEvaluator(std::size_t numClasses, unsigned int numThreads = 0);
+
+  /**
+   * @brief accumulates one frame, both masks hold one class index byte per pixel
+   * @param prediction predicted label mask
+   * @param predictionStep bytes per prediction row
+   * @param groundTruth ground truth label mask, kIgnoreLabel or out of range labels are skipped
+   * @param groundTruthStep bytes per ground truth row
+   * @param width mask width
+   * @param height mask height
+   */
+  void addFrame(const std::uint8_t* prediction, std::size_t predictionStep,
+                const std::uint8_t* groundTruth, std::size_t groundTruthStep,
+                int width, int height);
+
+  /**
+   * @brief merges the per thread matrices and computes the metrics
+   * @param metrics output metrics
+   */
+  void compute(SegmentationMetrics& metrics) const;
+};
@@ -0,0 +1,110 @@
+/*
+  Replaces the global operator new/delete to count heap allocations. This file is only
+  compiled into the executables when configured with -DENABLE_ALLOC_HOOK=ON, it must not
+  be part of a static library because the linker would never pull it in.
+*/
+#include "memory.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+
+const bool g_installed {[] {
+  MemoryProbe::m_hookInstalled.store(true, std::memory_order_relaxed);
+  return true;
+}()};
+
+inline void countAllocation(std::size_t size) noexcept
+{
+  MemoryProbe::m_allocCount.fetch_add(1, std::memory_order_relaxed);
+  MemoryProbe::m_allocBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void* allocate(std::size_t size)
+{
+  countAllocation(size);
+  for (;;)
+  {
+    if (void* ptr {std::malloc(size == 0 ? 1 : size)})
+      return ptr;
+
+    std::new_handler handler {std::get_new_handler()};
+    if (handler == nullptr)
+      throw std::bad_alloc();
+    handler();
+  }
+}
+
+void* allocateAligned(std::size_t size, std::align_val_t alignment)
+{
+  countAllocation(size);
+  const std::size_t align {static_cast<std::size_t>(alignment)};
+  // aligned_alloc requires the size to be a multiple of the alignment
+  const std::size_t padded {(size + align - 1) / align * align};
+  for (;;)
+  {
+    if (void* ptr {std::aligned_alloc(align, padded == 0 ? align : padded)})
+      return ptr;
+
+    std::new_handler handler {std::get_new_handler()};
+    if (handler == nullptr)
+      throw std::bad_alloc();
+    handler();
+  }
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+  try { return allocate(size); } catch (...) { return nullptr; }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+  try { return allocate(size); } catch (...) { return nullptr; }
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+  return allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+  return allocateAligned(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+  try { return allocateAligned(size, alignment); } catch (...) { return nullptr; }
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+  try { return allocateAligned(size, alignment); } catch (...) { return nullptr; }
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+  std::free(ptr);
+}
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+  std::free(ptr);
+}
@@ -0,0 +1,98 @@
+#include "memory.h"
+
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MemorySnapshot MemoryProbe::takeSnapshot()
+{
+  MemorySnapshot snapshot;
+
+  // ru_maxrss is reported in kilobytes on linux
+  rusage usage {};
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+    snapshot.m_peakRssKb = usage.ru_maxrss;
+
+  // statm: size resident shared text lib data dt (in pages)
+  std::ifstream statm("/proc/self/statm");
+  long size {0};
+  long resident {0};
+  if (statm >> size >> resident)
+    snapshot.m_rssKb = resident * (sysconf(_SC_PAGESIZE) / 1024);
+
+  return snapshot;
+}
+
+std::size_t MemoryProbe::residentBytes(const void* addr, std::size_t length)
+{
+  if (addr == nullptr || length == 0)
+    return 0;
+
+  const std::size_t pageSize {static_cast<std::size_t>(sysconf(_SC_PAGESIZE))};
+  const std::uintptr_t begin {reinterpret_cast<std::uintptr_t>(addr) & ~(pageSize - 1)};
+  const std::uintptr_t end {reinterpret_cast<std::uintptr_t>(addr) + length};
+  const std::size_t numPages {(end - begin + pageSize - 1) / pageSize};
+
+  std::vector<unsigned char> pages(numPages);
+  if (mincore(reinterpret_cast<void*>(begin), end - begin, pages.data()) != 0)
+    return 0;
+
+  std::size_t resident {0};
+  for (unsigned char page : pages)
+    resident += page & 1u;
+  return resident * pageSize;
+}
+
+std::size_t MemoryProbe::fileSize(const std::string& path)
+{
+  struct stat info {};
+  if (stat(path.c_str(), &info) != 0)
+    return 0;
+  return static_cast<std::size_t>(info.st_size);
+}
+
+AllocCounters MemoryProbe::allocCounters()
+{
+  return AllocCounters{m_allocCount.load(std::memory_order_relaxed),
+                       m_allocBytes.load(std::memory_order_relaxed)};
+}
+
+void MemoryProbe::printSummary(const MemoryStats& stats)
+{
+  constexpr double kMb {1024.0 * 1024.0};
+
+  std::cout << "--- Memory Summary ---\n";
+  std::cout.precision(2);
+  std::cout << std::fixed;
+
+  std::cout << "Startup:\n"
+            << "  RSS:      " << stats.m_startup.m_rssKb / 1024.0 << " MB\n"
+            << "  Peak RSS: " << stats.m_startup.m_peakRssKb / 1024.0 << " MB\n"
+            << "Steady state:\n"
+            << "  RSS:      " << stats.m_steadyState.m_rssKb / 1024.0 << " MB\n"
+            << "  Peak RSS: " << stats.m_steadyState.m_peakRssKb / 1024.0 << " MB\n"
+            << "Engine:\n"
+            << "  Arena:            " << stats.m_arenaBytes / kMb << " MB\n"
+            << "  Persistent arena: " << stats.m_arenaPersistentBytes / kMb << " MB\n"
+            << "  Model file:       " << stats.m_modelFileBytes / kMb << " MB\n"
+            << "  Model resident:   " << stats.m_modelResidentBytes / kMb << " MB\n";
+
+  if (!stats.m_allocHookInstalled)
+  {
+    std::cout << "Heap allocations: not counted (configure with -DENABLE_ALLOC_HOOK=ON)\n";
+    return;
+  }
+
+  const double frames {stats.m_steadyFrames == 0 ? 1.0 : static_cast<double>(stats.m_steadyFrames)};
+  std::cout << "Heap allocations:\n"
+            << "  Init:        " << stats.m_initAllocs.m_count << " allocs, "
+            << stats.m_initAllocs.m_bytes / kMb << " MB\n"
+            << "  First frame: " << stats.m_firstFrameAllocs.m_count << " allocs, "
+            << stats.m_firstFrameAllocs.m_bytes / 1024.0 << " KB\n"
+            << "  Per frame:   " << stats.m_steadyAllocs.m_count / frames << " allocs, "
+            << stats.m_steadyAllocs.m_bytes / frames / 1024.0 << " KB\n";
+}
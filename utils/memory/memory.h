@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief MemorySnapshot holds the process memory usage at a point in time
+ */
+struct MemorySnapshot
+{
+  long m_rssKb {0};                           /// \var current resident set size
+  long m_peakRssKb {0};                       /// \var peak resident set size so far
+};
+
+/**
+ * @brief AllocCounters holds the heap allocation totals counted by the operator new hook
+ */
+struct AllocCounters
+{
+  std::uint64_t m_count {0};                  /// \var number of allocations
+  std::uint64_t m_bytes {0};                  /// \var requested bytes
+};
+
+/**
+ * @brief MemoryStats collects the memory footprint of one benchmark run
+ */
+struct MemoryStats
+{
+  MemorySnapshot m_startup;                   /// \var after engine initialization
+  MemorySnapshot m_steadyState;               /// \var after the last frame
+
+  std::size_t m_arenaBytes {0};               /// \var engine tensor arena size
+  std::size_t m_arenaPersistentBytes {0};     /// \var engine persistent arena size
+  std::size_t m_modelFileBytes {0};           /// \var model file size on disk
+  std::size_t m_modelResidentBytes {0};       /// \var resident pages of the mapped model
+
+  AllocCounters m_initAllocs;                 /// \var allocations during engine init
+  AllocCounters m_firstFrameAllocs;           /// \var allocations of the first frame
+  AllocCounters m_steadyAllocs;               /// \var allocations of the remaining frames
+  std::uint64_t m_steadyFrames {0};           /// \var number of steady state frames
+  bool m_allocHookInstalled {false};          /// \var allocation counters are valid
+};
+
+/**
+ * @brief MemoryProbe reads process, mapping and heap allocation statistics
+ */
+struct MemoryProbe
+{
+  /**
+   * @brief reads the current and peak resident set size of the process
+   * @return memory snapshot
+   */
+  static MemorySnapshot takeSnapshot();
+
+  /**
+   * @brief counts the bytes of the given mapping that are resident in memory
+   * @param addr start address of the mapping
+   * @param length length of the mapping in bytes
+   * @return resident bytes, 0 if unknown
+   */
+  static std::size_t residentBytes(const void* addr, std::size_t length);
+
+  /**
+   * @brief returns the size of the given file
+   * @param path file path
+   * @return size in bytes, 0 if the file could not be read
+   */
+  static std::size_t fileSize(const std::string& path);
+
+  /**
+   * @brief reads the allocation totals counted by the operator new hook
+   * @return allocation counters
+   */
+  static AllocCounters allocCounters();
+
+  /**
+   * @brief prints a summary of the given memory statistics
+   * @param stats memory statistics
+   */
+  static void printSummary(const MemoryStats& stats);
+
+  static std::atomic<std::uint64_t> m_allocCount;   /// \var counted allocations
+  static std::atomic<std::uint64_t> m_allocBytes;   /// \var counted bytes
+  static std::atomic<bool> m_hookInstalled;          /// \var set by the allocation hook
+};
+
+inline std::atomic<std::uint64_t> MemoryProbe::m_allocCount {0};
+inline std::atomic<std::uint64_t> MemoryProbe::m_allocBytes {0};
+inline std::atomic<bool> MemoryProbe::m_hookInstalled {false};
+
+/**
+ * @brief subtracts two allocation counter readings
+ */
+inline AllocCounters operator-(const AllocCounters& lhs, const AllocCounters& rhs)
+{
+  return AllocCounters{lhs.m_count - rhs.m_count, lhs.m_bytes - rhs.m_bytes};
+}
+
+/**
+ * @brief accumulates allocation counter deltas
+ */
+inline AllocCounters& operator+=(AllocCounters& lhs, const AllocCounters& rhs)
+{
+  lhs.m_count += rhs.m_count;
+  lhs.m_bytes += rhs.m_bytes;
+  return lhs;
+}
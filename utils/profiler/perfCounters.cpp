@@ -0,0 +1,213 @@
+#include "perfCounters.h"
+
+#include <spdlog/spdlog.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace
+{
+
+#ifdef __linux__
+
+/**
+ * @brief per-thread perf counter group, closed when the owning thread exits
+ */
+struct ThreadGroup
+{
+  int m_leaderFd {-1};                                  /// \var group leader fd
+  std::array<int, kNumPerfEvents> m_fds;                /// \var event fds, -1 if unavailable
+  std::array<int, kNumPerfEvents> m_slots;              /// \var index in the group read
+  int m_numOpen {0};                                    /// \var number of opened events
+  bool m_tried {false};                                 /// \var open was attempted
+
+  ThreadGroup()
+  {
+    m_fds.fill(-1);
+    m_slots.fill(-1);
+  }
+
+  ~ThreadGroup()
+  {
+    for (int fd : m_fds)
+      if (fd != -1)
+        close(fd);
+  }
+
+  bool open();
+};
+
+void fillAttribute(PerfEvent event, perf_event_attr& attr)
+{
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  switch (event)
+  {
+    case PerfEvent::CYCLES:
+      attr.config = PERF_COUNT_HW_CPU_CYCLES;
+      break;
+    case PerfEvent::INSTRUCTIONS:
+      attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+      break;
+    case PerfEvent::CACHE_MISSES:
+      attr.config = PERF_COUNT_HW_CACHE_MISSES;
+      break;
+    case PerfEvent::BRANCH_MISSES:
+      attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+      break;
+    case PerfEvent::PAGE_FAULTS:
+      attr.type = PERF_TYPE_SOFTWARE;
+      attr.config = PERF_COUNT_SW_PAGE_FAULTS;
+      break;
+    default:
+      break;
+  }
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+}
+
+bool ThreadGroup::open()
+{
+  m_tried = true;
+  for (std::size_t i {0}; i < kNumPerfEvents; ++i)
+  {
+    perf_event_attr attr;
+    fillAttribute(static_cast<PerfEvent>(i), attr);
+    attr.disabled = m_leaderFd == -1 ? 1 : 0;
+
+    // pid = 0, cpu = -1: count the calling thread on any cpu
+    const int fd {static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, m_leaderFd, 0))};
+    if (fd == -1)
+    {
+      spdlog::debug("PerfCounters: could not open {} counter: {}",
+        PerfCounters::eventName(static_cast<PerfEvent>(i)), std::strerror(errno));
+      continue;
+    }
+
+    if (m_leaderFd == -1)
+      m_leaderFd = fd;
+    m_fds[i] = fd;
+    m_slots[i] = m_numOpen++;
+  }
+
+  if (m_leaderFd == -1)
+    return false;
+
+  ioctl(m_leaderFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(m_leaderFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  return true;
+}
+
+thread_local ThreadGroup t_group;
+
+#endif
+
+}  // namespace
+
+bool PerfCounters::enable()
+{
+#ifdef __linux__
+  if (!t_group.m_tried)
+    t_group.open();
+
+  std::uint32_t available {0};
+  for (std::size_t i {0}; i < kNumPerfEvents; ++i)
+    if (t_group.m_fds[i] != -1)
+      available |= 1u << i;
+  m_available.store(available, std::memory_order_relaxed);
+
+  if (t_group.m_leaderFd == -1)
+  {
+    spdlog::warn("PerfCounters::enable: perf_event_open is not permitted on this system "
+                 "(check /proc/sys/kernel/perf_event_paranoid or container seccomp profile)");
+    m_enabled.store(false, std::memory_order_relaxed);
+    return false;
+  }
+
+  for (std::size_t i {0}; i < kNumPerfEvents; ++i)
+    if (t_group.m_fds[i] == -1)
+      spdlog::warn("PerfCounters::enable: {} counter is unavailable",
+        eventName(static_cast<PerfEvent>(i)));
+
+  m_enabled.store(true, std::memory_order_relaxed);
+  return true;
+#else
+  spdlog::warn("PerfCounters::enable: hardware counters are only supported on linux");
+  return false;
+#endif
+}
+
+void PerfCounters::disable()
+{
+  m_enabled.store(false, std::memory_order_relaxed);
+}
+
+bool PerfCounters::isAvailable(PerfEvent event)
+{
+  return (m_available.load(std::memory_order_relaxed) >> static_cast<std::uint32_t>(event)) & 1u;
+}
+
+bool PerfCounters::read(PerfSample& sample)
+{
+#ifdef __linux__
+  if (!t_group.m_tried)
+    t_group.open();
+
+  if (t_group.m_leaderFd == -1)
+    return false;
+
+  // layout for PERF_FORMAT_GROUP: nr, time_enabled, time_running, values[nr]
+  std::array<std::uint64_t, 3 + kNumPerfEvents> buffer {};
+  const ssize_t expected {static_cast<ssize_t>((3 + t_group.m_numOpen) * sizeof(std::uint64_t))};
+  if (::read(t_group.m_leaderFd, buffer.data(), sizeof(buffer)) < expected)
+    return false;
+
+  const std::uint64_t enabled {buffer[1]};
+  const std::uint64_t running {buffer[2]};
+  for (std::size_t i {0}; i < kNumPerfEvents; ++i)
+  {
+    if (t_group.m_slots[i] == -1)
+    {
+      sample.m_values[i] = 0;
+      continue;
+    }
+
+    std::uint64_t value {buffer[3 + t_group.m_slots[i]]};
+    // scale when the kernel had to multiplex the group with other users of the pmu
+    if (running != 0 && running < enabled)
+      value = static_cast<std::uint64_t>(static_cast<double>(value) * enabled / running);
+    sample.m_values[i] = value;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+const char* PerfCounters::eventName(PerfEvent event)
+{
+  switch (event)
+  {
+    case PerfEvent::CYCLES:
+      return "cycles";
+    case PerfEvent::INSTRUCTIONS:
+      return "instructions";
+    case PerfEvent::CACHE_MISSES:
+      return "cache-misses";
+    case PerfEvent::BRANCH_MISSES:
+      return "branch-misses";
+    case PerfEvent::PAGE_FAULTS:
+      return "page-faults";
+    default:
+      return "unknown";
+  }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief PerfEvent defines the hardware/software events sampled around each profiled zone
+ */
+enum class PerfEvent {CYCLES, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, PAGE_FAULTS, COUNT};
+
+constexpr std::size_t kNumPerfEvents {static_cast<std::size_t>(PerfEvent::COUNT)};
+
+/**
+ * @brief PerfSample holds one reading (or a delta) of every event in the counter group
+ */
+struct PerfSample
+{
+  std::array<std::uint64_t, kNumPerfEvents> m_values {};   /// \var counter values
+
+  std::uint64_t& operator[](PerfEvent event)
+  {
+    return m_values[static_cast<std::size_t>(event)];
+  }
+
+  std::uint64_t operator[](PerfEvent event) const
+  {
+    return m_values[static_cast<std::size_t>(event)];
+  }
+};
+
+/**
+ * @brief PerfCounters is a thin wrapper around linux perf_event_open. Every thread lazily
+ * opens its own counter group (leader + siblings, read atomically with PERF_FORMAT_GROUP),
+ * counting user-space events of that thread only. When the kernel or container refuses
+ * an event it is skipped and reported as unavailable instead of failing the run.
+ */
+class PerfCounters
+{
+  static std::atomic<bool> m_enabled;             /// \var counters requested and usable
+  static std::atomic<std::uint32_t> m_available;  /// \var bitmask of events opened on probe
+
+public:
+  /**
+   * @brief probes the counter group on the calling thread and enables sampling
+   * @return true if at least one event could be opened, false otherwise
+   */
+  static bool enable();
+
+  /**
+   * @brief disables sampling, already opened groups stay open until thread exit
+   */
+  static void disable();
+
+  /**
+   * @brief checks whether sampling is enabled
+   * @return true if enabled, false otherwise
+   */
+  static bool isEnabled() { return m_enabled.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief checks whether the given event was available when probing
+   * @param event perf event
+   * @return true if available, false otherwise
+   */
+  static bool isAvailable(PerfEvent event);
+
+  /**
+   * @brief reads the counter group of the calling thread, opens it on first use
+   * @param sample output sample
+   * @return true if successful, false otherwise
+   */
+  static bool read(PerfSample& sample);
+
+  /**
+   * @brief returns a printable name of the given event
+   * @param event perf event
+   * @return event name
+   */
+  static const char* eventName(PerfEvent event);
+};
+
+inline std::atomic<bool> PerfCounters::m_enabled {false};
+inline std::atomic<std::uint32_t> PerfCounters::m_available {0};
@@ -2,17 +2,33 @@
 
 #include <iostream>
 
-Profiler::Profiler(const char* funcName) noexcept 
-  : m_start {profiling::Clock::now()}
+Profiler::Profiler(const char* funcName) noexcept
+  : m_start {}
   , m_end {}
   , m_funcName {funcName}
-{}
+{
+  // read the counters first so the syscall is not part of the measured time
+  if (PerfCounters::isEnabled())
+    m_hasCounters = PerfCounters::read(m_startCounters);
+  m_start = profiling::Clock::now();
+}
 
 Profiler::~Profiler()
 {
   m_end = profiling::Clock::now();
-  auto duration {std::chrono::duration_cast<std::chrono::milliseconds>(m_end - m_start)};
-  Storage::addData(m_funcName, duration.count());
+  auto duration {std::chrono::duration_cast<std::chrono::microseconds>(m_end - m_start)};
+
+  PerfSample endCounters;
+  if (m_hasCounters && PerfCounters::read(endCounters))
+  {
+    for (std::size_t i {0}; i < kNumPerfEvents; ++i)
+      endCounters.m_values[i] -= m_startCounters.m_values[i];
+    Storage::addData(m_funcName, duration.count(), &endCounters);
+  }
+  else
+  {
+    Storage::addData(m_funcName, duration.count());
+  }
 }
 
 double Result::calculateAverageTime() const
@@ -22,11 +38,28 @@ double Result::calculateAverageTime() const
     return 0.0;
   }
 
-  return m_totalTime / (double)m_numCalls;
+  return m_totalTime / 1000.0 / (double)m_numCalls;
+}
+
+double Result::calculateIpc() const
+{
+  if (m_counters[PerfEvent::CYCLES] == 0)
+    return 0.0;
+
+  return m_counters[PerfEvent::INSTRUCTIONS] / (double)m_counters[PerfEvent::CYCLES];
+}
+
+double Result::calculatePerCall(PerfEvent event) const
+{
+  if (m_numCounterCalls == 0)
+    return 0.0;
+
+  return m_counters[event] / (double)m_numCounterCalls;
 }
 
 void Storage::printSummary()
 {
+  std::lock_guard<std::mutex> lock {m_mtx};
   std::cout << "--- Profiler Summary ---\n";
   std::cout.precision(4); // Set decimal places
   std::cout << std::fixed;
@@ -36,12 +69,53 @@ void Storage::printSummary()
     std::cout << name << ": \n"
 	      << "  Calls: " << result.m_numCalls << "\n"
 	      << "  Avg:   " << result.calculateAverageTime() << " ms\n"
-	      << "  Total: " << (result.m_totalTime) << " ms\n";
-  } 
+	      << "  Total: " << (result.m_totalTime / 1000.0) << " ms\n";
+
+    if (result.m_numCounterCalls == 0)
+      continue;
+
+    if (PerfCounters::isAvailable(PerfEvent::CYCLES) &&
+        PerfCounters::isAvailable(PerfEvent::INSTRUCTIONS))
+      std::cout << "  IPC:   " << result.calculateIpc() << "\n";
+
+    for (PerfEvent event : {PerfEvent::CYCLES, PerfEvent::CACHE_MISSES,
+                            PerfEvent::BRANCH_MISSES, PerfEvent::PAGE_FAULTS})
+    {
+      if (PerfCounters::isAvailable(event))
+        std::cout << "  " << PerfCounters::eventName(event) << "/frame: "
+                  << result.calculatePerCall(event) << "\n";
+    }
+  }
+}
+
+void Storage::addData(const char* funcName, long long duration, const PerfSample* counters)
+{
+  std::lock_guard<std::mutex> lock {m_mtx};
+  Result& result {m_results[funcName]};
+  if (result.m_samples.capacity() < m_sampleCapacity)
+    result.m_samples.reserve(m_sampleCapacity);
+  result.m_totalTime += duration;
+  result.m_numCalls += 1;
+  result.m_samples.push_back(static_cast<double>(duration));
+
+  if (counters != nullptr)
+  {
+    for (std::size_t i {0}; i < kNumPerfEvents; ++i)
+      result.m_counters.m_values[i] += counters->m_values[i];
+    result.m_numCounterCalls += 1;
+  }
+}
+
+void Storage::reserve(std::size_t samplesPerZone)
+{
+  std::lock_guard<std::mutex> lock {m_mtx};
+  m_sampleCapacity = samplesPerZone;
+  for (auto& [name, result] : m_results)
+    result.m_samples.reserve(samplesPerZone);
 }
 
-void Storage::addData(const char* funcName, long long duration)
+void Storage::reset()
 {
-  m_results[funcName].m_totalTime += duration;
-  m_results[funcName].m_numCalls += 1;
+  std::lock_guard<std::mutex> lock {m_mtx};
+  m_results.clear();
 }
@@ -1,14 +1,18 @@
 #pragma once
 
+#include "perfCounters.h"
+
 #include <chrono>
 #include <unordered_map>
 #include <mutex>
+#include <vector>
 
 namespace profiling
 {
-  
-#define PROFILE_FUNCTION() profiler::Profiler _p_{__func__}
-  
+
+#define PROFILE_FUNCTION() Profiler _p_{__func__}
+#define PROFILE_SCOPE(name) Profiler _p_{name}
+
 using Clock = std::chrono::high_resolution_clock;
 using TimePoint = Clock::time_point;
 
@@ -16,20 +20,50 @@ using TimePoint = Clock::time_point;
 
 struct Result
 {
-  long long m_totalTime {0};
+  long long m_totalTime {0};              /// \var total time in microseconds
   int m_numCalls {0};
+  std::vector<double> m_samples;          /// \var per call durations in microseconds
+  PerfSample m_counters {};               /// \var accumulated hardware counter deltas
+  int m_numCounterCalls {0};              /// \var number of calls with valid counters
 
   double calculateAverageTime() const;
+
+  /**
+   * @brief calculates instructions per cycle over all sampled calls
+   * @return IPC, 0 if no cycles were counted
+   */
+  double calculateIpc() const;
+
+  /**
+   * @brief calculates the average count of the given event per call
+   * @param event perf event
+   * @return average count per call
+   */
+  double calculatePerCall(PerfEvent event) const;
 };
 
 struct Storage
 {
-  static void addData(const char* funcName, long long duration);
+  static void addData(const char* funcName, long long duration,
+                      const PerfSample* counters = nullptr);
 
   static void printSummary();
 
+  /**
+   * @brief preallocates the sample buffer of every zone, so recording never allocates 
+   * on the measured path
+   * @param samplesPerZone expected number of calls per zone
+   */
+  static void reserve(std::size_t samplesPerZone);
+
+  /**
+   * @brief drops all recorded zones, e.g. the ones recorded during warm-up
+   */
+  static void reset();
+
   static std::unordered_map<const char*, Result> m_results;
   static std::mutex m_mtx;
+  static std::size_t m_sampleCapacity;
 };
 
 struct Profiler
@@ -42,7 +76,10 @@ private:
   profiling::TimePoint m_start;
   profiling::TimePoint m_end;
   const char* m_funcName;
+  PerfSample m_startCounters;
+  bool m_hasCounters {false};
 };
 
 inline std::unordered_map<const char*, Result> Storage::m_results;
 inline std::mutex Storage::m_mtx;
+inline std::size_t Storage::m_sampleCapacity {0};
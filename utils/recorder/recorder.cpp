@@ -0,0 +1,228 @@
+#include "recorder.h"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+std::size_t alignUp(std::size_t bytes)
+{
+  return (bytes + kRecordAlignment - 1) / kRecordAlignment * kRecordAlignment;
+}
+}
+
+TensorRecorder::~TensorRecorder()
+{
+  close();
+}
+
+bool TensorRecorder::open(const std::string& path, std::uint32_t benchType, std::uint32_t arch,
+                          std::size_t numSlots)
+{
+  m_file = std::fopen(path.c_str(), "wb");
+  if (m_file == nullptr)
+  {
+    spdlog::error("TensorRecorder::open: could not create recording file: {}", path);
+    return false;
+  }
+
+  // the file header is padded so the first record starts aligned
+  RecordingHeader header;
+  header.m_benchType = benchType;
+  header.m_arch = arch;
+  std::uint8_t block[kRecordAlignment] {};
+  std::memcpy(block, &header, sizeof(header));
+  if (std::fwrite(block, 1, sizeof(block), m_file) != sizeof(block))
+  {
+    spdlog::error("TensorRecorder::open: could not write to {}", path);
+    std::fclose(m_file);
+    m_file = nullptr;
+    return false;
+  }
+
+  m_slots.resize(std::max<std::size_t>(numSlots, 1));
+  m_head = 0;
+  m_count = 0;
+  m_frames = 0;
+  m_closed = false;
+  m_failed = false;
+  m_writer = std::thread(&TensorRecorder::writeLoop, this);
+  return true;
+}
+
+void TensorRecorder::record(const TensorRecordHeader& header, const void* data)
+{
+  std::size_t index {0};
+  {
+    std::unique_lock<std::mutex> lock {m_mtx};
+    m_notFull.wait(lock, [this] { return m_count < m_slots.size() || m_closed; });
+    if (m_closed)
+      return;
+    index = (m_head + m_count) % m_slots.size();
+  }
+
+  // the writer never touches a slot before it is published, copy outside the lock
+  Slot& slot {m_slots[index]};
+  slot.m_header = header;
+  slot.m_header.m_sequence = m_frames;
+  slot.m_payload.resize(alignUp(header.m_payloadBytes));
+  std::memcpy(slot.m_payload.data(), data, header.m_payloadBytes);
+  std::fill(slot.m_payload.begin() + header.m_payloadBytes, slot.m_payload.end(), 0);
+  if (header.m_outputIdx + 1 >= header.m_numOutputs)
+    ++m_frames;
+
+  {
+    std::lock_guard<std::mutex> lock {m_mtx};
+    ++m_count;
+  }
+  m_notEmpty.notify_one();
+}
+
+void TensorRecorder::writeLoop()
+{
+  while (true)
+  {
+    std::size_t index {0};
+    {
+      std::unique_lock<std::mutex> lock {m_mtx};
+      m_notEmpty.wait(lock, [this] { return m_count > 0 || m_closed; });
+      if (m_count == 0)
+        return;
+      index = m_head;
+    }
+
+    const Slot& slot {m_slots[index]};
+    if (!m_failed &&
+        (std::fwrite(&slot.m_header, sizeof(slot.m_header), 1, m_file) != 1 ||
+         std::fwrite(slot.m_payload.data(), 1, slot.m_payload.size(), m_file) !=
+           slot.m_payload.size()))
+    {
+      spdlog::error("TensorRecorder::writeLoop: write failed, recording is incomplete");
+      m_failed = true;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock {m_mtx};
+      m_head = (m_head + 1) % m_slots.size();
+      --m_count;
+    }
+    m_notFull.notify_one();
+  }
+}
+
+bool TensorRecorder::close()
+{
+  if (m_file == nullptr)
+    return false;
+
+  {
+    std::lock_guard<std::mutex> lock {m_mtx};
+    m_closed = true;
+  }
+  m_notEmpty.notify_all();
+  m_notFull.notify_all();
+  if (m_writer.joinable())
+    m_writer.join();
+
+  const bool ok {!m_failed && std::fclose(m_file) == 0};
+  m_file = nullptr;
+  spdlog::info("TensorRecorder::close: {} frames recorded", m_frames);
+  return ok;
+}
+
+TensorRecording::~TensorRecording()
+{
+  if (m_data != nullptr)
+    munmap(const_cast<std::uint8_t*>(m_data), m_size);
+}
+
+bool TensorRecording::open(const std::string& path)
+{
+  const int fd {::open(path.c_str(), O_RDONLY)};
+  if (fd < 0)
+  {
+    spdlog::error("TensorRecording::open: could not open recording file: {}", path);
+    return false;
+  }
+  struct stat info {};
+  if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < kRecordAlignment)
+  {
+    spdlog::error("TensorRecording::open: {} is not a recording", path);
+    ::close(fd);
+    return false;
+  }
+
+  m_size = static_cast<std::size_t>(info.st_size);
+  void* data {mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0)};
+  ::close(fd);
+  if (data == MAP_FAILED)
+  {
+    spdlog::error("TensorRecording::open: could not map {}", path);
+    m_size = 0;
+    return false;
+  }
+  m_data = static_cast<const std::uint8_t*>(data);
+
+  const RecordingHeader& file {fileHeader()};
+  if (std::memcmp(file.m_magic, RecordingHeader{}.m_magic, sizeof(file.m_magic)) != 0 ||
+      file.m_version != RecordingHeader{}.m_version)
+  {
+    spdlog::error("TensorRecording::open: {} is not a version {} recording", path,
+                  RecordingHeader{}.m_version);
+    return false;
+  }
+
+  // index the records, a truncated last record (interrupted run) is dropped
+  m_records.clear();
+  m_frames.clear();
+  for (std::size_t offset {kRecordAlignment}; offset + sizeof(TensorRecordHeader) <= m_size;)
+  {
+    const TensorRecordHeader& record {
+      *reinterpret_cast<const TensorRecordHeader*>(m_data + offset)};
+    const std::size_t next {offset + sizeof(TensorRecordHeader) +
+                            alignUp(record.m_payloadBytes)};
+    if (next > m_size || record.m_rank > TensorRecordHeader::kMaxRank)
+    {
+      spdlog::warn("TensorRecording::open: {} is truncated, {} complete records", path,
+                   m_records.size());
+      break;
+    }
+    if (record.m_outputIdx == 0)
+      m_frames.push_back(m_records.size());
+    m_records.push_back(offset);
+    offset = next;
+  }
+
+  // drop a frame whose outputs were not all written
+  if (!m_frames.empty() && m_records.size() - m_frames.back() <
+                           header(m_frames.size() - 1).m_numOutputs)
+    m_frames.pop_back();
+
+  spdlog::info("TensorRecording::open: {} frames in {}", m_frames.size(), path);
+  return !m_frames.empty();
+}
+
+const RecordingHeader& TensorRecording::fileHeader() const
+{
+  return *reinterpret_cast<const RecordingHeader*>(m_data);
+}
+
+std::size_t TensorRecording::numOutputs(std::size_t frame) const
+{
+  return header(frame).m_numOutputs;
+}
+
+const TensorRecordHeader& TensorRecording::header(std::size_t frame, std::size_t output) const
+{
+  return *reinterpret_cast<const TensorRecordHeader*>(m_data + m_records[m_frames[frame] + output]);
+}
+
+const void* TensorRecording::payload(std::size_t frame, std::size_t output) const
+{
+  return m_data + m_records[m_frames[frame] + output] + sizeof(TensorRecordHeader);
+}
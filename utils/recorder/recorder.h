@@ -0,0 +1,176 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief element type of a recorded tensor
+ */
+enum class TensorDtype : std::uint8_t {FLOAT32, UINT8, INT8, INT32, UNKNOWN};
+
+/**
+ * @brief RecordingHeader starts a tensor recording file
+ */
+struct RecordingHeader
+{
+  char m_magic[4] {'E', 'I', 'R', 'T'};   /// \var file magic
+  std::uint32_t m_version {1};            /// \var format version
+  std::uint32_t m_benchType {0};          /// \var TestBenchType of the recording run
+  std::uint32_t m_arch {0};               /// \var ModelArch of the recording run
+};
+
+/**
+ * @brief TensorRecordHeader precedes every recorded output tensor. Payloads are padded to
+ * kRecordAlignment so every tensor of a mapped file is aligned.
+ */
+struct TensorRecordHeader
+{
+  static constexpr int kMaxRank {6};
+
+  std::uint64_t m_payloadBytes {0};       /// \var tensor bytes, without padding
+  std::uint64_t m_sequence {0};           /// \var frame number, shared by all outputs
+  std::int32_t m_frameWidth {0};          /// \var original frame width
+  std::int32_t m_frameHeight {0};         /// \var original frame height
+  std::int32_t m_dims[kMaxRank] {};       /// \var tensor shape
+  std::uint8_t m_rank {0};                /// \var number of valid dims
+  TensorDtype m_dtype {TensorDtype::FLOAT32}; /// \var element type
+  std::uint8_t m_outputIdx {0};           /// \var model output index
+  std::uint8_t m_numOutputs {1};          /// \var model outputs recorded per frame
+  float m_scale {0.0f};                   /// \var quantization scale, 0 if not quantized
+  std::int32_t m_zeroPoint {0};           /// \var quantization zero point
+  std::uint32_t m_reserved {0};
+};
+
+/// \var alignment of headers and payloads inside a recording
+constexpr std::size_t kRecordAlignment {64};
+static_assert(sizeof(RecordingHeader) == 16, "recording header layout changed");
+static_assert(sizeof(TensorRecordHeader) == kRecordAlignment, "record header layout changed");
+
+/**
+ * @brief TensorRecorder streams output tensors to a recording file. The inference thread
+ * only copies the tensor into a preallocated slot, a background thread writes the slots.
+ */
+class TensorRecorder
+{
+  /**
+   * @brief one tensor waiting to be written
+   */
+  struct Slot
+  {
+    TensorRecordHeader m_header;          /// \var record header
+    std::vector<std::uint8_t> m_payload;  /// \var tensor copy, capacity is reused
+  };
+
+  std::FILE* m_file {nullptr};            /// \var output file
+  std::vector<Slot> m_slots;              /// \var ring of slots
+  std::size_t m_head {0};                 /// \var next slot to write
+  std::size_t m_count {0};                /// \var filled slots
+  std::uint64_t m_frames {0};             /// \var frames recorded so far
+  bool m_closed {false};                  /// \var no more records will be pushed
+  bool m_failed {false};                  /// \var a write failed
+  std::mutex m_mtx;
+  std::condition_variable m_notEmpty;
+  std::condition_variable m_notFull;
+  std::thread m_writer;                   /// \var background writer
+
+  /**
+   * @brief writer thread loop
+   */
+  void writeLoop();
+
+public:
+  TensorRecorder() = default;
+  TensorRecorder(const TensorRecorder&) = delete;
+  TensorRecorder& operator=(const TensorRecorder&) = delete;
+  ~TensorRecorder();
+
+  /**
+   * @brief creates the recording file and starts the writer
+   * @param path output file path
+   * @param benchType TestBenchType of the run
+   * @param arch ModelArch of the run
+   * @param numSlots tensors buffered before record blocks
+   * @return true if successful, false otherwise
+   */
+  bool open(const std::string& path, std::uint32_t benchType, std::uint32_t arch,
+            std::size_t numSlots = 8);
+
+  /**
+   * @brief queues one output tensor, blocks while the writer is behind. The sequence number
+   * is assigned here and advances after the last output of a frame.
+   * @param header record header, payload size, shape and metadata filled in
+   * @param data tensor data
+   */
+  void record(const TensorRecordHeader& header, const void* data);
+
+  /**
+   * @brief writes the queued tensors and closes the file
+   * @return true if every record was written, false otherwise
+   */
+  bool close();
+
+  /**
+   * @brief returns the number of frames recorded
+   */
+  std::uint64_t numFrames() const { return m_frames; }
+};
+
+/**
+ * @brief TensorRecording memory maps a recording file for replay
+ */
+class TensorRecording
+{
+  const std::uint8_t* m_data {nullptr};   /// \var mapped file
+  std::size_t m_size {0};                 /// \var mapped bytes
+  std::vector<std::size_t> m_records;     /// \var offset of every record header
+  std::vector<std::size_t> m_frames;      /// \var first record of every frame
+
+public:
+  TensorRecording() = default;
+  TensorRecording(const TensorRecording&) = delete;
+  TensorRecording& operator=(const TensorRecording&) = delete;
+  ~TensorRecording();
+
+  /**
+   * @brief maps and indexes a recording file
+   * @param path recording file path
+   * @return true if successful, false otherwise
+   */
+  bool open(const std::string& path);
+
+  /**
+   * @brief returns the file header
+   */
+  const RecordingHeader& fileHeader() const;
+
+  /**
+   * @brief returns the number of recorded frames
+   */
+  std::size_t numFrames() const { return m_frames.size(); }
+
+  /**
+   * @brief returns the number of outputs recorded for a frame
+   * @param frame frame index
+   */
+  std::size_t numOutputs(std::size_t frame) const;
+
+  /**
+   * @brief returns the header of one output of a frame
+   * @param frame frame index
+   * @param output output index
+   */
+  const TensorRecordHeader& header(std::size_t frame, std::size_t output = 0) const;
+
+  /**
+   * @brief returns the aligned tensor data of one output of a frame
+   * @param frame frame index
+   * @param output output index
+   */
+  const void* payload(std::size_t frame, std::size_t output = 0) const;
+};
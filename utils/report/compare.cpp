@@ -0,0 +1,109 @@
+#include "compare.h"
+#include "json.h"
+#include "../profiler/profiler.h"
+#include "../stats/stats.h"
+
+#include <spdlog/spdlog.h>
+#include <spdlog/fmt/fmt.h>
+#include <iostream>
+
+namespace
+{
+
+double relativeChange(double baseline, double current)
+{
+  return baseline > 0.0 ? (current - baseline) / baseline : 0.0;
+}
+
+}  // namespace
+
+bool BaselineComparator::compare(const std::string& baselinePath, double tolerance,
+                                 double alpha, std::vector<StageComparison>& comparisons)
+{
+  JsonValue baseline;
+  if (!JsonValue::parseFile(baselinePath, baseline))
+    return false;
+
+  const JsonValue* stages {baseline.find("stages")};
+  if (stages == nullptr || stages->m_type != JsonValue::Type::OBJECT)
+  {
+    spdlog::error("BaselineComparator::compare: no stages in baseline file: {}", baselinePath);
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock {Storage::m_mtx};
+  comparisons.clear();
+  for (const auto& [name, result] : Storage::m_results)
+  {
+    const JsonValue* stage {stages->find(name)};
+    if (stage == nullptr)
+    {
+      spdlog::warn("BaselineComparator::compare: stage {} is not in the baseline", name);
+      continue;
+    }
+
+    StageComparison comparison;
+    comparison.m_name = name;
+
+    std::vector<double> current;
+    current.reserve(result.m_samples.size());
+    for (double sample : result.m_samples)
+      current.push_back(sample / 1000.0);
+    std::vector<double> sortedCurrent {current};
+    const Summary currentSummary {Stats::summarize(sortedCurrent)};
+    comparison.m_currentP50 = currentSummary.m_p50;
+    comparison.m_currentP99 = currentSummary.m_p99;
+
+    std::vector<double> previous;
+    const JsonValue* samples {stage->find("samples")};
+    if (samples != nullptr)
+    {
+      previous.reserve(samples->m_array.size());
+      for (const JsonValue& sample : samples->m_array)
+        previous.push_back(sample.asNumber());
+    }
+
+    // older files without raw samples can only be compared on their percentiles
+    if (!previous.empty() && !current.empty())
+    {
+      std::vector<double> sortedPrevious {previous};
+      const Summary previousSummary {Stats::summarize(sortedPrevious)};
+      comparison.m_baselineP50 = previousSummary.m_p50;
+      comparison.m_baselineP99 = previousSummary.m_p99;
+      comparison.m_pValue = Stats::mannWhitneyGreater(previous, current);
+      comparison.m_tested = true;
+    }
+    else
+    {
+      comparison.m_baselineP50 = stage->find("p50") ? stage->find("p50")->asNumber() : 0.0;
+      comparison.m_baselineP99 = stage->find("p99") ? stage->find("p99")->asNumber() : 0.0;
+    }
+
+    const bool slower {
+      relativeChange(comparison.m_baselineP50, comparison.m_currentP50) > tolerance ||
+      relativeChange(comparison.m_baselineP99, comparison.m_currentP99) > tolerance};
+    comparison.m_regressed = slower && (!comparison.m_tested || comparison.m_pValue < alpha);
+    comparisons.push_back(std::move(comparison));
+  }
+  return true;
+}
+
+void BaselineComparator::printTable(const std::vector<StageComparison>& comparisons,
+                                    double tolerance)
+{
+  std::cout << "--- Baseline Comparison (tolerance " << tolerance * 100.0 << "%) ---\n";
+  std::cout << fmt::format("{:<32} {:>10} {:>10} {:>8} {:>10} {:>10} {:>8} {:>9}  {}\n",
+                           "stage", "base p50", "cur p50", "delta", "base p99", "cur p99",
+                           "delta", "p-value", "verdict");
+  for (const StageComparison& c : comparisons)
+  {
+    const std::string pValue {c.m_tested ? fmt::format("{:.4f}", c.m_pValue) : "n/a"};
+    std::cout << fmt::format(
+      "{:<32} {:>10.3f} {:>10.3f} {:>+7.1f}% {:>10.3f} {:>10.3f} {:>+7.1f}% {:>9}  {}\n",
+      c.m_name, c.m_baselineP50, c.m_currentP50,
+      relativeChange(c.m_baselineP50, c.m_currentP50) * 100.0,
+      c.m_baselineP99, c.m_currentP99,
+      relativeChange(c.m_baselineP99, c.m_currentP99) * 100.0,
+      pValue, c.m_regressed ? "REGRESSION" : "ok");
+  }
+}
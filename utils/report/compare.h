@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief StageComparison holds the comparison of one profiled zone against the baseline
+ */
+struct StageComparison
+{
+  std::string m_name;                     /// \var zone name
+  double m_baselineP50 {0.0};             /// \var baseline median in ms
+  double m_currentP50 {0.0};              /// \var current median in ms
+  double m_baselineP99 {0.0};             /// \var baseline 99th percentile in ms
+  double m_currentP99 {0.0};              /// \var current 99th percentile in ms
+  double m_pValue {1.0};                  /// \var mann-whitney p-value (current slower)
+  bool m_tested {false};                  /// \var both runs had raw samples
+  bool m_regressed {false};               /// \var significant regression beyond tolerance
+};
+
+/**
+ * @brief BaselineComparator compares the profiled zones of the current run against a 
+ * results file written by an earlier run
+ */
+struct BaselineComparator
+{
+  /**
+   * @brief compares every zone present in both runs. A zone regresses when its p50 or p99
+   * grew by more than the tolerance and, if raw samples exist on both sides, the 
+   * mann-whitney test rejects "not slower" at the given significance level.
+   * @param baselinePath path of the baseline json results file
+   * @param tolerance allowed relative increase, e.g. 0.05 for 5%
+   * @param alpha significance level of the test
+   * @param comparisons output comparisons
+   * @return true if the baseline could be read, false otherwise
+   */
+  static bool compare(const std::string& baselinePath, double tolerance, double alpha,
+                      std::vector<StageComparison>& comparisons);
+
+  /**
+   * @brief prints the comparison table
+   * @param comparisons comparisons
+   * @param tolerance allowed relative increase
+   */
+  static void printTable(const std::vector<StageComparison>& comparisons, double tolerance);
+};
@@ -0,0 +1,350 @@
+#include "json.h"
+
+#include <spdlog/spdlog.h>
+#include <spdlog/fmt/fmt.h>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+JsonWriter::JsonWriter(std::size_t bytes)
+{
+  m_buffer.reserve(bytes);
+  m_firstInScope.reserve(16);
+}
+
+void JsonWriter::prefix(std::string_view key)
+{
+  if (!m_firstInScope.empty())
+  {
+    if (!m_firstInScope.back())
+      m_buffer += ',';
+    m_firstInScope.back() = false;
+  }
+
+  if (!key.empty())
+  {
+    appendString(key);
+    m_buffer += ':';
+  }
+}
+
+void JsonWriter::appendString(std::string_view value)
+{
+  m_buffer += '"';
+  for (char c : value)
+  {
+    switch (c)
+    {
+      case '"': m_buffer += "\\\""; break;
+      case '\\': m_buffer += "\\\\"; break;
+      case '\n': m_buffer += "\\n"; break;
+      case '\r': m_buffer += "\\r"; break;
+      case '\t': m_buffer += "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20)
+          fmt::format_to(std::back_inserter(m_buffer), "\\u{:04x}", static_cast<int>(c));
+        else
+          m_buffer += c;
+    }
+  }
+  m_buffer += '"';
+}
+
+void JsonWriter::beginObject(std::string_view key)
+{
+  prefix(key);
+  m_buffer += '{';
+  m_firstInScope.push_back(true);
+}
+
+void JsonWriter::endObject()
+{
+  m_buffer += '}';
+  m_firstInScope.pop_back();
+}
+
+void JsonWriter::beginArray(std::string_view key)
+{
+  prefix(key);
+  m_buffer += '[';
+  m_firstInScope.push_back(true);
+}
+
+void JsonWriter::endArray()
+{
+  m_buffer += ']';
+  m_firstInScope.pop_back();
+}
+
+void JsonWriter::field(std::string_view key, std::string_view value)
+{
+  prefix(key);
+  appendString(value);
+}
+
+void JsonWriter::field(std::string_view key, const char* value)
+{
+  field(key, std::string_view{value});
+}
+
+void JsonWriter::field(std::string_view key, double value)
+{
+  prefix(key);
+  // json has no representation for nan/inf
+  if (std::isfinite(value))
+    fmt::format_to(std::back_inserter(m_buffer), "{:.7g}", value);
+  else
+    m_buffer += "null";
+}
+
+void JsonWriter::field(std::string_view key, std::uint64_t value)
+{
+  prefix(key);
+  fmt::format_to(std::back_inserter(m_buffer), "{}", value);
+}
+
+void JsonWriter::field(std::string_view key, bool value)
+{
+  prefix(key);
+  m_buffer += value ? "true" : "false";
+}
+
+void JsonWriter::value(double value)
+{
+  field(std::string_view{}, value);
+}
+
+namespace
+{
+
+/**
+ * @brief recursive descent parser over a json text
+ */
+class JsonParser
+{
+  std::string_view m_text;
+  std::size_t m_pos {0};
+
+  void skipWhitespace()
+  {
+    while (m_pos < m_text.size() &&
+           (m_text[m_pos] == ' ' || m_text[m_pos] == '\n' || 
+            m_text[m_pos] == '\r' || m_text[m_pos] == '\t'))
+      ++m_pos;
+  }
+
+  bool consume(char c)
+  {
+    skipWhitespace();
+    if (m_pos < m_text.size() && m_text[m_pos] == c)
+    {
+      ++m_pos;
+      return true;
+    }
+    return false;
+  }
+
+  bool consumeLiteral(std::string_view literal)
+  {
+    if (m_text.substr(m_pos, literal.size()) != literal)
+      return false;
+    m_pos += literal.size();
+    return true;
+  }
+
+  bool parseString(std::string& out)
+  {
+    if (!consume('"'))
+      return false;
+
+    while (m_pos < m_text.size())
+    {
+      const char c {m_text[m_pos++]};
+      if (c == '"')
+        return true;
+      if (c != '\\')
+      {
+        out += c;
+        continue;
+      }
+      if (m_pos >= m_text.size())
+        return false;
+
+      const char escaped {m_text[m_pos++]};
+      switch (escaped)
+      {
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        case 't': out += '\t'; break;
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'u':
+        {
+          if (m_pos + 4 > m_text.size())
+            return false;
+          // result files only escape control characters, keep the basic plane as utf-8
+          const unsigned long code {std::strtoul(
+            std::string{m_text.substr(m_pos, 4)}.c_str(), nullptr, 16)};
+          m_pos += 4;
+          if (code < 0x80)
+          {
+            out += static_cast<char>(code);
+          }
+          else if (code < 0x800)
+          {
+            out += static_cast<char>(0xc0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+          }
+          else
+          {
+            out += static_cast<char>(0xe0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+          }
+          break;
+        }
+        default: out += escaped; break;
+      }
+    }
+    return false;
+  }
+
+  bool parseNumber(double& out)
+  {
+    const std::size_t start {m_pos};
+    while (m_pos < m_text.size() &&
+           (std::isdigit(static_cast<unsigned char>(m_text[m_pos])) || m_text[m_pos] == '-' ||
+            m_text[m_pos] == '+' || m_text[m_pos] == '.' || m_text[m_pos] == 'e' ||
+            m_text[m_pos] == 'E'))
+      ++m_pos;
+    if (start == m_pos)
+      return false;
+
+    const std::string number {m_text.substr(start, m_pos - start)};
+    char* end {nullptr};
+    out = std::strtod(number.c_str(), &end);
+    return end == number.c_str() + number.size();
+  }
+
+public:
+  explicit JsonParser(std::string_view text) : m_text {text} {}
+
+  bool parseValue(JsonValue& value, int depth = 0)
+  {
+    if (depth > 64)
+      return false;
+
+    skipWhitespace();
+    if (m_pos >= m_text.size())
+      return false;
+
+    const char c {m_text[m_pos]};
+    if (c == '{')
+    {
+      ++m_pos;
+      value.m_type = JsonValue::Type::OBJECT;
+      if (consume('}'))
+        return true;
+      do
+      {
+        std::string key;
+        JsonValue member;
+        if (!parseString(key) || !consume(':') || !parseValue(member, depth + 1))
+          return false;
+        value.m_object.emplace_back(std::move(key), std::move(member));
+      } while (consume(','));
+      return consume('}');
+    }
+    if (c == '[')
+    {
+      ++m_pos;
+      value.m_type = JsonValue::Type::ARRAY;
+      if (consume(']'))
+        return true;
+      do
+      {
+        value.m_array.emplace_back();
+        if (!parseValue(value.m_array.back(), depth + 1))
+          return false;
+      } while (consume(','));
+      return consume(']');
+    }
+    if (c == '"')
+    {
+      value.m_type = JsonValue::Type::STRING;
+      return parseString(value.m_string);
+    }
+    if (consumeLiteral("true"))
+    {
+      value.m_type = JsonValue::Type::BOOL;
+      value.m_bool = true;
+      return true;
+    }
+    if (consumeLiteral("false"))
+    {
+      value.m_type = JsonValue::Type::BOOL;
+      return true;
+    }
+    if (consumeLiteral("null"))
+    {
+      value.m_type = JsonValue::Type::NUL;
+      return true;
+    }
+
+    value.m_type = JsonValue::Type::NUMBER;
+    return parseNumber(value.m_number);
+  }
+
+  bool atEnd()
+  {
+    skipWhitespace();
+    return m_pos == m_text.size();
+  }
+};
+
+}  // namespace
+
+const JsonValue* JsonValue::find(std::string_view key) const
+{
+  if (m_type != Type::OBJECT)
+    return nullptr;
+
+  for (const auto& [name, member] : m_object)
+    if (name == key)
+      return &member;
+  return nullptr;
+}
+
+double JsonValue::asNumber(double fallback) const
+{
+  return m_type == Type::NUMBER ? m_number : fallback;
+}
+
+bool JsonValue::parse(std::string_view text, JsonValue& value)
+{
+  value = JsonValue{};
+  JsonParser parser {text};
+  return parser.parseValue(value) && parser.atEnd();
+}
+
+bool JsonValue::parseFile(const std::string& path, JsonValue& value)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open())
+  {
+    spdlog::error("JsonValue::parseFile: could not open file: {}", path);
+    return false;
+  }
+
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  if (!parse(buffer.str(), value))
+  {
+    spdlog::error("JsonValue::parseFile: invalid json in file: {}", path);
+    return false;
+  }
+  return true;
+}
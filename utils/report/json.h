@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief JsonWriter appends a json document to a preallocated string buffer, commas and
+ * nesting are tracked so callers only emit keys and values
+ */
+class JsonWriter
+{
+  std::string m_buffer;                   /// \var output document
+  std::vector<bool> m_firstInScope;       /// \var no element written yet in the scope
+
+  /**
+   * @brief writes the separator and the key (if any) of the next element
+   * @param key element key, empty inside arrays
+   */
+  void prefix(std::string_view key);
+
+  /**
+   * @brief appends a quoted and escaped string
+   * @param value string value
+   */
+  void appendString(std::string_view value);
+
+public:
+  /**
+   * @brief reserves the output buffer
+   * @param bytes expected document size
+   */
+  explicit JsonWriter(std::size_t bytes = 64 * 1024);
+
+  void beginObject(std::string_view key = {});
+  void endObject();
+  void beginArray(std::string_view key = {});
+  void endArray();
+
+  void field(std::string_view key, std::string_view value);
+  void field(std::string_view key, const char* value);
+  void field(std::string_view key, double value);
+  void field(std::string_view key, std::uint64_t value);
+  void field(std::string_view key, bool value);
+
+  /**
+   * @brief appends an array element
+   * @param value element value
+   */
+  void value(double value);
+
+  /**
+   * @brief returns the written document
+   * @return json document
+   */
+  const std::string& str() const { return m_buffer; }
+};
+
+/**
+ * @brief JsonValue is a minimal json document model, enough to read back result files
+ */
+struct JsonValue
+{
+  enum class Type {NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT};
+
+  Type m_type {Type::NUL};                                  /// \var value type
+  bool m_bool {false};                                      /// \var boolean value
+  double m_number {0.0};                                    /// \var number value
+  std::string m_string;                                     /// \var string value
+  std::vector<JsonValue> m_array;                           /// \var array elements
+  std::vector<std::pair<std::string, JsonValue>> m_object;  /// \var object members
+
+  /**
+   * @brief finds an object member by key
+   * @param key member key
+   * @return pointer to the member, nullptr if missing or not an object
+   */
+  const JsonValue* find(std::string_view key) const;
+
+  /**
+   * @brief returns the number value or the given fallback for non-numbers
+   * @param fallback fallback value
+   * @return number value
+   */
+  double asNumber(double fallback = 0.0) const;
+
+  /**
+   * @brief parses a json document
+   * @param text json text
+   * @param value output document
+   * @return true if successful, false otherwise
+   */
+  static bool parse(std::string_view text, JsonValue& value);
+
+  /**
+   * @brief reads and parses a json file
+   * @param path file path
+   * @param value output document
+   * @return true if successful, false otherwise
+   */
+  static bool parseFile(const std::string& path, JsonValue& value);
+};
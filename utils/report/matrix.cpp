@@ -0,0 +1,266 @@
+#include "matrix.h"
+#include "json.h"
+
+#include <spdlog/spdlog.h>
+#include <spdlog/fmt/fmt.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <type_traits>
+
+namespace
+{
+
+std::string stringMember(const JsonValue& object, std::string_view key)
+{
+  const JsonValue* member {object.find(key)};
+  return member != nullptr && member->m_type == JsonValue::Type::STRING ? member->m_string :
+                                                                           std::string{};
+}
+
+double numberMember(const JsonValue& object, std::string_view key)
+{
+  const JsonValue* member {object.find(key)};
+  return member != nullptr ? member->asNumber() : 0.0;
+}
+
+const JsonValue& objectMember(const JsonValue& object, std::string_view key)
+{
+  static const JsonValue kEmpty;
+  const JsonValue* member {object.find(key)};
+  return member != nullptr ? *member : kEmpty;
+}
+
+std::string csvEscape(std::string_view field)
+{
+  if (field.find_first_of(",\"\n") == std::string_view::npos)
+    return std::string{field};
+
+  std::string escaped {"\""};
+  for (char c : field)
+  {
+    if (c == '"')
+      escaped += '"';
+    escaped += c;
+  }
+  escaped += '"';
+  return escaped;
+}
+
+std::string toJson(const std::vector<VariantSummary>& summaries)
+{
+  JsonWriter json;
+  json.beginObject();
+  json.field("version", static_cast<std::uint64_t>(1));
+  json.beginArray("variants");
+  for (const VariantSummary& summary : summaries)
+  {
+    json.beginObject();
+    json.field("name", summary.m_name);
+    json.field("succeeded", summary.m_succeeded);
+    json.field("resultsPath", summary.m_resultsPath);
+    if (summary.m_loaded)
+    {
+      json.field("engineType", summary.m_engineType);
+      json.field("modelPath", summary.m_modelPath);
+      json.field("modelHash", summary.m_modelHash);
+      json.field("frames", summary.m_frames);
+      json.field("throughputFps", summary.m_throughputFps);
+      json.field("coldStartMs", summary.m_coldStartMs);
+      json.field("steadyRssKb", summary.m_steadyRssKb);
+      json.field("steadyPeakRssKb", summary.m_steadyPeakRssKb);
+      json.field("arenaBytes", summary.m_arenaBytes);
+
+      json.beginObject("stages");
+      for (const StageLatency& stage : summary.m_stages)
+      {
+        json.beginObject(stage.m_name);
+        json.field("p50", stage.m_p50);
+        json.field("p99", stage.m_p99);
+        json.endObject();
+      }
+      json.endObject();
+
+      json.beginObject("metrics");
+      for (const auto& [name, value] : summary.m_metrics)
+        json.field(name, value);
+      json.endObject();
+    }
+    json.endObject();
+  }
+  json.endArray();
+  json.endObject();
+  return json.str();
+}
+
+std::string toCsv(const std::vector<VariantSummary>& summaries)
+{
+  std::string csv;
+  csv.reserve(4 * 1024);
+  auto row = [&csv](std::string_view name, std::string_view key, const auto& value) {
+    fmt::format_to(std::back_inserter(csv), "{},{},", csvEscape(name), key);
+    if constexpr (std::is_convertible_v<decltype(value), std::string_view>)
+      csv += csvEscape(value);
+    else
+      fmt::format_to(std::back_inserter(csv), "{}", value);
+    csv += '\n';
+  };
+
+  csv += "variant,key,value\n";
+  for (const VariantSummary& summary : summaries)
+  {
+    row(summary.m_name, "succeeded", summary.m_succeeded ? 1 : 0);
+    row(summary.m_name, "resultsPath", summary.m_resultsPath);
+    if (!summary.m_loaded)
+      continue;
+    row(summary.m_name, "engineType", summary.m_engineType);
+    row(summary.m_name, "modelPath", summary.m_modelPath);
+    row(summary.m_name, "modelHash", summary.m_modelHash);
+    row(summary.m_name, "frames", summary.m_frames);
+    row(summary.m_name, "throughputFps", summary.m_throughputFps);
+    row(summary.m_name, "coldStartMs", summary.m_coldStartMs);
+    row(summary.m_name, "steadyRssKb", summary.m_steadyRssKb);
+    row(summary.m_name, "steadyPeakRssKb", summary.m_steadyPeakRssKb);
+    row(summary.m_name, "arenaBytes", summary.m_arenaBytes);
+    for (const StageLatency& stage : summary.m_stages)
+    {
+      row(summary.m_name, stage.m_name + "/p50", stage.m_p50);
+      row(summary.m_name, stage.m_name + "/p99", stage.m_p99);
+    }
+    for (const auto& [name, value] : summary.m_metrics)
+      row(summary.m_name, name, value);
+  }
+  return csv;
+}
+
+}  // namespace
+
+std::string MatrixReport::variantPath(const std::string& path, const std::string& variant)
+{
+  if (path.empty())
+    return {};
+
+  const std::filesystem::path base {path};
+  std::filesystem::path derived {base.parent_path() / base.stem()};
+  derived += "." + variant;
+  derived += base.extension();
+  return derived.string();
+}
+
+void MatrixReport::load(VariantSummary& summary)
+{
+  JsonValue results;
+  if (summary.m_resultsPath.empty() || !JsonValue::parseFile(summary.m_resultsPath, results))
+    return;
+
+  const JsonValue& config {objectMember(results, "config")};
+  const JsonValue& run {objectMember(results, "run")};
+  const JsonValue& memory {objectMember(results, "memory")};
+  summary.m_engineType = stringMember(config, "engineType");
+  summary.m_modelPath = stringMember(config, "modelPath");
+  summary.m_modelHash = stringMember(objectMember(results, "model"), "hash");
+  summary.m_frames = static_cast<std::uint64_t>(numberMember(run, "frames"));
+  summary.m_throughputFps = numberMember(run, "throughputFps");
+  summary.m_coldStartMs = numberMember(run, "coldStartMs");
+  summary.m_steadyRssKb = static_cast<std::uint64_t>(numberMember(memory, "steadyRssKb"));
+  summary.m_steadyPeakRssKb =
+    static_cast<std::uint64_t>(numberMember(memory, "steadyPeakRssKb"));
+  summary.m_arenaBytes = static_cast<std::uint64_t>(numberMember(memory, "arenaBytes"));
+
+  summary.m_stages.clear();
+  for (const auto& [name, stage] : objectMember(results, "stages").m_object)
+    summary.m_stages.push_back({name, numberMember(stage, "p50"), numberMember(stage, "p99")});
+
+  summary.m_metrics.clear();
+  for (const auto& [name, value] : objectMember(results, "metrics").m_object)
+    summary.m_metrics.emplace_back(name, value.asNumber());
+  summary.m_loaded = true;
+}
+
+void MatrixReport::printTable(const std::vector<VariantSummary>& summaries)
+{
+  std::size_t nameWidth {7};
+  for (const VariantSummary& summary : summaries)
+    nameWidth = std::max(nameWidth, summary.m_name.size());
+
+  std::cout << "--- Matrix ---\n";
+  std::cout << fmt::format("{:<{}} {:>8} {:>10} {:>10} {:>12} {:>12}  {}\n", "variant",
+                           nameWidth, "engine", "fps", "cold ms", "peak rss kb", "arena kb",
+                           "metrics");
+  for (const VariantSummary& summary : summaries)
+  {
+    if (!summary.m_loaded)
+    {
+      std::cout << fmt::format("{:<{}} failed, no results\n", summary.m_name, nameWidth);
+      continue;
+    }
+
+    std::string metrics;
+    for (const auto& [name, value] : summary.m_metrics)
+    {
+      // per class entries would not fit a row, they are in the combined report
+      if (name.find('/') == std::string::npos)
+        fmt::format_to(std::back_inserter(metrics), "{}={:.4f} ", name, value);
+    }
+    std::cout << fmt::format("{:<{}} {:>8} {:>10.2f} {:>10.3f} {:>12} {:>12}  {}{}\n",
+                             summary.m_name, nameWidth, summary.m_engineType,
+                             summary.m_throughputFps, summary.m_coldStartMs,
+                             summary.m_steadyPeakRssKb, summary.m_arenaBytes / 1024, metrics,
+                             summary.m_succeeded ? "" : "(failed)");
+  }
+
+  // zone latencies side by side, zones differ between engines
+  std::vector<std::string> stages;
+  for (const VariantSummary& summary : summaries)
+    for (const StageLatency& stage : summary.m_stages)
+      if (std::find(stages.begin(), stages.end(), stage.m_name) == stages.end())
+        stages.push_back(stage.m_name);
+  if (stages.empty())
+    return;
+
+  std::size_t stageWidth {5};
+  for (const std::string& stage : stages)
+    stageWidth = std::max(stageWidth, stage.size());
+  std::cout << fmt::format("{:<{}}", "p50/p99 ms", stageWidth);
+  for (const VariantSummary& summary : summaries)
+    std::cout << fmt::format(" {:>18}", summary.m_name);
+  std::cout << '\n';
+  for (const std::string& stage : stages)
+  {
+    std::cout << fmt::format("{:<{}}", stage, stageWidth);
+    for (const VariantSummary& summary : summaries)
+    {
+      const auto it {std::find_if(summary.m_stages.begin(), summary.m_stages.end(),
+        [&stage](const StageLatency& latency) { return latency.m_name == stage; })};
+      if (it == summary.m_stages.end())
+        std::cout << fmt::format(" {:>18}", "-");
+      else
+        std::cout << fmt::format(" {:>18}", fmt::format("{:.3f}/{:.3f}", it->m_p50, it->m_p99));
+    }
+    std::cout << '\n';
+  }
+}
+
+bool MatrixReport::write(const std::string& path, const std::vector<VariantSummary>& summaries)
+{
+  const bool csv {path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0};
+  const std::string document {csv ? toCsv(summaries) : toJson(summaries)};
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file.is_open())
+  {
+    spdlog::error("MatrixReport::write: could not open report file: {}", path);
+    return false;
+  }
+  file.write(document.data(), static_cast<std::streamsize>(document.size()));
+  if (!file)
+  {
+    spdlog::error("MatrixReport::write: failed writing report file: {}", path);
+    return false;
+  }
+
+  spdlog::info("MatrixReport::write: wrote {} variants to {}", summaries.size(), path);
+  return true;
+}
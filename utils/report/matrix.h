@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief StageLatency is the latency summary of one profiled zone of a variant
+ */
+struct StageLatency
+{
+  std::string m_name;                     /// \var zone name
+  double m_p50 {0.0};                     /// \var median in ms
+  double m_p99 {0.0};                     /// \var 99th percentile in ms
+};
+
+/**
+ * @brief VariantSummary is the part of a variant results file shown in the comparison
+ */
+struct VariantSummary
+{
+  std::string m_name;                     /// \var variant name
+  std::string m_resultsPath;              /// \var json results file of the variant
+  bool m_succeeded {false};               /// \var the run finished without error or regression
+  bool m_loaded {false};                  /// \var the results file could be read
+  std::string m_engineType;               /// \var engine type
+  std::string m_modelPath;                /// \var model file
+  std::string m_modelHash;                /// \var model file hash
+  std::uint64_t m_frames {0};             /// \var measured frames
+  double m_throughputFps {0.0};           /// \var measured throughput
+  double m_coldStartMs {0.0};             /// \var latency of the first frame
+  std::uint64_t m_steadyRssKb {0};        /// \var rss after the run
+  std::uint64_t m_steadyPeakRssKb {0};    /// \var peak rss after the run
+  std::uint64_t m_arenaBytes {0};         /// \var engine arena size
+  std::vector<StageLatency> m_stages;     /// \var per zone latency
+  std::vector<std::pair<std::string, double>> m_metrics; /// \var accuracy metrics
+};
+
+/**
+ * @brief MatrixReport combines the results files of the variants of a matrix run
+ */
+struct MatrixReport
+{
+  /**
+   * @brief derives the per variant file of a path: dir/stem.variant.ext
+   * @param path base path
+   * @param variant variant name
+   * @return variant path, empty if the base path is empty
+   */
+  static std::string variantPath(const std::string& path, const std::string& variant);
+
+  /**
+   * @brief reads the results file of a variant, a missing file leaves m_loaded false
+   * @param summary variant with m_name, m_resultsPath and m_succeeded set, filled in
+   */
+  static void load(VariantSummary& summary);
+
+  /**
+   * @brief prints the comparison tables, one row per variant and one column per variant
+   * for the zone latencies
+   * @param summaries loaded variants
+   */
+  static void printTable(const std::vector<VariantSummary>& summaries);
+
+  /**
+   * @brief writes the combined report, CSV for a .csv path and JSON otherwise
+   * @param path output file path
+   * @param summaries loaded variants
+   * @return true if successful, false otherwise
+   */
+  static bool write(const std::string& path, const std::vector<VariantSummary>& summaries);
+};
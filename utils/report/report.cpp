@@ -0,0 +1,496 @@
+#include "report.h"
+#include "json.h"
+#include "../profiler/profiler.h"
+#include "../stats/stats.h"
+
+#include <spdlog/spdlog.h>
+#include <spdlog/fmt/fmt.h>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+
+namespace
+{
+
+constexpr std::size_t kNumHistogramBuckets {20};
+
+/**
+ * @brief summary of one profiled zone, converted to milliseconds
+ */
+struct StageResult
+{
+  std::string m_name;
+  Summary m_summary;
+  Histogram m_histogram;
+  std::vector<double> m_samples;
+  Result m_totals;
+};
+
+std::vector<StageResult> collectStages()
+{
+  std::vector<StageResult> stages;
+  std::lock_guard<std::mutex> lock {Storage::m_mtx};
+  stages.reserve(Storage::m_results.size());
+  for (const auto& [name, result] : Storage::m_results)
+  {
+    StageResult stage;
+    stage.m_name = name;
+    stage.m_samples.reserve(result.m_samples.size());
+    for (double sample : result.m_samples)
+      stage.m_samples.push_back(sample / 1000.0);
+    stage.m_totals.m_counters = result.m_counters;
+    stage.m_totals.m_numCounterCalls = result.m_numCounterCalls;
+    stages.push_back(std::move(stage));
+  }
+
+  for (StageResult& stage : stages)
+  {
+    stage.m_histogram = Stats::histogram(stage.m_samples, kNumHistogramBuckets);
+    std::vector<double> sorted {stage.m_samples};
+    stage.m_summary = Stats::summarize(sorted);
+  }
+  return stages;
+}
+
+std::string timestamp()
+{
+  const std::time_t now {std::chrono::system_clock::to_time_t(std::chrono::system_clock::now())};
+  std::tm utc {};
+  gmtime_r(&now, &utc);
+  char buffer[32];
+  std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+  return buffer;
+}
+
+void writeSummary(JsonWriter& json, const Summary& summary)
+{
+  json.field("count", static_cast<std::uint64_t>(summary.m_count));
+  json.field("min", summary.m_min);
+  json.field("mean", summary.m_mean);
+  json.field("stddev", summary.m_stddev);
+  json.field("p50", summary.m_p50);
+  json.field("p90", summary.m_p90);
+  json.field("p95", summary.m_p95);
+  json.field("p99", summary.m_p99);
+  json.field("max", summary.m_max);
+}
+
+std::string toJson(const TestBenchConfig& config, const BenchResults& results,
+                   const SystemInfo& system, const std::string& modelHash,
+                   const std::vector<StageResult>& stages)
+{
+  std::size_t numSamples {0};
+  for (const StageResult& stage : stages)
+    numSamples += stage.m_samples.size();
+
+  // roughly 16 characters per sample plus the fixed sections
+  JsonWriter json {16 * 1024 + numSamples * 16};
+  json.beginObject();
+  json.field("version", static_cast<std::uint64_t>(1));
+  json.field("timestamp", timestamp());
+
+  json.beginObject("config");
+  json.field("path", config.m_configPath);
+  if (!config.m_variantName.empty())
+    json.field("variant", config.m_variantName);
+  json.field("type", benchTypeToString(config.m_benchType));
+  json.field("engineType", engineTypeToString(config.m_engineType));
+  json.field("datasetDir", config.m_datasetDir);
+  json.field("modelPath", config.m_modelPath);
+  json.field("classesPath", config.m_classNamesPath);
+  json.field("perfCounters", config.m_perfCounters);
+  json.endObject();
+
+  json.beginObject("engine");
+  json.field("type", engineTypeToString(config.m_engineType));
+  json.beginObject("options");
+  json.field("arch", modelArchToString(config.m_arch));
+  json.field("iou", static_cast<double>(config.m_iouThreshold));
+  json.field("confidence", static_cast<double>(config.m_confidenceThreshold));
+  if (config.m_engineType == EngineType::OPENVINO)
+  {
+    json.field("performanceHint", performanceHintToString(config.m_performanceHint));
+    json.field("inferRequests", static_cast<std::uint64_t>(config.m_inferRequests));
+  }
+  if (config.m_engineType == EngineType::ONNXRUNTIME)
+  {
+    json.field("intraOpThreads", static_cast<std::uint64_t>(config.m_intraOpThreads));
+    json.field("interOpThreads", static_cast<std::uint64_t>(config.m_interOpThreads));
+    json.field("graphOptimization", graphOptimizationToString(config.m_graphOptimization));
+  }
+  json.endObject();
+  json.endObject();
+
+  json.beginObject("model");
+  json.field("hash", modelHash);
+  json.field("bytes", static_cast<std::uint64_t>(results.m_memory.m_modelFileBytes));
+  json.endObject();
+
+  json.beginObject("system");
+  json.field("cpuModel", system.m_cpuModel);
+  json.field("governor", system.m_governor);
+  json.field("cores", static_cast<std::uint64_t>(system.m_numCores));
+  json.endObject();
+
+  json.beginObject("run");
+  json.field("frames", static_cast<std::uint64_t>(results.m_numFrames));
+  json.field("batchSize", static_cast<std::uint64_t>(results.m_batchSize));
+  json.field("wallTimeSec", results.m_wallTimeSec);
+  json.field("throughputFps", results.m_wallTimeSec > 0.0 ?
+                              results.m_numFrames / results.m_wallTimeSec : 0.0);
+  json.field("coldStartMs", results.m_coldStartMs);
+  json.field("warmupFrames", static_cast<std::uint64_t>(results.m_warmupFrames));
+  json.field("warmupConverged", results.m_warmupConverged);
+  json.endObject();
+
+  json.beginObject("stages");
+  for (const StageResult& stage : stages)
+  {
+    json.beginObject(stage.m_name);
+    json.field("unit", "ms");
+    writeSummary(json, stage.m_summary);
+
+    json.beginObject("histogram");
+    json.field("lower", stage.m_histogram.m_lower);
+    json.field("bucketWidth", stage.m_histogram.m_bucketWidth);
+    json.beginArray("counts");
+    for (std::uint64_t count : stage.m_histogram.m_counts)
+      json.value(static_cast<double>(count));
+    json.endArray();
+    json.endObject();
+
+    if (stage.m_totals.m_numCounterCalls > 0)
+    {
+      json.beginObject("counters");
+      if (PerfCounters::isAvailable(PerfEvent::CYCLES) &&
+          PerfCounters::isAvailable(PerfEvent::INSTRUCTIONS))
+        json.field("ipc", stage.m_totals.calculateIpc());
+      for (std::size_t i {0}; i < kNumPerfEvents; ++i)
+      {
+        const PerfEvent event {static_cast<PerfEvent>(i)};
+        if (PerfCounters::isAvailable(event))
+          json.field(PerfCounters::eventName(event), stage.m_totals.calculatePerCall(event));
+      }
+      json.endObject();
+    }
+
+    // raw samples allow statistical comparisons against this run later on
+    json.beginArray("samples");
+    for (double sample : stage.m_samples)
+      json.value(sample);
+    json.endArray();
+    json.endObject();
+  }
+  json.endObject();
+
+  const MemoryStats& memory {results.m_memory};
+  json.beginObject("memory");
+  json.field("startupRssKb", static_cast<std::uint64_t>(memory.m_startup.m_rssKb));
+  json.field("startupPeakRssKb", static_cast<std::uint64_t>(memory.m_startup.m_peakRssKb));
+  json.field("steadyRssKb", static_cast<std::uint64_t>(memory.m_steadyState.m_rssKb));
+  json.field("steadyPeakRssKb", static_cast<std::uint64_t>(memory.m_steadyState.m_peakRssKb));
+  json.field("arenaBytes", static_cast<std::uint64_t>(memory.m_arenaBytes));
+  json.field("arenaPersistentBytes", static_cast<std::uint64_t>(memory.m_arenaPersistentBytes));
+  json.field("modelFileBytes", static_cast<std::uint64_t>(memory.m_modelFileBytes));
+  json.field("modelResidentBytes", static_cast<std::uint64_t>(memory.m_modelResidentBytes));
+  if (memory.m_allocHookInstalled)
+  {
+    const double frames {memory.m_steadyFrames == 0 ? 1.0 :
+                         static_cast<double>(memory.m_steadyFrames)};
+    json.field("initAllocs", memory.m_initAllocs.m_count);
+    json.field("initAllocBytes", memory.m_initAllocs.m_bytes);
+    json.field("firstFrameAllocs", memory.m_firstFrameAllocs.m_count);
+    json.field("firstFrameAllocBytes", memory.m_firstFrameAllocs.m_bytes);
+    json.field("allocsPerFrame", memory.m_steadyAllocs.m_count / frames);
+    json.field("allocBytesPerFrame", memory.m_steadyAllocs.m_bytes / frames);
+  }
+  json.endObject();
+
+  const RealtimeResults& realtime {results.m_realtime};
+  if (realtime.m_enabled)
+  {
+    json.beginObject("realtime");
+    json.field("fps", static_cast<double>(config.m_realtime.m_fps));
+    json.field("jitterMs", static_cast<double>(config.m_realtime.m_jitterMs));
+    json.field("dropPolicy", dropPolicyToString(config.m_realtime.m_dropPolicy));
+    json.field("queueSize", static_cast<std::uint64_t>(config.m_realtime.m_queueSize));
+    json.field("deadlineMs", realtime.m_deadlineMs);
+    json.field("emitted", realtime.m_emitted);
+    json.field("processed", realtime.m_processed);
+    json.field("dropped", realtime.m_dropped);
+    json.field("deadlineMisses", realtime.m_deadlineMisses);
+    json.field("maxQueueDepth", static_cast<std::uint64_t>(realtime.m_maxQueueDepth));
+    json.beginArray("queueDepth");
+    for (const auto& [timeMs, depth] : realtime.m_queueDepth)
+    {
+      json.beginArray();
+      json.value(timeMs);
+      json.value(static_cast<double>(depth));
+      json.endArray();
+    }
+    json.endArray();
+    json.endObject();
+  }
+
+  if (!results.m_loadCurve.empty())
+  {
+    json.beginObject("loadSweep");
+    json.field("arrival", arrivalProcessToString(config.m_loadSweep.m_arrival));
+    json.field("instances", static_cast<std::uint64_t>(config.m_loadSweep.m_instances));
+    json.field("kneeIndex", static_cast<double>(results.m_kneeIndex));
+    json.beginArray("curve");
+    for (const LoadPoint& point : results.m_loadCurve)
+    {
+      json.beginObject();
+      json.field("offeredRps", point.m_offeredRps);
+      json.field("achievedRps", point.m_achievedRps);
+      json.field("p50Ms", point.m_p50Ms);
+      json.field("p99Ms", point.m_p99Ms);
+      json.field("requests", point.m_requests);
+      json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+  }
+
+  if (!results.m_thresholdSweep.empty())
+  {
+    json.beginArray("thresholdSweep");
+    for (const ThresholdPoint& point : results.m_thresholdSweep)
+    {
+      json.beginObject();
+      json.field("confidence", point.m_confidence);
+      json.field("iou", point.m_iou);
+      json.field("mAP50", point.m_map50);
+      json.field("mAP50_95", point.m_map5095);
+      json.field("detectionsPerFrame", point.m_detectionsPerFrame);
+      json.field("nmsMs", point.m_nmsMs);
+      json.field("frameMs", point.m_frameMs);
+      json.endObject();
+    }
+    json.endArray();
+  }
+
+  json.beginObject("metrics");
+  for (const auto& [name, value] : results.m_metrics)
+    json.field(name, value);
+  json.endObject();
+
+  json.endObject();
+  return json.str();
+}
+
+std::string csvEscape(std::string_view field)
+{
+  if (field.find_first_of(",\"\n") == std::string_view::npos)
+    return std::string{field};
+
+  std::string escaped {"\""};
+  for (char c : field)
+  {
+    if (c == '"')
+      escaped += '"';
+    escaped += c;
+  }
+  escaped += '"';
+  return escaped;
+}
+
+std::string toCsv(const TestBenchConfig& config, const BenchResults& results,
+                  const SystemInfo& system, const std::string& modelHash,
+                  const std::vector<StageResult>& stages)
+{
+  std::string csv;
+  csv.reserve(16 * 1024);
+  auto row = [&csv](std::string_view section, std::string_view name, std::string_view key,
+                    const auto& value) {
+    fmt::format_to(std::back_inserter(csv), "{},{},{},", section, csvEscape(name), key);
+    if constexpr (std::is_convertible_v<decltype(value), std::string_view>)
+      csv += csvEscape(value);
+    else
+      fmt::format_to(std::back_inserter(csv), "{}", value);
+    csv += '\n';
+  };
+
+  csv += "section,name,key,value\n";
+  if (!config.m_variantName.empty())
+    row("config", "", "variant", config.m_variantName);
+  row("config", "", "type", benchTypeToString(config.m_benchType));
+  row("config", "", "engineType", engineTypeToString(config.m_engineType));
+  row("config", "", "modelPath", config.m_modelPath);
+  row("config", "", "datasetDir", config.m_datasetDir);
+  row("engine", "", "arch", modelArchToString(config.m_arch));
+  row("engine", "", "iou", config.m_iouThreshold);
+  row("engine", "", "confidence", config.m_confidenceThreshold);
+  if (config.m_engineType == EngineType::OPENVINO)
+  {
+    row("engine", "", "performanceHint", performanceHintToString(config.m_performanceHint));
+    row("engine", "", "inferRequests", config.m_inferRequests);
+  }
+  if (config.m_engineType == EngineType::ONNXRUNTIME)
+  {
+    row("engine", "", "intraOpThreads", config.m_intraOpThreads);
+    row("engine", "", "interOpThreads", config.m_interOpThreads);
+    row("engine", "", "graphOptimization", 
+        graphOptimizationToString(config.m_graphOptimization));
+  }
+  row("model", "", "hash", modelHash);
+  row("system", "", "cpuModel", system.m_cpuModel);
+  row("system", "", "governor", system.m_governor);
+  row("system", "", "cores", system.m_numCores);
+  row("run", "", "frames", results.m_numFrames);
+  row("run", "", "batchSize", results.m_batchSize);
+  row("run", "", "wallTimeSec", results.m_wallTimeSec);
+  row("run", "", "throughputFps", results.m_wallTimeSec > 0.0 ?
+                                  results.m_numFrames / results.m_wallTimeSec : 0.0);
+  row("run", "", "coldStartMs", results.m_coldStartMs);
+  row("run", "", "warmupFrames", results.m_warmupFrames);
+
+  for (const StageResult& stage : stages)
+  {
+    row("stage", stage.m_name, "count", stage.m_summary.m_count);
+    row("stage", stage.m_name, "min_ms", stage.m_summary.m_min);
+    row("stage", stage.m_name, "mean_ms", stage.m_summary.m_mean);
+    row("stage", stage.m_name, "stddev_ms", stage.m_summary.m_stddev);
+    row("stage", stage.m_name, "p50_ms", stage.m_summary.m_p50);
+    row("stage", stage.m_name, "p90_ms", stage.m_summary.m_p90);
+    row("stage", stage.m_name, "p95_ms", stage.m_summary.m_p95);
+    row("stage", stage.m_name, "p99_ms", stage.m_summary.m_p99);
+    row("stage", stage.m_name, "max_ms", stage.m_summary.m_max);
+    if (stage.m_totals.m_numCounterCalls > 0)
+      row("stage", stage.m_name, "ipc", stage.m_totals.calculateIpc());
+  }
+
+  const MemoryStats& memory {results.m_memory};
+  row("memory", "", "startupPeakRssKb", memory.m_startup.m_peakRssKb);
+  row("memory", "", "steadyPeakRssKb", memory.m_steadyState.m_peakRssKb);
+  row("memory", "", "arenaBytes", memory.m_arenaBytes);
+  row("memory", "", "modelFileBytes", memory.m_modelFileBytes);
+  row("memory", "", "modelResidentBytes", memory.m_modelResidentBytes);
+
+  const RealtimeResults& realtime {results.m_realtime};
+  if (realtime.m_enabled)
+  {
+    row("realtime", "", "fps", config.m_realtime.m_fps);
+    row("realtime", "", "dropPolicy", dropPolicyToString(config.m_realtime.m_dropPolicy));
+    row("realtime", "", "deadlineMs", realtime.m_deadlineMs);
+    row("realtime", "", "emitted", realtime.m_emitted);
+    row("realtime", "", "processed", realtime.m_processed);
+    row("realtime", "", "dropped", realtime.m_dropped);
+    row("realtime", "", "deadlineMisses", realtime.m_deadlineMisses);
+    row("realtime", "", "maxQueueDepth", realtime.m_maxQueueDepth);
+  }
+
+  for (std::size_t i {0}; i < results.m_loadCurve.size(); ++i)
+  {
+    const LoadPoint& point {results.m_loadCurve[i]};
+    const std::string name {fmt::format("{}rps", point.m_offeredRps)};
+    row("load", name, "achievedRps", point.m_achievedRps);
+    row("load", name, "p50Ms", point.m_p50Ms);
+    row("load", name, "p99Ms", point.m_p99Ms);
+    row("load", name, "knee", static_cast<int>(i) == results.m_kneeIndex);
+  }
+
+  for (const ThresholdPoint& point : results.m_thresholdSweep)
+  {
+    const std::string name {fmt::format("conf{}_iou{}", point.m_confidence, point.m_iou)};
+    row("threshold", name, "mAP50", point.m_map50);
+    row("threshold", name, "mAP50_95", point.m_map5095);
+    row("threshold", name, "detectionsPerFrame", point.m_detectionsPerFrame);
+    row("threshold", name, "nmsMs", point.m_nmsMs);
+    row("threshold", name, "frameMs", point.m_frameMs);
+  }
+
+  for (const auto& [name, value] : results.m_metrics)
+    row("metric", "", name, value);
+
+  return csv;
+}
+
+std::string readFirstLine(const std::string& path)
+{
+  std::ifstream file(path);
+  std::string line;
+  std::getline(file, line);
+  return line;
+}
+
+}  // namespace
+
+SystemInfo SystemInfo::query()
+{
+  SystemInfo info;
+  info.m_numCores = std::thread::hardware_concurrency();
+  info.m_governor = readFirstLine("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor");
+
+  // x86 reports "model name", most arm kernels only "Hardware" or "Model"
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(cpuinfo, line))
+  {
+    const std::size_t colon {line.find(':')};
+    if (colon == std::string::npos)
+      continue;
+
+    std::string key {line.substr(0, colon)};
+    key.erase(key.find_last_not_of(" \t") + 1);
+    if (key == "model name" || key == "Hardware" || key == "Model")
+    {
+      info.m_cpuModel = line.substr(line.find_first_not_of(" \t", colon + 1));
+      if (key == "model name")
+        break;
+    }
+  }
+  return info;
+}
+
+std::string ResultsWriter::hashFile(const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open())
+    return {};
+
+  std::uint64_t hash {0xcbf29ce484222325ull};
+  std::vector<char> chunk(1 << 20);
+  while (file.read(chunk.data(), chunk.size()) || file.gcount() > 0)
+  {
+    const std::streamsize count {file.gcount()};
+    for (std::streamsize i {0}; i < count; ++i)
+    {
+      hash ^= static_cast<unsigned char>(chunk[i]);
+      hash *= 0x100000001b3ull;
+    }
+  }
+  return fmt::format("fnv1a64:{:016x}", hash);
+}
+
+bool ResultsWriter::write(const std::string& path, const TestBenchConfig& config,
+                          const BenchResults& results)
+{
+  const std::vector<StageResult> stages {collectStages()};
+  const SystemInfo system {SystemInfo::query()};
+  const std::string modelHash {hashFile(config.m_modelPath)};
+
+  const bool csv {path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0};
+  const std::string document {csv ? toCsv(config, results, system, modelHash, stages) :
+                                    toJson(config, results, system, modelHash, stages)};
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file.is_open())
+  {
+    spdlog::error("ResultsWriter::write: could not open results file: {}", path);
+    return false;
+  }
+  file.write(document.data(), static_cast<std::streamsize>(document.size()));
+  if (!file)
+  {
+    spdlog::error("ResultsWriter::write: failed writing results file: {}", path);
+    return false;
+  }
+
+  spdlog::info("ResultsWriter::write: wrote {} results to {}", csv ? "csv" : "json", path);
+  return true;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "../config/config.h"
+#include "../memory/memory.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief RealtimeResults holds the accounting of a paced (fixed-fps camera) run
+ */
+struct RealtimeResults
+{
+  bool m_enabled {false};                                     /// \var paced run happened
+  double m_deadlineMs {0.0};                                  /// \var capture-to-result deadline
+  std::uint64_t m_emitted {0};                                /// \var frames emitted by the camera
+  std::uint64_t m_processed {0};                              /// \var frames processed
+  std::uint64_t m_dropped {0};                                /// \var frames dropped by policy
+  std::uint64_t m_deadlineMisses {0};                         /// \var processed after deadline
+  std::size_t m_maxQueueDepth {0};                            /// \var maximum queue depth
+  std::vector<std::pair<double, std::uint32_t>> m_queueDepth; /// \var (ms since start, depth)
+};
+
+/**
+ * @brief LoadPoint is one offered-load level of an open-loop sweep
+ */
+struct LoadPoint
+{
+  double m_offeredRps {0.0};              /// \var offered load in requests per second
+  double m_achievedRps {0.0};             /// \var completed requests per second
+  double m_p50Ms {0.0};                   /// \var median arrival-to-result latency
+  double m_p99Ms {0.0};                   /// \var 99th percentile arrival-to-result latency
+  std::uint64_t m_requests {0};           /// \var requests issued at this level
+};
+
+/**
+ * @brief ThresholdPoint is one confidence/IoU setting of a threshold sweep
+ */
+struct ThresholdPoint
+{
+  float m_confidence {0.0f};              /// \var confidence threshold
+  float m_iou {0.0f};                     /// \var NMS IoU threshold
+  double m_map50 {0.0};                   /// \var mAP at IoU 0.5
+  double m_map5095 {0.0};                 /// \var mAP averaged over IoU 0.5:0.95
+  double m_detectionsPerFrame {0.0};      /// \var mean detections kept per frame
+  double m_nmsMs {0.0};                   /// \var mean filter + NMS time per frame
+  double m_frameMs {0.0};                 /// \var estimated frame latency with this setting
+};
+
+/**
+ * @brief BenchResults holds everything a benchmark run reports besides the profiler zones
+ */
+struct BenchResults
+{
+  std::size_t m_numFrames {0};                                /// \var measured frames
+  std::size_t m_batchSize {1};                                /// \var frames per invoke
+  double m_wallTimeSec {0.0};                                 /// \var measured wall time
+  double m_coldStartMs {0.0};                                 /// \var latency of the 1st frame
+  std::size_t m_warmupFrames {0};                             /// \var frames run before measuring
+  bool m_warmupConverged {false};                             /// \var cv threshold was reached
+  MemoryStats m_memory;                                       /// \var memory footprint
+  RealtimeResults m_realtime;                                 /// \var paced run accounting
+  std::vector<LoadPoint> m_loadCurve;                         /// \var open-loop sweep curve
+  int m_kneeIndex {-1};                                       /// \var knee point of the curve
+  std::vector<ThresholdPoint> m_thresholdSweep;               /// \var confidence/IoU grid
+  std::vector<std::pair<std::string, double>> m_metrics;      /// \var accuracy metrics
+};
+
+/**
+ * @brief SystemInfo describes the machine the benchmark ran on
+ */
+struct SystemInfo
+{
+  std::string m_cpuModel;                 /// \var cpu model name
+  std::string m_governor;                 /// \var cpu0 frequency governor
+  unsigned int m_numCores {0};            /// \var number of online cores
+
+  /**
+   * @brief reads the system information from /proc and /sys
+   * @return system information
+   */
+  static SystemInfo query();
+};
+
+/**
+ * @brief ResultsWriter serializes a finished benchmark run for the fleet dashboards
+ */
+struct ResultsWriter
+{
+  /**
+   * @brief writes the results file, the format is picked from the extension (.csv or json)
+   * @param path output file path
+   * @param config test bench configuration
+   * @param results run results
+   * @return true if successful, false otherwise
+   */
+  static bool write(const std::string& path, const TestBenchConfig& config,
+                    const BenchResults& results);
+
+  /**
+   * @brief computes the 64-bit FNV-1a hash of a file
+   * @param path file path
+   * @return hex encoded hash, empty if the file could not be read
+   */
+  static std::string hashFile(const std::string& path);
+};
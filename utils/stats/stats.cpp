@@ -0,0 +1,113 @@
+#include "stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <utility>
+
+double Stats::percentile(const std::vector<double>& sorted, double p)
+{
+  if (sorted.empty())
+    return 0.0;
+
+  const double rank {std::clamp(p, 0.0, 100.0) / 100.0 * (sorted.size() - 1)};
+  const std::size_t lower {static_cast<std::size_t>(rank)};
+  const std::size_t upper {std::min(lower + 1, sorted.size() - 1)};
+  const double fraction {rank - static_cast<double>(lower)};
+  return sorted[lower] + (sorted[upper] - sorted[lower]) * fraction;
+}
+
+Summary Stats::summarize(std::vector<double>& samples)
+{
+  Summary summary;
+  summary.m_count = samples.size();
+  if (samples.empty())
+    return summary;
+
+  std::sort(samples.begin(), samples.end());
+  summary.m_min = samples.front();
+  summary.m_max = samples.back();
+  summary.m_mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+
+  if (samples.size() > 1)
+  {
+    double squares {0.0};
+    for (double sample : samples)
+      squares += (sample - summary.m_mean) * (sample - summary.m_mean);
+    summary.m_stddev = std::sqrt(squares / (samples.size() - 1));
+  }
+
+  summary.m_p50 = percentile(samples, 50.0);
+  summary.m_p90 = percentile(samples, 90.0);
+  summary.m_p95 = percentile(samples, 95.0);
+  summary.m_p99 = percentile(samples, 99.0);
+  return summary;
+}
+
+Histogram Stats::histogram(const std::vector<double>& samples, std::size_t numBuckets)
+{
+  Histogram histogram;
+  if (samples.empty() || numBuckets == 0)
+    return histogram;
+
+  const auto [minIt, maxIt] {std::minmax_element(samples.begin(), samples.end())};
+  histogram.m_lower = *minIt;
+  histogram.m_bucketWidth = (*maxIt - *minIt) / numBuckets;
+  histogram.m_counts.assign(numBuckets, 0);
+
+  for (double sample : samples)
+  {
+    std::size_t bucket {0};
+    if (histogram.m_bucketWidth > 0.0)
+      bucket = std::min(numBuckets - 1,
+        static_cast<std::size_t>((sample - histogram.m_lower) / histogram.m_bucketWidth));
+    ++histogram.m_counts[bucket];
+  }
+  return histogram;
+}
+
+double Stats::mannWhitneyGreater(const std::vector<double>& baseline,
+                                 const std::vector<double>& current)
+{
+  if (baseline.empty() || current.empty())
+    return 1.0;
+
+  // pool both sets, the flag marks samples of the current run
+  std::vector<std::pair<double, bool>> pooled;
+  pooled.reserve(baseline.size() + current.size());
+  for (double sample : baseline)
+    pooled.emplace_back(sample, false);
+  for (double sample : current)
+    pooled.emplace_back(sample, true);
+  std::sort(pooled.begin(), pooled.end());
+
+  // rank sum of the current samples, ties get their average rank
+  const double n {static_cast<double>(pooled.size())};
+  double rankSum {0.0};
+  double tieTerm {0.0};
+  for (std::size_t i {0}; i < pooled.size();)
+  {
+    std::size_t j {i};
+    while (j < pooled.size() && pooled[j].first == pooled[i].first)
+      ++j;
+
+    const double ties {static_cast<double>(j - i)};
+    const double averageRank {(i + 1 + j) / 2.0};
+    for (std::size_t k {i}; k < j; ++k)
+      if (pooled[k].second)
+        rankSum += averageRank;
+    tieTerm += ties * ties * ties - ties;
+    i = j;
+  }
+
+  const double n1 {static_cast<double>(current.size())};
+  const double n2 {static_cast<double>(baseline.size())};
+  const double u {rankSum - n1 * (n1 + 1.0) / 2.0};
+  const double mean {n1 * n2 / 2.0};
+  const double variance {n1 * n2 / 12.0 * ((n + 1.0) - tieTerm / (n * (n - 1.0)))};
+  if (variance <= 0.0)
+    return 1.0;
+
+  const double z {(u - mean - 0.5) / std::sqrt(variance)};
+  return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Summary holds the descriptive statistics of a sample set
+ */
+struct Summary
+{
+  std::size_t m_count {0};                /// \var number of samples
+  double m_min {0.0};                     /// \var minimum
+  double m_max {0.0};                     /// \var maximum
+  double m_mean {0.0};                    /// \var arithmetic mean
+  double m_stddev {0.0};                  /// \var sample standard deviation
+  double m_p50 {0.0};                     /// \var median
+  double m_p90 {0.0};                     /// \var 90th percentile
+  double m_p95 {0.0};                     /// \var 95th percentile
+  double m_p99 {0.0};                     /// \var 99th percentile
+};
+
+/**
+ * @brief Histogram holds equally wide buckets between the sample minimum and maximum
+ */
+struct Histogram
+{
+  double m_lower {0.0};                   /// \var lower bound of the first bucket
+  double m_bucketWidth {0.0};             /// \var width of each bucket
+  std::vector<std::uint64_t> m_counts;    /// \var samples per bucket
+};
+
+/**
+ * @brief Stats provides the statistics used by the benchmark reports
+ */
+struct Stats
+{
+  /**
+   * @brief linearly interpolated percentile of sorted samples
+   * @param sorted samples sorted in ascending order
+   * @param p percentile in [0, 100]
+   * @return percentile value, 0 if there are no samples
+   */
+  static double percentile(const std::vector<double>& sorted, double p);
+
+  /**
+   * @brief computes the descriptive statistics of the given samples
+   * @param samples samples, sorted in place
+   * @return summary
+   */
+  static Summary summarize(std::vector<double>& samples);
+
+  /**
+   * @brief bins the samples into equally wide buckets
+   * @param samples samples
+   * @param numBuckets number of buckets
+   * @return histogram
+   */
+  static Histogram histogram(const std::vector<double>& samples, std::size_t numBuckets);
+
+  /**
+   * @brief one-sided Mann-Whitney U test whether the current samples are stochastically
+   * greater (slower) than the baseline samples. Uses the normal approximation with tie
+   * and continuity correction, which is adequate from roughly 10 samples per side.
+   * @param baseline baseline samples
+   * @param current current samples
+   * @return p-value, 1 if either side is empty
+   */
+  static double mannWhitneyGreater(const std::vector<double>& baseline,
+                                   const std::vector<double>& current);
+};